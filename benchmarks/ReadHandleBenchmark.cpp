@@ -0,0 +1,248 @@
+// Copyright (c) embedded ocean GmbH
+#include "TemplateInput.hpp"
+#include "TemplateInputHandler.hpp"
+#include "TemplateIoComponent.hpp"
+#include "TemplateOutput.hpp"
+#include "TemplateOutputHandler.hpp"
+#include "WorkerPool.hpp"
+
+#include <xentara/model/Attribute.hpp>
+#include <xentara/skill/Element.hpp>
+
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace xentara::plugins::templateDriver
+{
+
+using namespace std::literals;
+
+/// @brief Sets up the elements of the benchmark.
+///
+/// The elements are normally set up by load(), which needs the Xentara configuration. The benchmark creates the same
+/// handlers directly instead.
+class ReadHandleBenchmark final
+{
+public:
+	/// @brief Creates an oversampled floating point input
+	static auto makeFloatingPointInput(TemplateIoComponent &ioComponent) -> std::shared_ptr<TemplateInput>
+	{
+		auto input = std::make_shared<TemplateInput>(ioComponent);
+		input->_handler = std::make_unique<TemplateInputHandler<double>>();
+		input->_handler->enableOversampling();
+		return input;
+	}
+
+	/// @brief Creates an integer input
+	static auto makeIntegerInput(TemplateIoComponent &ioComponent) -> std::shared_ptr<TemplateInput>
+	{
+		auto input = std::make_shared<TemplateInput>(ioComponent);
+		input->_handler = std::make_unique<TemplateInputHandler<std::int32_t>>();
+		return input;
+	}
+
+	/// @brief Creates an integer output
+	static auto makeOutput(TemplateIoComponent &ioComponent) -> std::shared_ptr<TemplateOutput>
+	{
+		auto output = std::make_shared<TemplateOutput>(ioComponent);
+		output->_handler = std::make_unique<TemplateOutputHandler<std::uint16_t>>();
+		return output;
+	}
+};
+
+namespace
+{
+
+	/// @brief The parameters of the benchmark
+	struct Parameters final
+	{
+		/// @brief The number of data points of each kind
+		std::size_t _points { 10000 };
+		/// @brief How often to resolve the attributes of all the elements
+		std::size_t _repetitions { 10 };
+	};
+
+	/// @brief An element, together with the attributes Xentara creates handles for
+	struct Element final
+	{
+		/// @brief The element
+		std::shared_ptr<skill::Element> _element;
+		/// @brief The attributes reported by the element
+		std::vector<std::reference_wrapper<const model::Attribute>> _attributes;
+	};
+
+	/// @brief Parses a single number from the command line
+	auto parseNumber(std::string_view text, std::size_t &number) -> bool
+	{
+		const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), number);
+		return error == std::errc() && end == text.data() + text.size() && number > 0;
+	}
+
+	/// @brief Parses the command line
+	/// @return The parameters, or std::nullopt if the command line is invalid
+	auto parseArguments(std::span<char *> arguments) -> std::optional<Parameters>
+	{
+		// Every option needs a value
+		if (arguments.size() % 2 == 0)
+		{
+			return std::nullopt;
+		}
+
+		Parameters parameters;
+		for (std::size_t index = 1; index + 1 < arguments.size(); index += 2)
+		{
+			const std::string_view name = arguments[index];
+			const std::string_view value = arguments[index + 1];
+
+			if (name == "--points"sv)
+			{
+				if (!parseNumber(value, parameters._points))
+				{
+					return std::nullopt;
+				}
+			}
+			else if (name == "--repetitions"sv)
+			{
+				if (!parseNumber(value, parameters._repetitions))
+				{
+					return std::nullopt;
+				}
+			}
+			else
+			{
+				return std::nullopt;
+			}
+		}
+
+		return parameters;
+	}
+
+	/// @brief Adds an element, and collects its attributes
+	auto addElement(std::vector<Element> &elements, std::shared_ptr<skill::Element> element) -> void
+	{
+		auto &entry = elements.emplace_back(Element { std::move(element), {} });
+		entry._element->forEachAttribute([&](const model::Attribute &attribute)
+		{
+			entry._attributes.push_back(attribute);
+			return false;
+		});
+	}
+
+	/// @brief Creates the elements: the I/O component, oversampled floating point inputs, integer inputs, and integer outputs
+	auto makeElements(const std::shared_ptr<TemplateIoComponent> &ioComponent, std::size_t count) -> std::vector<Element>
+	{
+		std::vector<Element> elements;
+		elements.reserve(3 * count + 1);
+		addElement(elements, ioComponent);
+		for (std::size_t index = 0; index < count; ++index)
+		{
+			addElement(elements, ReadHandleBenchmark::makeFloatingPointInput(*ioComponent));
+			addElement(elements, ReadHandleBenchmark::makeIntegerInput(*ioComponent));
+			addElement(elements, ReadHandleBenchmark::makeOutput(*ioComponent));
+		}
+		return elements;
+	}
+
+	/// @brief Resolves all the attributes of all the elements using makeReadHandle(), like Xentara does
+	/// @return The number of handles created
+	auto resolveUsingElements(std::span<const Element> elements) -> std::size_t
+	{
+		std::size_t handles = 0;
+		for (auto &&element : elements)
+		{
+			for (auto &&attribute : element._attributes)
+			{
+				if (element._element->makeReadHandle(attribute))
+				{
+					++handles;
+				}
+			}
+		}
+		return handles;
+	}
+
+	/// @brief Finds all the attributes of all the elements by comparing them with each attribute of the element in turn,
+	/// which is what a chain of comparisons in makeReadHandle() amounts to.
+	/// @return The number of attributes found
+	auto resolveUsingComparisons(std::span<const Element> elements) -> std::size_t
+	{
+		std::size_t found = 0;
+		for (auto &&element : elements)
+		{
+			for (auto &&attribute : element._attributes)
+			{
+				if (element._element->forEachAttribute([&](const model::Attribute &candidate) { return candidate == attribute.get(); }))
+				{
+					++found;
+				}
+			}
+		}
+		return found;
+	}
+
+	/// @brief Runs a function a number of times, and prints the time per attribute
+	template <typename Function>
+	auto measure(std::string_view label, std::size_t repetitions, std::size_t attributeCount, Function &&function) -> std::size_t
+	{
+		std::size_t results = 0;
+		const auto startTime = std::chrono::steady_clock::now();
+		for (std::size_t repetition = 0; repetition < repetitions; ++repetition)
+		{
+			results += function();
+		}
+		const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime);
+
+		std::printf("%-24.*s %8.1f ns per attribute\n",
+			int(label.size()), label.data(), elapsed.count() / double(repetitions * attributeCount));
+		return results / repetitions;
+	}
+
+} // namespace
+
+} // namespace xentara::plugins::templateDriver
+
+/// @brief Measures how long it takes to create the read handles for all the attributes of a large model.
+///
+/// Xentara creates a read handle for every attribute reference in the model when the model is loaded. The benchmark
+/// resolves the attributes of real I/O component, input and output elements, and compares this with comparing each
+/// attribute of the element in turn.
+auto main(int argc, char *argv[]) -> int
+{
+	using namespace xentara::plugins::templateDriver;
+
+	const auto parameters = parseArguments(std::span(argv, std::size_t(argc)));
+	if (!parameters)
+	{
+		std::fprintf(stderr, "usage: %s [--points N] [--repetitions N]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	WorkerPool workerPool;
+	const auto ioComponent = std::make_shared<TemplateIoComponent>(workerPool);
+	const auto elements = makeElements(ioComponent, parameters->_points);
+	std::size_t attributeCount = 0;
+	for (auto &&element : elements)
+	{
+		attributeCount += element._attributes.size();
+	}
+	std::printf("elements:                %zu\n", elements.size());
+	std::printf("attributes:              %zu\n", attributeCount);
+
+	const auto handles = measure("element read handles"sv, parameters->_repetitions, attributeCount,
+		[&] { return resolveUsingElements(elements); });
+	const auto found = measure("sequential comparisons"sv, parameters->_repetitions, attributeCount,
+		[&] { return resolveUsingComparisons(elements); });
+
+	// Every attribute an element reports must have a read handle
+	return handles == attributeCount && found == attributeCount ? EXIT_SUCCESS : EXIT_FAILURE;
+}
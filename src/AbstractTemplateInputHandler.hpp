@@ -1,6 +1,14 @@
 // Copyright (c) embedded ocean GmbH
 #pragma once
 
+#include "AcquisitionClock.hpp"
+#include "MemoryFootprint.hpp"
+#include "PackedWord.hpp"
+#include "Replayer.hpp"
+#include "RuntimeCounters.hpp"
+#include "SimulatedSignal.hpp"
+#include "Simulator.hpp"
+
 #include <xentara/data/DataType.hpp>
 #include <xentara/data/ReadHandle.hpp>
 #include <xentara/model/Attribute.hpp>
@@ -11,6 +19,8 @@
 #include <string_view>
 #include <memory>
 #include <chrono>
+#include <cstddef>
+#include <span>
 #include <optional>
 
 namespace xentara::plugins::templateDriver
@@ -54,11 +64,80 @@ public:
 	/// @return A read handle for the attribute, or std::nullopt if the attribute is unknown
 	virtual auto makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle> = 0;
 
+	/// @brief Creates a read-handle for the value, regardless of the attribute it is published as
+	virtual auto valueReadHandle() const noexcept -> data::ReadHandle = 0;
+
+	/// @brief Enables the sample history
+	/// @param capacity The number of samples to keep. Must not be 0.
+	/// @return Whether the data type supports a sample history
+	virtual auto enableHistory(std::size_t capacity) -> bool = 0;
+
+	/// @brief Enables oversampling
+	///
+	/// If oversampling is enabled, the value is sampled by the I/O component using sample(), and acquire() publishes
+	/// the last sample together with the minimum, maximum and mean of all samples.
+	/// @return Whether the data type supports oversampling
+	virtual auto enableOversampling() -> bool = 0;
+
+	/// @brief Maps the value to a single bit of a word shared with other inputs
+	///
+	/// Instead of reading the value itself, the handler extracts its bit from the word cached by the I/O component.
+	/// The word is only read by the handler itself when the value is read using read(), e.g. by the read task of the input.
+	/// @param word The word. The word must remain valid for as long as the handler exists.
+	/// @param bit The index of the bit, where 0 is the least significant bit. Must be less than PackedWord::kBitCount.
+	/// @return Whether the data type can be mapped to a bit
+	virtual auto mapBit(PackedWord &word, unsigned bit) -> bool = 0;
+
+	/// @brief Returns the size of the snapshot record needed for the value
+	/// @return The record size, or 0 if the data type cannot be stored in a snapshot
+	virtual auto snapshotSize() const noexcept -> std::size_t = 0;
+
+	/// @brief Attaches a snapshot record to the handler
+	///
+	/// Once a record has been attached, the handler stores each value it publishes in the record.
+	/// @param record The record. Must have the size returned by snapshotSize().
+	/// @param restore Whether to restore the value from the record
+	virtual auto attachSnapshot(std::span<std::byte> record, bool restore) -> void = 0;
+
+	/// @brief Sets the counters that count the reads and writes of the handler
+	/// @param counters The counters. The counters must remain valid for as long as the handler exists.
+	virtual auto setRuntimeCounters(RuntimeCounters &counters) -> void = 0;
+
+	/// @brief Reads the value from a simulation instead of the I/O component
+	/// @param simulator The simulator. The simulator must remain valid for as long as the handler exists.
+	/// @param signal The signal to generate. The handler keeps its own copy.
+	virtual auto simulate(Simulator &simulator, const SimulatedSignal &signal) -> void = 0;
+
+	/// @brief Reads the value from a replay file instead of the I/O component
+	/// @param replayer The replayer. The replayer must remain valid for as long as the handler exists.
+	/// @param point The point in the replay file the value is taken from
+	virtual auto replay(Replayer &replayer, std::size_t point) -> void = 0;
+
 	/// @brief Realizes the handler
 	virtual auto realize() -> void = 0;
+
+	/// @brief Returns the memory used by the handler, its data blocks and its events
+	virtual auto footprint() const noexcept -> MemoryFootprint = 0;
 		
 	/// @brief Attempts to read the data from the I/O component and updates the handler accordingly.
-	virtual auto read(std::chrono::system_clock::time_point timeStamp) -> void = 0;
+	/// @param timeStamp The time stamp to use if acquisition time stamps are disabled
+	/// @param clock The clock used for acquisition time stamps
+	virtual auto read(std::chrono::system_clock::time_point timeStamp, const AcquisitionClock &clock) -> void = 0;
+
+	/// @brief Attempts to read the data from the I/O component, and keeps it for publishing later.
+	///
+	/// This function does not update the state, and can therefore be called from a worker thread.
+	/// @param clock The clock used for acquisition time stamps
+	virtual auto acquire(const AcquisitionClock &clock) -> void = 0;
+	/// @brief Updates the state with the data acquired using acquire(), if any
+	/// @param timeStamp The time stamp to use if the data has no acquisition time stamp
+	virtual auto publish(std::chrono::system_clock::time_point timeStamp) -> void = 0;
+
+	/// @brief Takes a sample if oversampling is enabled.
+	///
+	/// This function is called by the sampler thread of the I/O component.
+	/// @param clock The clock used to time stamp the sample
+	virtual auto sample(const AcquisitionClock &clock) -> void = 0;
 
 	/// @brief Invalidates any read data
 	virtual auto invalidateData(std::chrono::system_clock::time_point timeStamp) -> void = 0;
@@ -1,6 +1,12 @@
 // Copyright (c) embedded ocean GmbH
 #pragma once
 
+#include "AcquisitionClock.hpp"
+#include "MemoryFootprint.hpp"
+#include "PackedWord.hpp"
+#include "RuntimeCounters.hpp"
+#include "Simulator.hpp"
+
 #include <xentara/data/DataType.hpp>
 #include <xentara/data/ReadHandle.hpp>
 #include <xentara/data/WriteHandle.hpp>
@@ -10,9 +16,14 @@
 #include <xentara/process/Event.hpp>
 
 #include <string_view>
+#include <atomic>
 #include <memory>
 #include <chrono>
+#include <cstddef>
+#include <functional>
 #include <optional>
+#include <span>
+#include <system_error>
 
 namespace xentara::plugins::templateDriver
 {
@@ -67,14 +78,123 @@ public:
 	/// @return A write handle for the attribute, or std::nullopt if the attribute is unknown
 	virtual auto makeWriteHandle(const model::Attribute &attribute, std::shared_ptr<void> parent) noexcept -> std::optional<data::WriteHandle> = 0;
 
+	/// @brief Maps the value to a single bit of a word shared with other outputs and inputs
+	///
+	/// The value is read by extracting the bit from the word cached by the I/O component, and written by changing the bit
+	/// using a read-modify-write of the word. When the I/O component writes several outputs mapped to the same word, it
+	/// merges them into a single read-modify-write instead.
+	/// @param word The word. The word must remain valid for as long as the handler exists.
+	/// @param bit The index of the bit, where 0 is the least significant bit. Must be less than PackedWord::kBitCount.
+	/// @return Whether the data type can be mapped to a bit
+	virtual auto mapBit(PackedWord &word, unsigned bit) -> bool = 0;
+
+	/// @brief Sets the counters that count the reads and writes of the handler
+	/// @param counters The counters. The counters must remain valid for as long as the handler exists.
+	virtual auto setRuntimeCounters(RuntimeCounters &counters) -> void = 0;
+
+	/// @brief Writes to a simulation instead of the I/O component, which echoes the written values back on read
+	/// @param simulator The simulator. The simulator must remain valid for as long as the handler exists.
+	virtual auto simulate(Simulator &simulator) -> void = 0;
+
 	/// @brief Realizes the handler
 	virtual auto realize() -> void = 0;
+
+	/// @brief Returns the memory used by the handler, its data blocks and its events
+	virtual auto footprint() const noexcept -> MemoryFootprint = 0;
 		
 	/// @brief Attempts to read the data from the I/O component and updates the handler accordingly.
-	virtual auto read(std::chrono::system_clock::time_point timeStamp) -> void = 0;
+	/// @param timeStamp The time stamp to use if acquisition time stamps are disabled
+	/// @param clock The clock used for acquisition time stamps
+	virtual auto read(std::chrono::system_clock::time_point timeStamp, const AcquisitionClock &clock) -> void = 0;
+
+	/// @brief Attempts to read the data from the I/O component, and keeps it for publishing later.
+	///
+	/// This function does not update the state, and can therefore be called from a worker thread.
+	/// @param clock The clock used for acquisition time stamps
+	virtual auto acquire(const AcquisitionClock &clock) -> void = 0;
+	/// @brief Updates the state with the data acquired using acquire(), if any
+	/// @param timeStamp The time stamp to use if the data has no acquisition time stamp
+	virtual auto publish(std::chrono::system_clock::time_point timeStamp) -> void = 0;
 	/// @brief Attempts to write any pending value to the I/O component and updates the state accordingly.
 	virtual auto write(std::chrono::system_clock::time_point timeStamp) -> void = 0;	
 
+	/// @brief Returns the number of bytes the value occupies on the I/O component
+	/// @return The size of the value, or 0 if the value does not have a fixed size
+	virtual auto valueSize() const noexcept -> std::size_t = 0;
+
+	/// @brief Checks whether a value is waiting to be written
+	virtual auto hasPendingValue() const noexcept -> bool = 0;
+
+	/// @brief Returns the time the oldest value waiting in the queue was scheduled
+	/// @return The time, or std::nullopt if no value is waiting in the queue
+	virtual auto pendingSince() const noexcept -> std::optional<std::chrono::steady_clock::time_point> = 0;
+
+	/// @brief Sets a flag that is raised whenever a value is scheduled.
+	///
+	/// The flag is shared by all the outputs of the same write priority, and is reset by the write planner. This allows
+	/// the planner to notice newly scheduled values without checking every single output.
+	/// @param flag The flag, or nullptr for none
+	virtual auto setScheduledFlag(std::atomic<bool> *flag) noexcept -> void = 0;
+
+	/// @brief Checks whether a value was staged and has not been finished or deferred yet
+	virtual auto hasStagedValue() const noexcept -> bool = 0;
+
+	/// @brief Removes any pending value from the queue and stages it for writing.
+	///
+	/// If the write rate limit of the output has been reached, the value is left in the queue, to be written in a
+	/// later cycle.
+	/// @return Whether a value was staged
+	virtual auto stagePendingValue() -> bool = 0;
+
+	/// @brief Writes the staged value to the I/O component individually.
+	///
+	/// This function does not update the state, and can therefore be called from a worker thread.
+	/// @return The error code, or a default constructed std::error_code object if the value was written successfully
+	virtual auto writeStagedValue() -> std::error_code = 0;
+
+	/// @brief Returns the time the staged value was first scheduled
+	/// @return The time, or std::nullopt if it is not known
+	virtual auto stagedSince() const noexcept -> std::optional<std::chrono::steady_clock::time_point> = 0;
+
+	/// @brief Puts the staged value back without writing it.
+	///
+	/// The value will be staged again by the next call to stagePendingValue(), unless a newer value was scheduled in the
+	/// meantime.
+	virtual auto deferStagedValue() -> void = 0;
+
+	/// @brief Encodes the staged value into a buffer
+	/// @param buffer The buffer. The size of the buffer must be valueSize().
+	virtual auto encodeStagedValue(std::span<std::byte> buffer) const -> void = 0;
+
+	/// @brief Returns the staged value as a bit
+	/// @pre The value must have been mapped to a bit using mapBit(), and hasStagedValue() must be true.
+	virtual auto stagedBit() const noexcept -> bool = 0;
+
+	/// @brief Checks whether the value last written successfully is known
+	virtual auto hasLastWrittenValue() const noexcept -> bool = 0;
+
+	/// @brief Encodes the value last written successfully into a buffer
+	/// @param buffer The buffer. The size of the buffer must be valueSize().
+	/// @pre hasLastWrittenValue() must be true.
+	virtual auto encodeLastWrittenValue(std::span<std::byte> buffer) const -> void = 0;
+
+	/// @brief Configures what happens after a value was written successfully
+	/// @param writeThrough Whether to update the read state with the written value right away. The value is marked as
+	/// unconfirmed until it is read back.
+	/// @param requestRead A function that requests a single read of the output to confirm the written value, or an
+	/// empty function if written values should not be read back specially.
+	virtual auto setWriteFeedback(bool writeThrough, std::function<void()> requestRead) -> void = 0;
+
+	/// @brief Limits the rate at which values are written
+	/// @param rate The maximum sustained number of writes per second, or 0 for no limit
+	/// @param burst The maximum number of writes that can be performed in quick succession
+	virtual auto setWriteRateLimit(double rate, double burst) -> void = 0;
+
+	/// @brief Finishes writing the staged value and updates the state accordingly.
+	/// @param timeStamp The time stamp of the write
+	/// @param error The error code, or a default constructed std::error_code object if the value was written successfully
+	virtual auto finishStagedWrite(std::chrono::system_clock::time_point timeStamp, std::error_code error) -> void = 0;
+
 	/// @brief Invalidates any read data
 	virtual auto invalidateData(std::chrono::system_clock::time_point timeStamp) -> void = 0;
 };
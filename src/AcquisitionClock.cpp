@@ -0,0 +1,212 @@
+// Copyright (c) embedded ocean GmbH
+#include "AcquisitionClock.hpp"
+
+#include <limits>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#	define XENTARA_TEMPLATE_DRIVER_HAVE_TSC 1
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	else
+#		include <cpuid.h>
+#		include <x86intrin.h>
+#	endif
+#endif
+
+namespace xentara::plugins::templateDriver
+{
+
+using namespace std::literals;
+
+namespace
+{
+
+	/// @brief The interval after which the mapping is recalibrated
+	constexpr double kRecalibrationInterval = std::chrono::nanoseconds(100ms).count();
+
+	/// @brief The minimum interval over which the tick frequency is measured
+	constexpr auto kMinimumMeasurementInterval = 10ms;
+
+	/// @brief The number of attempts made to sample the tick counter and the system clock together
+	constexpr auto kSampleAttempts = 5;
+
+	/// @brief Checks whether the processor has an invariant time stamp counter
+	auto haveInvariantTimeStampCounter() noexcept -> bool
+	{
+#if defined(XENTARA_TEMPLATE_DRIVER_HAVE_TSC)
+		// The invariant TSC flag is bit 8 of EDX for CPUID leaf 0x80000007
+#	if defined(_MSC_VER)
+		int registers[4] {};
+		__cpuid(registers, 0x80000000);
+		if (unsigned(registers[0]) < 0x80000007u)
+		{
+			return false;
+		}
+		__cpuid(registers, 0x80000007);
+		return (registers[3] & (1 << 8)) != 0;
+#	else
+		unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+		if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+		{
+			return false;
+		}
+		return (edx & (1u << 8)) != 0;
+#	endif
+#else
+		return false;
+#endif
+	}
+
+	/// @brief Gets the current system time in nanoseconds since the epoch
+	auto systemNanoseconds() noexcept -> std::int64_t
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	}
+
+} // namespace
+
+auto AcquisitionClock::prepare() -> void
+{
+	_useTimeStampCounter = haveInvariantTimeStampCounter();
+
+	// Measure the tick frequency
+	_referenceTime = std::chrono::steady_clock::now();
+	_referenceTicks = ticks();
+	double nanosecondsPerTick = 1.0;
+	if (_useTimeStampCounter)
+	{
+		std::this_thread::sleep_for(kMinimumMeasurementInterval);
+		const auto time = std::chrono::steady_clock::now();
+		const auto ticks = this->ticks();
+		nanosecondsPerTick = double(std::chrono::nanoseconds(time - _referenceTime).count()) / double(ticks - _referenceTicks);
+		_referenceTime = time;
+		_referenceTicks = ticks;
+	}
+
+	// Set the initial mapping
+	const auto [ticks, nanoseconds] = sample();
+	storeMapping({ ticks, nanoseconds, nanosecondsPerTick });
+}
+
+auto AcquisitionClock::now() const noexcept -> std::chrono::system_clock::time_point
+{
+	const auto ticks = this->ticks();
+	const auto mapping = loadMapping();
+
+	// The tick count may lie before the calibration point if another thread recalibrated in the meantime
+	const auto elapsed = double(std::int64_t(ticks - mapping._ticks)) * mapping._nanosecondsPerTick;
+
+	// Recalibrate every now and then to correct for drift between the tick counter and the system clock
+	if (elapsed > kRecalibrationInterval) [[unlikely]]
+	{
+		recalibrate();
+	}
+
+	const std::chrono::nanoseconds sinceEpoch { mapping._nanoseconds + std::int64_t(elapsed) };
+	return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(sinceEpoch));
+}
+
+auto AcquisitionClock::ticks() const noexcept -> std::uint64_t
+{
+#if defined(XENTARA_TEMPLATE_DRIVER_HAVE_TSC)
+	if (_useTimeStampCounter)
+	{
+		return __rdtsc();
+	}
+#endif
+
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+auto AcquisitionClock::sample() const noexcept -> std::pair<std::uint64_t, std::int64_t>
+{
+	// Bracket the system time between two tick counts, and use the attempt with the narrowest bracket. This prevents the
+	// mapping from being skewed if the thread is preempted between reading the two clocks.
+	std::pair<std::uint64_t, std::int64_t> best;
+	auto bestWidth = std::numeric_limits<std::uint64_t>::max();
+	for (auto attempt = 0; attempt < kSampleAttempts; ++attempt)
+	{
+		const auto before = ticks();
+		const auto nanoseconds = systemNanoseconds();
+		const auto after = ticks();
+
+		if (after - before < bestWidth)
+		{
+			bestWidth = after - before;
+			best = { before + (after - before) / 2, nanoseconds };
+		}
+	}
+
+	return best;
+}
+
+auto AcquisitionClock::loadMapping() const noexcept -> Mapping
+{
+	// Retry until we get a consistent mapping
+	while (true)
+	{
+		const auto sequence = _sequence.load(std::memory_order_acquire);
+		if (sequence % 2 != 0) [[unlikely]]
+		{
+			continue;
+		}
+
+		const Mapping mapping {
+			_baseTicks.load(std::memory_order_relaxed),
+			_baseNanoseconds.load(std::memory_order_relaxed),
+			_nanosecondsPerTick.load(std::memory_order_relaxed) };
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (_sequence.load(std::memory_order_relaxed) == sequence) [[likely]]
+		{
+			return mapping;
+		}
+	}
+}
+
+auto AcquisitionClock::storeMapping(const Mapping &mapping) const noexcept -> void
+{
+	// Mark the mapping as being updated
+	_sequence.fetch_add(1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	_baseTicks.store(mapping._ticks, std::memory_order_relaxed);
+	_baseNanoseconds.store(mapping._nanoseconds, std::memory_order_relaxed);
+	_nanosecondsPerTick.store(mapping._nanosecondsPerTick, std::memory_order_relaxed);
+
+	// Mark the mapping as complete
+	_sequence.fetch_add(1, std::memory_order_release);
+}
+
+auto AcquisitionClock::recalibrate() const noexcept -> void
+{
+	// Only one thread recalibrates, the others just keep using the old mapping
+	if (_calibrating.test_and_set(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	auto nanosecondsPerTick = _nanosecondsPerTick.load(std::memory_order_relaxed);
+
+	// Sample the clocks as close together as possible
+	const auto [ticks, nanoseconds] = sample();
+
+	// Remeasure the tick frequency against the steady clock. The system clock is not used for this, because it may jump.
+	if (_useTimeStampCounter)
+	{
+		const auto time = std::chrono::steady_clock::now();
+		if (time - _referenceTime >= kMinimumMeasurementInterval && ticks > _referenceTicks)
+		{
+			nanosecondsPerTick = double(std::chrono::nanoseconds(time - _referenceTime).count()) / double(ticks - _referenceTicks);
+			_referenceTime = time;
+			_referenceTicks = ticks;
+		}
+	}
+
+	storeMapping({ ticks, nanoseconds, nanosecondsPerTick });
+
+	_calibrating.clear(std::memory_order_release);
+}
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,109 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include "CacheLine.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief A clock used to time stamp values at the moment they are acquired.
+///
+/// Getting the system time for every single value would be too expensive if thousands of values are acquired in each
+/// cycle. This clock therefore uses a cheap tick counter, and maps it to the system clock using a mapping that is
+/// recalibrated periodically. On x86-64 processors with an invariant time stamp counter, the time stamp counter is used
+/// as the tick counter. On other processors, std::chrono::steady_clock is used.
+///
+/// The clock can be used by multiple threads at once.
+class AcquisitionClock final
+{
+public:
+	/// @brief Enables or disables acquisition time stamps
+	auto setEnabled(bool enabled) noexcept -> void
+	{
+		_enabled = enabled;
+	}
+
+	/// @brief Checks whether acquisition time stamps are enabled
+	auto enabled() const noexcept -> bool
+	{
+		return _enabled;
+	}
+
+	/// @brief Prepares the clock for use.
+	///
+	/// This function measures the frequency of the tick counter, which may take a few milliseconds.
+	auto prepare() -> void;
+
+	/// @brief Gets a time stamp for a value that was just acquired
+	/// @return The current time, or std::nullopt if acquisition time stamps are disabled
+	auto stamp() const noexcept -> std::optional<std::chrono::system_clock::time_point>
+	{
+		if (!_enabled)
+		{
+			return std::nullopt;
+		}
+
+		return now();
+	}
+
+	/// @brief Gets the current time
+	auto now() const noexcept -> std::chrono::system_clock::time_point;
+
+private:
+	/// @brief The mapping from ticks to system time
+	struct Mapping final
+	{
+		/// @brief The tick count at the calibration point
+		std::uint64_t _ticks {};
+		/// @brief The system time at the calibration point, in nanoseconds since the epoch
+		std::int64_t _nanoseconds {};
+		/// @brief The length of a tick in nanoseconds
+		double _nanosecondsPerTick { 1.0 };
+	};
+
+	/// @brief Reads the tick counter
+	auto ticks() const noexcept -> std::uint64_t;
+
+	/// @brief Samples the tick counter and the system clock at the same time
+	/// @return The tick count and the system time in nanoseconds since the epoch
+	auto sample() const noexcept -> std::pair<std::uint64_t, std::int64_t>;
+
+	/// @brief Loads the current mapping
+	auto loadMapping() const noexcept -> Mapping;
+	/// @brief Stores a new mapping
+	auto storeMapping(const Mapping &mapping) const noexcept -> void;
+
+	/// @brief Recalibrates the mapping, unless another thread is already doing so
+	auto recalibrate() const noexcept -> void;
+
+	/// @brief Whether acquisition time stamps are enabled
+	bool _enabled { false };
+	/// @brief Whether the time stamp counter is used
+	bool _useTimeStampCounter { false };
+
+	/// @brief A sequence number used to detect concurrent updates of the mapping.
+	///
+	/// The number is odd while the mapping is being updated.
+	alignas(kCacheLineSize) mutable std::atomic<std::uint64_t> _sequence { 0 };
+	/// @brief The tick count at the calibration point
+	mutable std::atomic<std::uint64_t> _baseTicks { 0 };
+	/// @brief The system time at the calibration point, in nanoseconds since the epoch
+	mutable std::atomic<std::int64_t> _baseNanoseconds { 0 };
+	/// @brief The length of a tick in nanoseconds
+	mutable std::atomic<double> _nanosecondsPerTick { 1.0 };
+
+	/// @brief Set while a thread is recalibrating the mapping
+	alignas(kCacheLineSize) mutable std::atomic_flag _calibrating;
+	/// @brief The tick count used as reference for measuring the tick frequency
+	mutable std::uint64_t _referenceTicks { 0 };
+	/// @brief The steady clock time used as reference for measuring the tick frequency
+	mutable std::chrono::steady_clock::time_point _referenceTime;
+};
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,197 @@
+// Copyright (c) embedded ocean GmbH
+#include "Aggregate.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <numeric>
+
+// SSE2 is part of the baseline instruction set on x86-64
+#if defined(__SSE2__) || defined(_M_X64)
+#	define XENTARA_TEMPLATE_DRIVER_HAVE_SSE2 1
+#	include <emmintrin.h>
+#endif
+
+namespace xentara::plugins::templateDriver
+{
+
+namespace
+{
+
+	/// @brief The number of independent accumulators used by the portable implementation.
+	///
+	/// Using several accumulators removes the dependency between successive iterations, which allows the compiler
+	/// to vectorize the loop.
+	constexpr std::size_t kLaneCount = 8;
+
+	/// @brief Portable implementation of aggregate()
+	/// @param samples The samples. Must not be empty.
+	template <typename ValueType>
+	auto aggregateLanes(std::span<const ValueType> samples) noexcept -> Aggregate<ValueType>
+	{
+		std::array<ValueType, kLaneCount> minimum;
+		std::array<ValueType, kLaneCount> maximum;
+		std::array<double, kLaneCount> sum {};
+		minimum.fill(samples.front());
+		maximum.fill(samples.front());
+
+		// Process full groups of samples
+		std::size_t index = 0;
+		for (; index + kLaneCount <= samples.size(); index += kLaneCount)
+		{
+			for (std::size_t lane = 0; lane < kLaneCount; ++lane)
+			{
+				const auto sample = samples[index + lane];
+				minimum[lane] = std::min(minimum[lane], sample);
+				maximum[lane] = std::max(maximum[lane], sample);
+				sum[lane] += static_cast<double>(sample);
+			}
+		}
+
+		// Combine the lanes
+		Aggregate<ValueType> result {
+			*std::ranges::min_element(minimum), *std::ranges::max_element(maximum), 0.0, samples.size() };
+		auto total = std::accumulate(sum.begin(), sum.end(), 0.0);
+
+		// Process the remaining samples
+		for (; index < samples.size(); ++index)
+		{
+			const auto sample = samples[index];
+			result._minimum = std::min(result._minimum, sample);
+			result._maximum = std::max(result._maximum, sample);
+			total += static_cast<double>(sample);
+		}
+
+		result._mean = total / static_cast<double>(samples.size());
+		return result;
+	}
+
+#if defined(XENTARA_TEMPLATE_DRIVER_HAVE_SSE2)
+
+	/// @brief SSE2 implementation of aggregate() for single precision values
+	/// @param samples The samples. Must not be empty.
+	auto aggregateSse2(std::span<const float> samples) noexcept -> Aggregate<float>
+	{
+		auto minimum = _mm_set1_ps(samples.front());
+		auto maximum = minimum;
+		// The sums are accumulated in double precision, so that long runs of samples do not lose precision
+		auto lowSum = _mm_setzero_pd();
+		auto highSum = _mm_setzero_pd();
+
+		// Process four samples at a time
+		std::size_t index = 0;
+		for (; index + 4 <= samples.size(); index += 4)
+		{
+			const auto values = _mm_loadu_ps(samples.data() + index);
+			minimum = _mm_min_ps(minimum, values);
+			maximum = _mm_max_ps(maximum, values);
+			lowSum = _mm_add_pd(lowSum, _mm_cvtps_pd(values));
+			highSum = _mm_add_pd(highSum, _mm_cvtps_pd(_mm_movehl_ps(values, values)));
+		}
+
+		// Combine the lanes
+		alignas(16) std::array<float, 4> minimumLanes;
+		alignas(16) std::array<float, 4> maximumLanes;
+		alignas(16) std::array<double, 2> sumLanes;
+		_mm_store_ps(minimumLanes.data(), minimum);
+		_mm_store_ps(maximumLanes.data(), maximum);
+		_mm_store_pd(sumLanes.data(), _mm_add_pd(lowSum, highSum));
+		Aggregate<float> result {
+			*std::ranges::min_element(minimumLanes), *std::ranges::max_element(maximumLanes), 0.0, samples.size() };
+		auto total = sumLanes[0] + sumLanes[1];
+
+		// Process the remaining samples
+		for (; index < samples.size(); ++index)
+		{
+			const auto sample = samples[index];
+			result._minimum = std::min(result._minimum, sample);
+			result._maximum = std::max(result._maximum, sample);
+			total += sample;
+		}
+
+		result._mean = total / static_cast<double>(samples.size());
+		return result;
+	}
+
+	/// @brief SSE2 implementation of aggregate() for double precision values
+	/// @param samples The samples. Must not be empty.
+	auto aggregateSse2(std::span<const double> samples) noexcept -> Aggregate<double>
+	{
+		auto minimum = _mm_set1_pd(samples.front());
+		auto maximum = minimum;
+		auto sum = _mm_setzero_pd();
+
+		// Process two samples at a time
+		std::size_t index = 0;
+		for (; index + 2 <= samples.size(); index += 2)
+		{
+			const auto values = _mm_loadu_pd(samples.data() + index);
+			minimum = _mm_min_pd(minimum, values);
+			maximum = _mm_max_pd(maximum, values);
+			sum = _mm_add_pd(sum, values);
+		}
+
+		// Combine the lanes
+		alignas(16) std::array<double, 2> minimumLanes;
+		alignas(16) std::array<double, 2> maximumLanes;
+		alignas(16) std::array<double, 2> sumLanes;
+		_mm_store_pd(minimumLanes.data(), minimum);
+		_mm_store_pd(maximumLanes.data(), maximum);
+		_mm_store_pd(sumLanes.data(), sum);
+		Aggregate<double> result {
+			std::min(minimumLanes[0], minimumLanes[1]), std::max(maximumLanes[0], maximumLanes[1]), 0.0, samples.size() };
+		auto total = sumLanes[0] + sumLanes[1];
+
+		// Process the remaining sample, if any
+		if (index < samples.size())
+		{
+			const auto sample = samples[index];
+			result._minimum = std::min(result._minimum, sample);
+			result._maximum = std::max(result._maximum, sample);
+			total += sample;
+		}
+
+		result._mean = total / static_cast<double>(samples.size());
+		return result;
+	}
+
+#endif // defined(XENTARA_TEMPLATE_DRIVER_HAVE_SSE2)
+
+} // namespace
+
+template <typename ValueType>
+	requires utils::tools::Integral<ValueType> || std::floating_point<ValueType>
+auto aggregate(std::span<const ValueType> samples) noexcept -> Aggregate<ValueType>
+{
+	// Handle the empty case here, so the implementations don't have to
+	if (samples.empty())
+	{
+		return {};
+	}
+
+#if defined(XENTARA_TEMPLATE_DRIVER_HAVE_SSE2)
+	// Use the hand-written SSE2 code for floating point values, which are the most common type for analog inputs
+	if constexpr (std::same_as<ValueType, float> || std::same_as<ValueType, double>)
+	{
+		return aggregateSse2(samples);
+	}
+	else
+#endif
+	{
+		return aggregateLanes(samples);
+	}
+}
+
+/// @todo change list of template instantiations to the supported types
+template auto aggregate(std::span<const std::uint8_t> samples) noexcept -> Aggregate<std::uint8_t>;
+template auto aggregate(std::span<const std::uint16_t> samples) noexcept -> Aggregate<std::uint16_t>;
+template auto aggregate(std::span<const std::uint32_t> samples) noexcept -> Aggregate<std::uint32_t>;
+template auto aggregate(std::span<const std::uint64_t> samples) noexcept -> Aggregate<std::uint64_t>;
+template auto aggregate(std::span<const std::int8_t> samples) noexcept -> Aggregate<std::int8_t>;
+template auto aggregate(std::span<const std::int16_t> samples) noexcept -> Aggregate<std::int16_t>;
+template auto aggregate(std::span<const std::int32_t> samples) noexcept -> Aggregate<std::int32_t>;
+template auto aggregate(std::span<const std::int64_t> samples) noexcept -> Aggregate<std::int64_t>;
+template auto aggregate(std::span<const float> samples) noexcept -> Aggregate<float>;
+template auto aggregate(std::span<const double> samples) noexcept -> Aggregate<double>;
+
+} // namespace xentara::plugins::templateDriver
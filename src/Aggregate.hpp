@@ -0,0 +1,48 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <xentara/utils/tools/Concepts.hpp>
+
+#include <concepts>
+#include <cstdint>
+#include <span>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief The minimum, maximum and mean of a number of samples
+template <typename ValueType>
+struct Aggregate final
+{
+	/// @brief The smallest sample
+	ValueType _minimum {};
+	/// @brief The largest sample
+	ValueType _maximum {};
+	/// @brief The arithmetic mean of the samples
+	double _mean {};
+	/// @brief The number of samples
+	std::uint64_t _count {};
+};
+
+/// @brief Computes the minimum, maximum and mean of a number of samples.
+///
+/// The samples are processed several at a time using SIMD instructions where the platform supports them.
+/// @note The result is unspecified if any of the samples is NaN.
+/// @param samples The samples. If this is empty, a default constructed aggregate is returned.
+template <typename ValueType>
+	requires utils::tools::Integral<ValueType> || std::floating_point<ValueType>
+auto aggregate(std::span<const ValueType> samples) noexcept -> Aggregate<ValueType>;
+
+/// @todo change list of extern template statements to the supported types
+extern template auto aggregate(std::span<const std::uint8_t> samples) noexcept -> Aggregate<std::uint8_t>;
+extern template auto aggregate(std::span<const std::uint16_t> samples) noexcept -> Aggregate<std::uint16_t>;
+extern template auto aggregate(std::span<const std::uint32_t> samples) noexcept -> Aggregate<std::uint32_t>;
+extern template auto aggregate(std::span<const std::uint64_t> samples) noexcept -> Aggregate<std::uint64_t>;
+extern template auto aggregate(std::span<const std::int8_t> samples) noexcept -> Aggregate<std::int8_t>;
+extern template auto aggregate(std::span<const std::int16_t> samples) noexcept -> Aggregate<std::int16_t>;
+extern template auto aggregate(std::span<const std::int32_t> samples) noexcept -> Aggregate<std::int32_t>;
+extern template auto aggregate(std::span<const std::int64_t> samples) noexcept -> Aggregate<std::int64_t>;
+extern template auto aggregate(std::span<const float> samples) noexcept -> Aggregate<float>;
+extern template auto aggregate(std::span<const double> samples) noexcept -> Aggregate<double>;
+
+} // namespace xentara::plugins::templateDriver
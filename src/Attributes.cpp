@@ -2,14 +2,82 @@
 #include "Attributes.hpp"
 
 #include <xentara/data/DataType.hpp>
+#include <xentara/utils/core/Uuid.hpp>
 
 namespace xentara::plugins::templateDriver::attributes
 {
 
 using namespace std::literals;
+using namespace xentara::literals;
 
 const model::Attribute kError { model::Attribute::kError, model::Attribute::Access::ReadOnly, data::DataType::kErrorCode };
 
 const model::Attribute kWriteError { model::Attribute::kWriteError, model::Attribute::Access::ReadOnly, data::DataType::kErrorCode };
 
-} // namespace xentara::plugins::templateDriver::attributes
+/// @todo assign a unique UUID
+const model::Attribute kMean { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "mean"sv, model::Attribute::Access::ReadOnly, data::DataType::kFloatingPoint };
+
+/// @todo assign a unique UUID
+const model::Attribute kSampleCount { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "sampleCount"sv, model::Attribute::Access::ReadOnly, data::DataType::kInteger };
+
+/// @todo assign a unique UUID
+const model::Attribute kDeferredWrites { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "deferredWrites"sv, model::Attribute::Access::ReadOnly, data::DataType::kInteger };
+
+/// @todo assign a unique UUID
+const model::Attribute kPreemptedWrites { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "preemptedWrites"sv, model::Attribute::Access::ReadOnly, data::DataType::kInteger };
+
+/// @todo assign a unique UUID
+const model::Attribute kCriticalWriteLatency { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "criticalWriteLatency"sv, model::Attribute::Access::ReadOnly, data::DataType::kFloatingPoint };
+
+/// @todo assign a unique UUID
+const model::Attribute kCriticalPeakWriteLatency { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "criticalPeakWriteLatency"sv, model::Attribute::Access::ReadOnly, data::DataType::kFloatingPoint };
+
+/// @todo assign a unique UUID
+const model::Attribute kNormalWriteLatency { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "normalWriteLatency"sv, model::Attribute::Access::ReadOnly, data::DataType::kFloatingPoint };
+
+/// @todo assign a unique UUID
+const model::Attribute kNormalPeakWriteLatency { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "normalPeakWriteLatency"sv, model::Attribute::Access::ReadOnly, data::DataType::kFloatingPoint };
+
+/// @todo assign a unique UUID
+const model::Attribute kBulkWriteLatency { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "bulkWriteLatency"sv, model::Attribute::Access::ReadOnly, data::DataType::kFloatingPoint };
+
+/// @todo assign a unique UUID
+const model::Attribute kBulkPeakWriteLatency { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "bulkPeakWriteLatency"sv, model::Attribute::Access::ReadOnly, data::DataType::kFloatingPoint };
+
+/// @todo assign a unique UUID
+const model::Attribute kReadCount { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "readCount"sv, model::Attribute::Access::ReadOnly, data::DataType::kInteger };
+
+/// @todo assign a unique UUID
+const model::Attribute kReadErrorCount { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "readErrorCount"sv, model::Attribute::Access::ReadOnly, data::DataType::kInteger };
+
+/// @todo assign a unique UUID
+const model::Attribute kWriteCount { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "writeCount"sv, model::Attribute::Access::ReadOnly, data::DataType::kInteger };
+
+/// @todo assign a unique UUID
+const model::Attribute kWriteErrorCount { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "writeErrorCount"sv, model::Attribute::Access::ReadOnly, data::DataType::kInteger };
+
+/// @todo assign a unique UUID
+const model::Attribute kOverwrittenValueCount { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "overwrittenValueCount"sv, model::Attribute::Access::ReadOnly, data::DataType::kInteger };
+
+/// @todo assign a unique UUID
+const model::Attribute kSkippedCycleCount { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "skippedCycleCount"sv, model::Attribute::Access::ReadOnly, data::DataType::kInteger };
+
+/// @todo assign a unique UUID
+const model::Attribute kObjectMemory { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "objectMemory"sv, model::Attribute::Access::ReadOnly, data::DataType::kInteger };
+
+/// @todo assign a unique UUID
+const model::Attribute kHandlerMemory { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "handlerMemory"sv, model::Attribute::Access::ReadOnly, data::DataType::kInteger };
+
+/// @todo assign a unique UUID
+const model::Attribute kDataBlockMemory { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "dataBlockMemory"sv, model::Attribute::Access::ReadOnly, data::DataType::kInteger };
+
+/// @todo assign a unique UUID
+const model::Attribute kEventMemory { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "eventMemory"sv, model::Attribute::Access::ReadOnly, data::DataType::kInteger };
+
+/// @todo assign a unique UUID
+const model::Attribute kMemoryPerInput { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "memoryPerInput"sv, model::Attribute::Access::ReadOnly, data::DataType::kFloatingPoint };
+
+/// @todo assign a unique UUID
+const model::Attribute kMemoryPerOutput { "deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "memoryPerOutput"sv, model::Attribute::Access::ReadOnly, data::DataType::kFloatingPoint };
+
+} // namespace xentara::plugins::templateDriver::attributes
\ No newline at end of file
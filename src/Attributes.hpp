@@ -13,4 +13,53 @@ extern const model::Attribute kError;
 /// @brief A Xentara attribute containing a write error code for a data point
 extern const model::Attribute kWriteError;
 
+/// @brief A Xentara attribute containing the mean of the samples taken during the last read cycle of an oversampled input
+extern const model::Attribute kMean;
+/// @brief A Xentara attribute containing the number of samples taken during the last read cycle of an oversampled input
+extern const model::Attribute kSampleCount;
+
+/// @brief A Xentara attribute containing the number of writes that were deferred because of a write rate limit
+extern const model::Attribute kDeferredWrites;
+/// @brief A Xentara attribute containing the number of writes that were deferred because higher priority values became pending
+extern const model::Attribute kPreemptedWrites;
+
+/// @brief A Xentara attribute containing the largest latency of the critical priority writes of the last cycle
+extern const model::Attribute kCriticalWriteLatency;
+/// @brief A Xentara attribute containing the largest latency of any critical priority write
+extern const model::Attribute kCriticalPeakWriteLatency;
+/// @brief A Xentara attribute containing the largest latency of the normal priority writes of the last cycle
+extern const model::Attribute kNormalWriteLatency;
+/// @brief A Xentara attribute containing the largest latency of any normal priority write
+extern const model::Attribute kNormalPeakWriteLatency;
+/// @brief A Xentara attribute containing the largest latency of the bulk priority writes of the last cycle
+extern const model::Attribute kBulkWriteLatency;
+/// @brief A Xentara attribute containing the largest latency of any bulk priority write
+extern const model::Attribute kBulkPeakWriteLatency;
+
+/// @brief A Xentara attribute containing the number of values read, including failed reads
+extern const model::Attribute kReadCount;
+/// @brief A Xentara attribute containing the number of failed reads
+extern const model::Attribute kReadErrorCount;
+/// @brief A Xentara attribute containing the number of values written, including failed writes
+extern const model::Attribute kWriteCount;
+/// @brief A Xentara attribute containing the number of failed writes
+extern const model::Attribute kWriteErrorCount;
+/// @brief A Xentara attribute containing the number of pending output values that were replaced before they were written
+extern const model::Attribute kOverwrittenValueCount;
+/// @brief A Xentara attribute containing the number of executions of the "read" task on which a data point was not due
+extern const model::Attribute kSkippedCycleCount;
+
+/// @brief A Xentara attribute containing the memory used by the data point objects of an I/O component, in bytes
+extern const model::Attribute kObjectMemory;
+/// @brief A Xentara attribute containing the memory used by the data type specific handlers of the data points, in bytes
+extern const model::Attribute kHandlerMemory;
+/// @brief A Xentara attribute containing the memory used by the data blocks of the data points, in bytes
+extern const model::Attribute kDataBlockMemory;
+/// @brief A Xentara attribute containing the memory used by the events of the data points, in bytes
+extern const model::Attribute kEventMemory;
+/// @brief A Xentara attribute containing the average memory used per input, in bytes
+extern const model::Attribute kMemoryPerInput;
+/// @brief A Xentara attribute containing the average memory used per output, in bytes
+extern const model::Attribute kMemoryPerOutput;
+
 } // namespace xentara::plugins::templateDriver::attributes
\ No newline at end of file
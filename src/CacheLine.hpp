@@ -0,0 +1,16 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <cstddef>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief The size of a cache line.
+///
+/// Data that is modified by different threads is aligned to this size to prevent false sharing.
+/// @note std::hardware_destructive_interference_size is not used, because its value may differ between compiler
+/// versions and settings, which makes it unsuitable for use in headers.
+inline constexpr std::size_t kCacheLineSize = 64;
+
+} // namespace xentara::plugins::templateDriver
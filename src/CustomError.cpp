@@ -44,6 +44,12 @@ namespace
 		case CustomError::NoData:
 			return "no data was read yet"s;
 
+		case CustomError::StaleValue:
+			return "the value was restored from a snapshot and has not been read yet"s;
+
+		case CustomError::UnconfirmedWrite:
+			return "the value was written but has not been read back yet"s;
+
 		/// @todo Add messages for other error codes
 
 		case CustomError::UnknownError:
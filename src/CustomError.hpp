@@ -17,6 +17,12 @@ enum class CustomError
 	/// @brief No data has been read yet.
 	NoData,
 
+	/// @brief The value was restored from a snapshot, and has not been read from the I/O component yet.
+	StaleValue,
+
+	/// @brief The value was written, but has not been read back from the I/O component yet.
+	UnconfirmedWrite,
+
 	/// @brief An unknown error occurred
 	UnknownError = 999
 };
@@ -0,0 +1,116 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief A string with a fixed maximum length that is stored inline, without any dynamic memory allocation.
+///
+/// This type is used for string inputs with a known maximum length, like bar codes or batch IDs, so that acquiring
+/// them does not allocate memory. The published value is still an std::string, see ReadState.
+template <std::size_t kCapacity>
+class FixedString final
+{
+public:
+	/// @brief Default constructor. Creates an empty string.
+	constexpr FixedString() noexcept = default;
+
+	/// @brief Creates a string with the given contents
+	/// @throw std::length_error The string is longer than the capacity
+	constexpr explicit FixedString(std::string_view string)
+	{
+		assign(string);
+	}
+
+	/// @brief Returns the maximum length of the string
+	static constexpr auto capacity() noexcept -> std::size_t
+	{
+		return kCapacity;
+	}
+
+	/// @brief Replaces the contents of the string
+	/// @throw std::length_error The string is longer than the capacity
+	constexpr auto assign(std::string_view string) -> void
+	{
+		if (string.size() > kCapacity) [[unlikely]]
+		{
+			throw std::length_error("string too long for fixed capacity string");
+		}
+
+		std::ranges::copy(string, _data.begin());
+		_size = string.size();
+	}
+
+	/// @brief Makes the string empty
+	constexpr auto clear() noexcept -> void
+	{
+		_size = 0;
+	}
+
+	/// @brief Returns the length of the string
+	constexpr auto size() const noexcept -> std::size_t
+	{
+		return _size;
+	}
+
+	/// @brief Checks whether the string is empty
+	constexpr auto empty() const noexcept -> bool
+	{
+		return _size == 0;
+	}
+
+	/// @brief Returns the characters of the string. The characters are not null terminated.
+	constexpr auto data() const noexcept -> const char *
+	{
+		return _data.data();
+	}
+
+	/// @brief Returns the contents of the string as a string view
+	constexpr auto view() const noexcept -> std::string_view
+	{
+		return { _data.data(), _size };
+	}
+
+	/// @brief Converts the string to a string view
+	constexpr operator std::string_view() const noexcept
+	{
+		return view();
+	}
+
+	/// @brief Compares the contents of two strings
+	friend constexpr auto operator==(const FixedString &lhs, const FixedString &rhs) noexcept -> bool
+	{
+		return lhs.view() == rhs.view();
+	}
+
+private:
+	/// @brief The characters. Only the first _size characters are valid.
+	std::array<char, kCapacity> _data {};
+	/// @brief The length of the string
+	std::size_t _size { 0 };
+};
+
+/// @brief The fixed capacity string type used for the "string[64]" data type
+using InlineString = FixedString<64>;
+
+/// @brief Checks whether a type is a FixedString
+template <typename Type>
+inline constexpr bool kIsFixedString = false;
+
+/// @brief Checks whether a type is a FixedString
+template <std::size_t kCapacity>
+inline constexpr bool kIsFixedString<FixedString<kCapacity>> = true;
+
+/// @brief A concept for FixedString types
+template <typename Type>
+concept FixedStringType = kIsFixedString<std::remove_cvref_t<Type>>;
+
+} // namespace xentara::plugins::templateDriver
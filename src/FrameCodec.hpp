@@ -0,0 +1,325 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <span>
+#include <tuple>
+#include <type_traits>
+
+namespace xentara::plugins::templateDriver
+{
+
+namespace detail
+{
+
+	/// @brief The unsigned integer type with a certain size
+	template <std::size_t kSize>
+	using UnsignedOfSize =
+		std::conditional_t<kSize == 1, std::uint8_t,
+		std::conditional_t<kSize == 2, std::uint16_t,
+		std::conditional_t<kSize == 4, std::uint32_t,
+		std::conditional_t<kSize == 8, std::uint64_t, void>>>>;
+
+	/// @brief Reverses the byte order of an unsigned integer
+	/// @note std::byteswap() is not used, because it requires C++23.
+	template <std::unsigned_integral Raw>
+	constexpr auto byteSwap(Raw value) noexcept -> Raw
+	{
+		if constexpr (sizeof(Raw) == 1)
+		{
+			return value;
+		}
+#if defined(__GNUC__) || defined(__clang__)
+		else if constexpr (sizeof(Raw) == 2)
+		{
+			return __builtin_bswap16(value);
+		}
+		else if constexpr (sizeof(Raw) == 4)
+		{
+			return __builtin_bswap32(value);
+		}
+		else if constexpr (sizeof(Raw) == 8)
+		{
+			return __builtin_bswap64(value);
+		}
+#endif
+		else
+		{
+			// Swap the bytes using shifts. Optimizing compilers recognize this and emit a single instruction.
+			Raw result = 0;
+			for (std::size_t index = 0; index < sizeof(Raw); ++index)
+			{
+				result = Raw((result << 8) | ((value >> (8 * index)) & 0xff));
+			}
+			return result;
+		}
+	}
+
+	/// @brief Checks that no two of a list of byte ranges overlap
+	/// @param begins The offsets of the first bytes of the ranges
+	/// @param ends The offsets of the first bytes after the ranges, in the same order
+	constexpr auto disjoint(std::initializer_list<std::size_t> begins, std::initializer_list<std::size_t> ends) noexcept -> bool
+	{
+		for (std::size_t first = 0; first < begins.size(); ++first)
+		{
+			for (std::size_t second = first + 1; second < begins.size(); ++second)
+			{
+				if (begins.begin()[first] < ends.begin()[second] && begins.begin()[second] < ends.begin()[first])
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+} // namespace detail
+
+/// @brief A value type that can be stored in a frame
+template <typename ValueType>
+concept FrameValueType = (std::integral<ValueType> || std::floating_point<ValueType>) &&
+	!std::is_void_v<detail::UnsignedOfSize<sizeof(ValueType)>>;
+
+/// @brief Describes a single value at a fixed position in a frame.
+///
+/// The signedness of the value is given by the value type. Integers can occupy fewer bytes in the frame than in memory,
+/// e.g. 3 bytes for a 24 bit integer. Signed integers are sign extended when they are decoded.
+/// @tparam ValueType The type of the decoded value
+/// @tparam kOffset The offset of the first byte of the value within the frame
+/// @tparam kByteOrder The byte order of the value within the frame
+/// @tparam kWidth The number of bytes the value occupies in the frame
+template <FrameValueType ValueType, std::size_t kOffset, std::endian kByteOrder = std::endian::big, std::size_t kWidth = sizeof(ValueType)>
+struct FrameField final
+{
+	static_assert(kWidth > 0 && kWidth <= sizeof(ValueType), "a frame field cannot be wider than its value type");
+	static_assert(kWidth == sizeof(ValueType) || (std::integral<ValueType> && !std::same_as<ValueType, bool>),
+		"only integer frame fields can be narrower than their value type");
+
+	/// @brief The type of the decoded value
+	using Type = ValueType;
+
+	/// @brief The offset of the field within the frame
+	static constexpr std::size_t kBegin = kOffset;
+	/// @brief The offset of the first byte after the field
+	static constexpr std::size_t kEnd = kOffset + kWidth;
+
+	/// @brief Decodes the value from a frame
+	/// @param frame The first byte of the frame. The frame must be at least kEnd bytes long.
+	static auto decode(const std::byte *frame) noexcept -> ValueType
+	{
+		return decodeAt(frame + kOffset);
+	}
+
+	/// @brief Encodes a value into a frame
+	/// @param value The value
+	/// @param frame The first byte of the frame. The frame must be at least kEnd bytes long.
+	static auto encode(const ValueType &value, std::byte *frame) noexcept -> void
+	{
+		encodeAt(value, frame + kOffset);
+	}
+
+	/// @brief Decodes a value stored at a certain position
+	/// @param data The first byte of the value
+	static auto decodeAt(const std::byte *data) noexcept -> ValueType
+	{
+		Raw raw = 0;
+		if constexpr (kWidth == sizeof(Raw))
+		{
+			// Values that fill their whole type are copied in one go, and swapped if necessary
+			std::memcpy(&raw, data, sizeof(Raw));
+			if constexpr (kByteOrder != std::endian::native)
+			{
+				raw = detail::byteSwap(raw);
+			}
+		}
+		else
+		{
+			// Narrower integers are assembled byte by byte
+			for (std::size_t index = 0; index < kWidth; ++index)
+			{
+				const auto shift = 8 * (kByteOrder == std::endian::little ? index : kWidth - 1 - index);
+				raw = Raw(raw | (std::to_integer<Raw>(data[index]) << shift));
+			}
+		}
+
+		if constexpr (std::floating_point<ValueType>)
+		{
+			return std::bit_cast<ValueType>(raw);
+		}
+		else if constexpr (std::same_as<ValueType, bool>)
+		{
+			return raw != 0;
+		}
+		else if constexpr (std::signed_integral<ValueType> && kWidth < sizeof(ValueType))
+		{
+			// Move the sign bit to the top, and shift it back down arithmetically to extend it
+			constexpr auto kShift = 8 * (sizeof(ValueType) - kWidth);
+			return ValueType(std::make_signed_t<Raw>(Raw(raw << kShift)) >> kShift);
+		}
+		else
+		{
+			return ValueType(raw);
+		}
+	}
+
+	/// @brief Encodes a value at a certain position
+	/// @param value The value
+	/// @param data The first byte of the value
+	static auto encodeAt(const ValueType &value, std::byte *data) noexcept -> void
+	{
+		Raw raw = 0;
+		if constexpr (std::floating_point<ValueType>)
+		{
+			raw = std::bit_cast<Raw>(value);
+		}
+		else
+		{
+			raw = Raw(value);
+		}
+
+		if constexpr (kWidth == sizeof(Raw))
+		{
+			if constexpr (kByteOrder != std::endian::native)
+			{
+				raw = detail::byteSwap(raw);
+			}
+			std::memcpy(data, &raw, sizeof(Raw));
+		}
+		else
+		{
+			// Narrower integers are truncated, and stored byte by byte
+			for (std::size_t index = 0; index < kWidth; ++index)
+			{
+				const auto shift = 8 * (kByteOrder == std::endian::little ? index : kWidth - 1 - index);
+				data[index] = std::byte(raw >> shift);
+			}
+		}
+	}
+
+private:
+	/// @brief The unsigned integer type used to swap the bytes
+	using Raw = detail::UnsignedOfSize<sizeof(ValueType)>;
+};
+
+/// @brief Describes an array of consecutive values of the same type in a frame.
+///
+/// The values are decoded in a simple loop that copies and swaps each value, which compilers turn into vector shuffles
+/// where the target supports them. Runs of values of the same type should therefore be described using a single array
+/// rather than as individual fields.
+/// @tparam ValueType The type of the decoded values
+/// @tparam kOffset The offset of the first value within the frame
+/// @tparam kCount The number of values
+/// @tparam kByteOrder The byte order of the values within the frame
+template <FrameValueType ValueType, std::size_t kOffset, std::size_t kCount, std::endian kByteOrder = std::endian::big>
+struct FrameArray final
+{
+	static_assert(kCount > 0, "a frame array must not be empty");
+
+	/// @brief The type of the decoded values
+	using Type = std::array<ValueType, kCount>;
+
+	/// @brief The offset of the array within the frame
+	static constexpr std::size_t kBegin = kOffset;
+	/// @brief The offset of the first byte after the array
+	static constexpr std::size_t kEnd = kOffset + kCount * sizeof(ValueType);
+
+	/// @brief Decodes the values from a frame
+	/// @param frame The first byte of the frame. The frame must be at least kEnd bytes long.
+	static auto decode(const std::byte *frame) noexcept -> Type
+	{
+		Type values;
+		for (std::size_t index = 0; index < kCount; ++index)
+		{
+			values[index] = Element::decodeAt(frame + kOffset + index * sizeof(ValueType));
+		}
+		return values;
+	}
+
+	/// @brief Encodes values into a frame
+	/// @param values The values
+	/// @param frame The first byte of the frame. The frame must be at least kEnd bytes long.
+	static auto encode(const Type &values, std::byte *frame) noexcept -> void
+	{
+		for (std::size_t index = 0; index < kCount; ++index)
+		{
+			Element::encodeAt(values[index], frame + kOffset + index * sizeof(ValueType));
+		}
+	}
+
+private:
+	/// @brief The descriptor used for the individual values
+	using Element = FrameField<ValueType, 0, kByteOrder>;
+};
+
+/// @brief Decodes and encodes frames with a layout that is known at compile time.
+///
+/// Devices often send and receive frames of packed values with mixed types and byte orders. The layout of such a frame
+/// is described using a list of FrameField and FrameArray descriptors, and the codec decodes all the values in a single
+/// pass directly from the receive buffer, without copying the frame first. Encoding works the same way in reverse.
+///
+/// The layout is checked at compile time: the fields must not overlap.
+///
+/// Example:
+/// @code
+/// using StatusFrame = FrameCodec<
+///     FrameField<std::uint16_t, 0>,                          // status word, big endian
+///     FrameField<std::int32_t, 2, std::endian::big, 3>,      // 24 bit signed position
+///     FrameArray<float, 5, 4, std::endian::little>>;         // four little endian temperatures
+///
+/// const auto [status, position, temperatures] = StatusFrame::decode(receiveBuffer);
+/// @endcode
+/// @tparam Fields The descriptors of the fields, in any order
+template <typename... Fields>
+class FrameCodec final
+{
+public:
+	static_assert(sizeof...(Fields) > 0, "a frame must have at least one field");
+	static_assert(detail::disjoint({ Fields::kBegin... }, { Fields::kEnd... }), "the fields of a frame must not overlap");
+
+	/// @brief The decoded values, in the order of the field descriptors
+	using Values = std::tuple<typename Fields::Type...>;
+
+	/// @brief The size of the frame
+	static constexpr std::size_t kSize = std::max({ Fields::kEnd... });
+
+	/// @brief The descriptor of a field
+	template <std::size_t kIndex>
+	using Field = std::tuple_element_t<kIndex, std::tuple<Fields...>>;
+
+	/// @brief Decodes all the values in a frame
+	/// @param frame The frame
+	/// @return The values, in the order of the field descriptors
+	static auto decode(std::span<const std::byte, kSize> frame) noexcept -> Values
+	{
+		// Braced initialization evaluates the fields in order
+		return Values { Fields::decode(frame.data())... };
+	}
+
+	/// @brief Decodes a single value in a frame
+	/// @tparam kIndex The index of the field descriptor
+	/// @param frame The frame
+	template <std::size_t kIndex>
+	static auto decode(std::span<const std::byte, kSize> frame) noexcept -> typename Field<kIndex>::Type
+	{
+		return Field<kIndex>::decode(frame.data());
+	}
+
+	/// @brief Encodes all the values into a frame
+	///
+	/// Bytes of the frame that do not belong to any field are left unchanged.
+	/// @param values The values, in the order of the field descriptors
+	/// @param frame The frame
+	static auto encode(const Values &values, std::span<std::byte, kSize> frame) noexcept -> void
+	{
+		std::apply([&](const auto &...fieldValues) { (Fields::encode(fieldValues, frame.data()), ...); }, values);
+	}
+};
+
+} // namespace xentara::plugins::templateDriver
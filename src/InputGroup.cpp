@@ -0,0 +1,254 @@
+// Copyright (c) embedded ocean GmbH
+#include "InputGroup.hpp"
+
+#include "NameBasedUuid.hpp"
+#include "SimulatedSignal.hpp"
+#include "Snapshot.hpp"
+#include "TemplateInput.hpp"
+
+#include <xentara/config/Errors.hpp>
+#include <xentara/utils/json/decoder/Errors.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace xentara::plugins::templateDriver
+{
+
+using namespace std::literals;
+
+namespace
+{
+
+	/// @brief The placeholder in the name pattern that is replaced by the index
+	constexpr auto kIndexPlaceholder = "{}"sv;
+
+} // namespace
+
+InputGroup::Input::Input(std::string name, const utils::core::Uuid &uuid, std::unique_ptr<AbstractTemplateInputHandler> handler) :
+	_name(std::move(name)),
+	_handler(std::move(handler)),
+	_attribute(uuid, _name, model::Attribute::Access::ReadOnly, _handler->dataType())
+{
+}
+
+auto InputGroup::load(utils::json::decoder::Object &jsonObject) -> void
+{
+	// Go through all the members of the JSON object that represents this object
+	for (auto && [name, value] : jsonObject)
+	{
+		if (name == "dataType"sv)
+		{
+			// Look up the data type once for all the inputs
+			_handlerFactory = TemplateInput::handlerFactory(value.asString<std::string>());
+			if (!_handlerFactory)
+			{
+				/// @todo replace "template input group" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("unknown data type in template input group"));
+			}
+		}
+		else if (name == "name"sv)
+		{
+			_namePattern = value.asString<std::string>();
+
+			// The pattern must contain exactly one placeholder
+			const auto placeholder = _namePattern.find(kIndexPlaceholder);
+			if (placeholder == std::string::npos ||
+				_namePattern.find(kIndexPlaceholder, placeholder + kIndexPlaceholder.size()) != std::string::npos)
+			{
+				/// @todo replace "template input group" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("the name of a template input group must contain \"{}\" exactly once"));
+			}
+		}
+		else if (name == "count"sv)
+		{
+			_count = value.asNumber<std::size_t>();
+
+			if (_count == 0)
+			{
+				/// @todo replace "template input group" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("the count of a template input group must not be 0"));
+			}
+		}
+		else if (name == "firstIndex"sv)
+		{
+			_firstIndex = value.asNumber<std::size_t>();
+		}
+		else if (name == "baseAddress"sv)
+		{
+			_baseAddress = value.asNumber<std::uint64_t>();
+		}
+		else if (name == "stride"sv)
+		{
+			_stride = value.asNumber<std::uint64_t>();
+		}
+		else
+		{
+			config::throwUnknownParameterError(name);
+		}
+	}
+
+	// Make sure that all the required parameters were specified
+	if (!_handlerFactory || _namePattern.empty() || _count == 0)
+	{
+		/// @todo replace "template input group" with a more descriptive name
+		utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("a template input group needs a data type, a name and a count"));
+	}
+
+}
+
+auto InputGroup::hash(std::uint64_t hash) const noexcept -> std::uint64_t
+{
+	hash = Snapshot::hash(_namePattern, hash);
+	hash = Snapshot::hash(std::as_bytes(std::span(&_count, 1)), hash);
+	return Snapshot::hash(std::as_bytes(std::span(&_firstIndex, 1)), hash);
+}
+
+auto InputGroup::expand(const utils::core::Uuid &componentUuid, LoadCache &cache) -> void
+{
+	const auto placeholder = _namePattern.find(kIndexPlaceholder);
+	const auto prefix = std::string_view(_namePattern).substr(0, placeholder);
+	const auto suffix = std::string_view(_namePattern).substr(placeholder + kIndexPlaceholder.size());
+	for (std::size_t index = 0; index < _count; ++index)
+	{
+		auto name = std::string(prefix);
+		name += std::to_string(_firstIndex + index);
+		name += suffix;
+
+		// Derive the UUID from the name, so that it stays the same as long as the name does
+		const auto uuid = makeNameBasedUuid(componentUuid, name);
+		cache.add(uuid, name);
+		_inputs.emplace_back(std::move(name), uuid, _handlerFactory());
+	}
+
+	sortInputs();
+}
+
+auto InputGroup::expand(std::span<const LoadCache::Input> inputs) -> void
+{
+	for (auto &&input : inputs)
+	{
+		_inputs.emplace_back(std::string(input._name), input._uuid, _handlerFactory());
+	}
+
+	sortInputs();
+}
+
+auto InputGroup::sortInputs() -> void
+{
+	// Sort the inputs by the address of their attribute, so makeReadHandle() can find them using a binary search
+	_inputsByAttribute.reserve(_inputs.size());
+	for (auto &&input : _inputs)
+	{
+		_inputsByAttribute.push_back(&input);
+	}
+	std::ranges::sort(_inputsByAttribute, std::less {}, [](const Input *input) { return &input->_attribute; });
+}
+
+auto InputGroup::setRuntimeCounters(RuntimeCounters &counters) -> void
+{
+	for (auto &&input : _inputs)
+	{
+		input._handler->setRuntimeCounters(counters);
+	}
+}
+
+auto InputGroup::simulate(Simulator &simulator, std::size_t firstIndex) -> void
+{
+	// Give each input its own seed, so that the inputs don't all generate the same values
+	SimulatedSignal signal;
+	for (std::size_t index = 0; index < _inputs.size(); ++index)
+	{
+		signal.start(simulator.seed() + firstIndex + index);
+		_inputs[index]._handler->simulate(simulator, signal);
+	}
+}
+
+auto InputGroup::replay(Replayer &replayer, std::size_t firstPoint) -> void
+{
+	for (std::size_t index = 0; index < _inputs.size(); ++index)
+	{
+		_inputs[index]._handler->replay(replayer, firstPoint + index);
+	}
+}
+
+auto InputGroup::forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool
+{
+	for (auto &&input : _inputs)
+	{
+		if (function(input._attribute))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+auto InputGroup::makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>
+{
+	// Look up the input by the identity of the attribute
+	const auto input = std::ranges::lower_bound(_inputsByAttribute, &attribute, std::less {},
+		[](const Input *input) { return &input->_attribute; });
+	if (input == _inputsByAttribute.end() || &(*input)->_attribute != &attribute)
+	{
+		return std::nullopt;
+	}
+
+	return (*input)->_handler->valueReadHandle();
+}
+
+auto InputGroup::realize() -> void
+{
+	for (auto &&input : _inputs)
+	{
+		input._handler->realize();
+	}
+}
+
+auto InputGroup::acquire(std::size_t index, const AcquisitionClock &clock) -> void
+{
+	/// @todo read the input at address(index) instead
+	_inputs[index]._handler->acquire(clock);
+}
+
+auto InputGroup::acquireAll(const AcquisitionClock &clock) -> void
+{
+	/// @todo if the I/O component supports block reads, read the inputs using as few block reads as possible instead
+	for (std::size_t index = 0; index < _inputs.size(); ++index)
+	{
+		acquire(index, clock);
+	}
+}
+
+auto InputGroup::publish(std::chrono::system_clock::time_point timeStamp) -> void
+{
+	for (auto &&input : _inputs)
+	{
+		input._handler->publish(timeStamp);
+	}
+}
+
+auto InputGroup::invalidateData(std::chrono::system_clock::time_point timeStamp) -> void
+{
+	for (auto &&input : _inputs)
+	{
+		input._handler->invalidateData(timeStamp);
+	}
+}
+
+auto InputGroup::footprint() const noexcept -> MemoryFootprint
+{
+	MemoryFootprint footprint;
+	for (auto &&input : _inputs)
+	{
+		footprint += input._handler->footprint();
+		footprint._object += sizeof(Input);
+	}
+	footprint._object += _inputsByAttribute.capacity() * sizeof(const Input *);
+	return footprint;
+}
+
+} // namespace xentara::plugins::templateDriver
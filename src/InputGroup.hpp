@@ -0,0 +1,160 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include "AbstractTemplateInputHandler.hpp"
+#include "AcquisitionClock.hpp"
+#include "LoadCache.hpp"
+#include "MemoryFootprint.hpp"
+#include "Replayer.hpp"
+#include "RuntimeCounters.hpp"
+#include "Simulator.hpp"
+#include "TemplateInput.hpp"
+
+#include <xentara/data/ReadHandle.hpp>
+#include <xentara/model/Attribute.hpp>
+#include <xentara/model/ForEachAttributeFunction.hpp>
+#include <xentara/utils/core/Uuid.hpp>
+#include <xentara/utils/json/decoder/Object.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief A group of identical inputs that are generated from a pattern instead of being configured one by one.
+///
+/// Large I/O components often have thousands of inputs that only differ by address and name. Instead of a separate
+/// Xentara element for each of them, a group is configured using a single JSON object in the configuration of the
+/// I/O component, and publishes the value of each input as an attribute of the I/O component.
+///
+/// The inputs of a group only publish their value. They support simulation and replay, but no oversampling, sample
+/// history, snapshots, events or poll dividers. Inputs that need any of these must be configured individually.
+class InputGroup final
+{
+public:
+	/// @brief Loads the parameters of the group from the configuration.
+	///
+	/// The inputs are not created until expand() is called.
+	/// @param jsonObject The JSON object describing the group
+	/// @throw std::runtime_error The configuration is invalid
+	auto load(utils::json::decoder::Object &jsonObject) -> void;
+
+	/// @brief Adds the parameters that determine the names and UUIDs of the inputs to a hash
+	/// @param hash The hash of any preceding data
+	auto hash(std::uint64_t hash) const noexcept -> std::uint64_t;
+
+	/// @brief Creates the inputs, generating their names and UUIDs
+	/// @param componentUuid The UUID of the I/O component. The UUIDs of the attributes are derived from this UUID and
+	/// the names of the inputs.
+	/// @param cache The cache to add the names and UUIDs to
+	auto expand(const utils::core::Uuid &componentUuid, LoadCache &cache) -> void;
+
+	/// @brief Creates the inputs, taking their names and UUIDs from the cache
+	/// @param inputs The cached inputs of the group. There must be one for each input.
+	auto expand(std::span<const LoadCache::Input> inputs) -> void;
+
+	/// @brief Returns the number of inputs in the group
+	auto size() const noexcept -> std::size_t
+	{
+		return _count;
+	}
+
+	/// @brief Returns the name of an input, which is also the name of its attribute. Only valid after expand().
+	auto name(std::size_t index) const noexcept -> std::string_view
+	{
+		return _inputs[index]._name;
+	}
+
+	/// @brief Returns the address of an input on the I/O component
+	auto address(std::size_t index) const noexcept -> std::uint64_t
+	{
+		return _baseAddress + index * _stride;
+	}
+
+	/// @brief Sets the counters that count the reads of the inputs
+	/// @param counters The counters. The counters must remain valid for as long as the group exists.
+	auto setRuntimeCounters(RuntimeCounters &counters) -> void;
+
+	/// @brief Reads the values from a simulation instead of the I/O component
+	/// @param simulator The simulator
+	/// @param firstIndex The index used to derive the seed of the first input. The following inputs use consecutive indices.
+	auto simulate(Simulator &simulator, std::size_t firstIndex) -> void;
+
+	/// @brief Reads the values from a replay file instead of the I/O component
+	/// @param replayer The replayer
+	/// @param firstPoint The point in the replay file of the first input. The following inputs use consecutive points.
+	auto replay(Replayer &replayer, std::size_t firstPoint) -> void;
+
+	/// @brief Iterates over the value attributes of the inputs.
+	/// @param function The function that should be called for each attribute
+	/// @return The return value of the last function call
+	auto forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool;
+
+	/// @brief Creates a read-handle for the value attribute of one of the inputs.
+	/// @param attribute The attribute to create the handle for
+	/// @return A read handle for the attribute, or std::nullopt if the attribute is not the value attribute of an input
+	auto makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>;
+
+	/// @brief Realizes the inputs
+	auto realize() -> void;
+
+	/// @brief Acquires the value of a single input without publishing it.
+	auto acquire(std::size_t index, const AcquisitionClock &clock) -> void;
+	/// @brief Acquires the values of all the inputs without publishing them.
+	auto acquireAll(const AcquisitionClock &clock) -> void;
+	/// @brief Publishes the values acquired using acquire() or acquireAll(), if any
+	auto publish(std::chrono::system_clock::time_point timeStamp) -> void;
+	/// @brief Invalidates any read data
+	auto invalidateData(std::chrono::system_clock::time_point timeStamp) -> void;
+
+	/// @brief Returns the memory used by the inputs, including their handlers, their data blocks and their attributes
+	auto footprint() const noexcept -> MemoryFootprint;
+
+private:
+	/// @brief A single input of the group
+	struct Input final
+	{
+		/// @brief Constructor
+		Input(std::string name, const utils::core::Uuid &uuid, std::unique_ptr<AbstractTemplateInputHandler> handler);
+
+		/// @brief The name of the input
+		std::string _name;
+		/// @brief The handler for data type specific functionality
+		std::unique_ptr<AbstractTemplateInputHandler> _handler;
+		/// @brief The attribute the value is published as. This refers to _name, so the input must never be moved.
+		model::Attribute _attribute;
+	};
+
+	/// @brief Sorts the inputs by the address of their attribute
+	auto sortInputs() -> void;
+
+	/// @brief The function that creates the handlers of the inputs
+	TemplateInput::HandlerFactory _handlerFactory { nullptr };
+	/// @brief The pattern the names are generated from
+	std::string _namePattern;
+	/// @brief The number of inputs
+	std::size_t _count { 0 };
+	/// @brief The index of the first input
+	std::size_t _firstIndex { 0 };
+
+	/// @brief The address of the first input
+	std::uint64_t _baseAddress { 0 };
+	/// @brief The difference between the addresses of consecutive inputs
+	std::uint64_t _stride { 1 };
+
+	/// @brief The inputs. A deque is used, because the inputs must not be moved once they have been created.
+	std::deque<Input> _inputs;
+	/// @brief The inputs, sorted by the address of their attribute
+	std::vector<const Input *> _inputsByAttribute;
+};
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,99 @@
+// Copyright (c) embedded ocean GmbH
+#include "LoadCache.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+namespace xentara::plugins::templateDriver
+{
+
+static_assert(std::is_trivially_copyable_v<utils::core::Uuid>, "UUIDs must be trivially copyable to be cached");
+
+auto LoadCache::read(const std::filesystem::path &path, std::uint64_t key) -> bool
+{
+	_names.clear();
+	_inputs.clear();
+
+	// A missing file simply means that there is no cache yet
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	// Read the whole file at once
+	file.seekg(0, std::ios::end);
+	const auto fileSize = std::size_t(file.tellg());
+	file.seekg(0);
+	std::vector<char> data(fileSize);
+	if (!file.read(data.data(), std::streamsize(fileSize)))
+	{
+		throw std::runtime_error("could not read load cache file");
+	}
+
+	// Check the header
+	FileHeader header {};
+	if (fileSize < sizeof(header))
+	{
+		return false;
+	}
+	std::memcpy(&header, data.data(), sizeof(header));
+	if (header._magic != kMagic || header._key != key ||
+		header._inputCount > (fileSize - sizeof(header)) / sizeof(Entry) ||
+		fileSize != sizeof(header) + header._inputCount * sizeof(Entry) + header._namesSize)
+	{
+		return false;
+	}
+
+	// Take the names, which follow the entries
+	const auto namesOffset = sizeof(header) + header._inputCount * sizeof(Entry);
+	_names.assign(data.begin() + std::ptrdiff_t(namesOffset), data.end());
+
+	// Decode the entries
+	_inputs.reserve(header._inputCount);
+	for (std::size_t index = 0; index < header._inputCount; ++index)
+	{
+		Entry entry;
+		std::memcpy(&entry, data.data() + sizeof(header) + index * sizeof(Entry), sizeof(entry));
+		if (entry._nameOffset > _names.size() || entry._nameSize > _names.size() - entry._nameOffset)
+		{
+			_names.clear();
+			_inputs.clear();
+			return false;
+		}
+		_inputs.push_back({ entry._uuid, std::string_view(_names.data() + entry._nameOffset, entry._nameSize) });
+	}
+
+	return true;
+}
+
+auto LoadCache::add(const utils::core::Uuid &uuid, std::string_view name) -> void
+{
+	_entries.push_back({ uuid, _names.size(), name.size() });
+	_names.insert(_names.end(), name.begin(), name.end());
+}
+
+auto LoadCache::write(const std::filesystem::path &path, std::uint64_t key) const -> void
+{
+	std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		throw std::system_error(errno, std::generic_category(), "could not create load cache file");
+	}
+
+	const FileHeader header { kMagic, key, _entries.size(), _names.size() };
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char *>(_entries.data()), std::streamsize(_entries.size() * sizeof(Entry)));
+	file.write(_names.data(), std::streamsize(_names.size()));
+	file.close();
+	if (!file)
+	{
+		throw std::system_error(errno, std::generic_category(), "could not write load cache file");
+	}
+}
+
+} // namespace xentara::plugins::templateDriver
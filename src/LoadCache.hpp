@@ -0,0 +1,100 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <xentara/utils/core/Uuid.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief A file caching the inputs that the input groups of an I/O component expand to.
+///
+/// Expanding an input group means generating the name of each input, deriving its UUID from the name, and checking that
+/// the names are unique. For large groups, this dominates the time needed to load the I/O component. The cache stores
+/// the result, so that the next start only has to create the handlers.
+///
+/// The cache is keyed by a hash of everything the expansion depends on. If the key does not match, the cache is ignored
+/// and rewritten. The file consists of a header, followed by a fixed size entry for each input and the characters of
+/// the names. Reading it only takes a single read of the file, without any parsing.
+class LoadCache final
+{
+public:
+	/// @brief A cached input
+	struct Input final
+	{
+		/// @brief The UUID of the attribute
+		utils::core::Uuid _uuid;
+		/// @brief The name of the input
+		std::string_view _name;
+	};
+
+	/// @brief Reads the cache file
+	/// @param path The path of the file
+	/// @param key The key the cache must have been written with
+	/// @return Whether the file exists and was written with the same key. If not, the cache is empty.
+	/// @throw std::runtime_error The file exists, but could not be read
+	auto read(const std::filesystem::path &path, std::uint64_t key) -> bool;
+
+	/// @brief Returns the cached inputs, in the order they were added
+	auto inputs() const noexcept -> std::span<const Input>
+	{
+		return _inputs;
+	}
+
+	/// @brief Adds an input, so that it is included when writing the cache
+	/// @param uuid The UUID of the attribute
+	/// @param name The name of the input
+	auto add(const utils::core::Uuid &uuid, std::string_view name) -> void;
+
+	/// @brief Writes the inputs that were added to the cache file, replacing any previous contents
+	/// @param path The path of the file
+	/// @param key The key to write the cache with
+	/// @throw std::system_error The file could not be written
+	auto write(const std::filesystem::path &path, std::uint64_t key) const -> void;
+
+	/// @brief The version of the file layout. This must be included in the key.
+	static constexpr std::uint64_t kVersion = 1;
+
+private:
+	/// @brief The header at the start of the file
+	struct FileHeader final
+	{
+		/// @brief The magic number identifying the file type
+		std::uint64_t _magic;
+		/// @brief The key
+		std::uint64_t _key;
+		/// @brief The number of inputs
+		std::uint64_t _inputCount;
+		/// @brief The total size of the names
+		std::uint64_t _namesSize;
+	};
+
+	/// @brief The entry for a single input, which follows the header
+	struct Entry final
+	{
+		/// @brief The UUID of the attribute
+		utils::core::Uuid _uuid;
+		/// @brief The offset of the name within the names
+		std::uint64_t _nameOffset;
+		/// @brief The length of the name
+		std::uint64_t _nameSize;
+	};
+
+	/// @brief The magic number identifying the file type
+	static constexpr std::uint64_t kMagic = 0x31'44'41'4f'4c'44'54'58; // "XTDLOAD1"
+
+	/// @brief The names of the inputs that were read or added
+	std::vector<char> _names;
+	/// @brief The inputs that were read. The names refer to _names.
+	std::vector<Input> _inputs;
+	/// @brief The entries of the inputs that were added, for writing
+	std::vector<Entry> _entries;
+};
+
+} // namespace xentara::plugins::templateDriver
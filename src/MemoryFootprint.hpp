@@ -0,0 +1,41 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <cstddef>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief The memory used by a data point, broken down by purpose.
+///
+/// The sizes are in bytes, and include memory allocated on the heap where it is known. They do not include the overhead
+/// of the heap itself.
+struct MemoryFootprint final
+{
+	/// @brief The data point object itself, not including the handler
+	std::size_t _object { 0 };
+	/// @brief The data type specific handler, including any sample history and oversampling buffers
+	std::size_t _handler { 0 };
+	/// @brief The state stored in Xentara data memory
+	std::size_t _dataBlock { 0 };
+	/// @brief The Xentara events that were created
+	std::size_t _events { 0 };
+
+	/// @brief Returns the total memory used
+	auto total() const noexcept -> std::size_t
+	{
+		return _object + _handler + _dataBlock + _events;
+	}
+
+	/// @brief Adds another footprint to this one
+	auto operator+=(const MemoryFootprint &other) noexcept -> MemoryFootprint &
+	{
+		_object += other._object;
+		_handler += other._handler;
+		_dataBlock += other._dataBlock;
+		_events += other._events;
+		return *this;
+	}
+};
+
+} // namespace xentara::plugins::templateDriver
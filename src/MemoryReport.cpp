@@ -0,0 +1,64 @@
+// Copyright (c) embedded ocean GmbH
+#include "MemoryReport.hpp"
+
+#include "Attributes.hpp"
+#include "ReadHandleTable.hpp"
+
+#include <xentara/memory/memoryResources.hpp>
+#include <xentara/memory/WriteSentinel.hpp>
+
+#include <array>
+
+namespace xentara::plugins::templateDriver
+{
+
+auto MemoryReport::update(const MemoryFootprint &inputs, std::size_t inputCount, const MemoryFootprint &outputs, std::size_t outputCount) -> void
+{
+	auto total = inputs;
+	total += outputs;
+
+	// Make a write sentinel and commit the new values
+	memory::WriteSentinel sentinel { _dataBlock };
+	sentinel->_objectMemory = total._object;
+	sentinel->_handlerMemory = total._handler;
+	sentinel->_dataBlockMemory = total._dataBlock;
+	sentinel->_eventMemory = total._events;
+	sentinel->_memoryPerInput = inputCount > 0 ? double(inputs.total()) / double(inputCount) : 0.0;
+	sentinel->_memoryPerOutput = outputCount > 0 ? double(outputs.total()) / double(outputCount) : 0.0;
+	sentinel.commit();
+}
+
+auto MemoryReport::forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool
+{
+	// Handle all the attributes we support
+	return
+		function(attributes::kObjectMemory) ||
+		function(attributes::kHandlerMemory) ||
+		function(attributes::kDataBlockMemory) ||
+		function(attributes::kEventMemory) ||
+		function(attributes::kMemoryPerInput) ||
+		function(attributes::kMemoryPerOutput);
+}
+
+auto MemoryReport::makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>
+{
+	// All the attributes we support
+	static constexpr std::array<ReadHandleEntry<MemoryReport>, 6> kReadHandles { {
+		{ &attributes::kObjectMemory, [](const MemoryReport &self) { return data::ReadHandle(self._dataBlock.member(&State::_objectMemory)); } },
+		{ &attributes::kHandlerMemory, [](const MemoryReport &self) { return data::ReadHandle(self._dataBlock.member(&State::_handlerMemory)); } },
+		{ &attributes::kDataBlockMemory, [](const MemoryReport &self) { return data::ReadHandle(self._dataBlock.member(&State::_dataBlockMemory)); } },
+		{ &attributes::kEventMemory, [](const MemoryReport &self) { return data::ReadHandle(self._dataBlock.member(&State::_eventMemory)); } },
+		{ &attributes::kMemoryPerInput, [](const MemoryReport &self) { return data::ReadHandle(self._dataBlock.member(&State::_memoryPerInput)); } },
+		{ &attributes::kMemoryPerOutput, [](const MemoryReport &self) { return data::ReadHandle(self._dataBlock.member(&State::_memoryPerOutput)); } }
+	} };
+
+	return lookUpReadHandle<kReadHandles>(*this, attribute);
+}
+
+auto MemoryReport::realize() -> void
+{
+	// Create the data block
+	_dataBlock.create(memory::memoryResources::data());
+}
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,68 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include "MemoryFootprint.hpp"
+
+#include <xentara/data/ReadHandle.hpp>
+#include <xentara/memory/ObjectBlock.hpp>
+#include <xentara/model/Attribute.hpp>
+#include <xentara/model/ForEachAttributeFunction.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief Publishes the memory used by the data points of an I/O component.
+///
+/// The report breaks the memory down into the data point objects, the data type specific handlers, the state stored in
+/// Xentara data memory, and the Xentara events. It also publishes the average memory used per input and output, which
+/// can be used to estimate the memory needed for larger configurations.
+class MemoryReport final
+{
+public:
+	/// @brief Publishes the memory used by the data points
+	/// @param inputs The combined footprint of all the inputs
+	/// @param inputCount The number of inputs
+	/// @param outputs The combined footprint of all the outputs
+	/// @param outputCount The number of outputs
+	auto update(const MemoryFootprint &inputs, std::size_t inputCount, const MemoryFootprint &outputs, std::size_t outputCount) -> void;
+
+	/// @brief Iterates over all the attributes that belong to the report.
+	/// @param function The function that should be called for each attribute
+	/// @return The return value of the last function call
+	auto forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool;
+
+	/// @brief Creates a read-handle for an attribute that belongs to the report.
+	/// @param attribute The attribute to create the handle for
+	/// @return A read handle for the attribute, or std::nullopt if the attribute is unknown
+	auto makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>;
+
+	/// @brief Realizes the report
+	auto realize() -> void;
+
+private:
+	/// @brief This structure is used to represent the state inside the memory block
+	struct State final
+	{
+		/// @brief The memory used by the data point objects, in bytes
+		std::uint64_t _objectMemory { 0 };
+		/// @brief The memory used by the data type specific handlers, in bytes
+		std::uint64_t _handlerMemory { 0 };
+		/// @brief The memory used by the data blocks of the data points, in bytes
+		std::uint64_t _dataBlockMemory { 0 };
+		/// @brief The memory used by the events of the data points, in bytes
+		std::uint64_t _eventMemory { 0 };
+		/// @brief The average memory used per input, in bytes
+		double _memoryPerInput { 0 };
+		/// @brief The average memory used per output, in bytes
+		double _memoryPerOutput { 0 };
+	};
+
+	/// @brief The data block that contains the state
+	memory::ObjectBlock<State> _dataBlock;
+};
+
+} // namespace xentara::plugins::templateDriver
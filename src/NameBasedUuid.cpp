@@ -0,0 +1,137 @@
+// Copyright (c) embedded ocean GmbH
+#include "NameBasedUuid.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace xentara::plugins::templateDriver
+{
+
+namespace
+{
+
+	/// @brief The bytes of a UUID, in the order given in RFC 4122
+	using UuidBytes = std::array<std::byte, 16>;
+
+	static_assert(sizeof(utils::core::Uuid) == sizeof(UuidBytes) && std::is_trivially_copyable_v<utils::core::Uuid>,
+		"UUIDs must be stored as 16 bytes");
+
+	/// @brief A SHA-1 digest
+	using Sha1Digest = std::array<std::byte, 20>;
+
+	/// @brief Computes the SHA-1 digest of a message, as described in RFC 3174.
+	///
+	/// SHA-1 is only used because RFC 4122 prescribes it for version 5 UUIDs. It must not be used for anything that
+	/// needs to be secure.
+	auto sha1(std::vector<std::byte> message) -> Sha1Digest
+	{
+		// Pad the message to a multiple of 64 bytes, including the 8 byte message length in bits
+		const auto bitLength = std::uint64_t(message.size()) * 8;
+		message.push_back(std::byte { 0x80 });
+		while (message.size() % 64 != 56)
+		{
+			message.push_back(std::byte { 0 });
+		}
+		for (int shift = 56; shift >= 0; shift -= 8)
+		{
+			message.push_back(std::byte(bitLength >> shift));
+		}
+
+		std::array<std::uint32_t, 5> hash { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+		for (std::size_t block = 0; block < message.size(); block += 64)
+		{
+			// Expand the block into 80 words
+			std::array<std::uint32_t, 80> words;
+			for (std::size_t index = 0; index < 16; ++index)
+			{
+				const auto *bytes = &message[block + index * 4];
+				words[index] = std::uint32_t(bytes[0]) << 24 | std::uint32_t(bytes[1]) << 16 |
+					std::uint32_t(bytes[2]) << 8 | std::uint32_t(bytes[3]);
+			}
+			for (std::size_t index = 16; index < 80; ++index)
+			{
+				words[index] = std::rotl(words[index - 3] ^ words[index - 8] ^ words[index - 14] ^ words[index - 16], 1);
+			}
+
+			auto [a, b, c, d, e] = hash;
+			for (std::size_t index = 0; index < 80; ++index)
+			{
+				std::uint32_t function;
+				std::uint32_t constant;
+				if (index < 20)
+				{
+					function = (b & c) | (~b & d);
+					constant = 0x5a827999;
+				}
+				else if (index < 40)
+				{
+					function = b ^ c ^ d;
+					constant = 0x6ed9eba1;
+				}
+				else if (index < 60)
+				{
+					function = (b & c) | (b & d) | (c & d);
+					constant = 0x8f1bbcdc;
+				}
+				else
+				{
+					function = b ^ c ^ d;
+					constant = 0xca62c1d6;
+				}
+
+				const auto temp = std::rotl(a, 5) + function + e + constant + words[index];
+				e = d;
+				d = c;
+				c = std::rotl(b, 30);
+				b = a;
+				a = temp;
+			}
+
+			hash[0] += a;
+			hash[1] += b;
+			hash[2] += c;
+			hash[3] += d;
+			hash[4] += e;
+		}
+
+		// Store the hash in big endian order
+		Sha1Digest digest;
+		for (std::size_t index = 0; index < digest.size(); ++index)
+		{
+			digest[index] = std::byte(hash[index / 4] >> (24 - index % 4 * 8));
+		}
+		return digest;
+	}
+
+} // namespace
+
+auto makeNameBasedUuid(const utils::core::Uuid &namespaceUuid, std::string_view name) -> utils::core::Uuid
+{
+	// Hash the namespace UUID followed by the name
+	const auto namespaceBytes = std::bit_cast<UuidBytes>(namespaceUuid);
+	std::vector<std::byte> message(namespaceBytes.begin(), namespaceBytes.end());
+	message.reserve(message.size() + name.size());
+	for (auto character : name)
+	{
+		message.push_back(std::byte(character));
+	}
+	const auto digest = sha1(std::move(message));
+
+	// Take the first 16 bytes of the hash, and set the version and variant
+	UuidBytes bytes;
+	for (std::size_t index = 0; index < bytes.size(); ++index)
+	{
+		bytes[index] = digest[index];
+	}
+	bytes[6] = (bytes[6] & std::byte { 0x0f }) | std::byte { 0x50 };
+	bytes[8] = (bytes[8] & std::byte { 0x3f }) | std::byte { 0x80 };
+
+	return std::bit_cast<utils::core::Uuid>(bytes);
+}
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,20 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <xentara/utils/core/Uuid.hpp>
+
+#include <string_view>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief Derives a name-based UUID, as described for version 5 UUIDs in RFC 4122.
+///
+/// The same namespace UUID and name always give the same UUID, so elements generated from the configuration keep their
+/// UUIDs when the configuration is reloaded.
+/// @param namespaceUuid The UUID of the namespace the name belongs to, e.g. the UUID of the parent element
+/// @param name The name
+/// @return The UUID
+auto makeNameBasedUuid(const utils::core::Uuid &namespaceUuid, std::string_view name) -> utils::core::Uuid;
+
+} // namespace xentara::plugins::templateDriver
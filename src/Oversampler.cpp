@@ -0,0 +1,137 @@
+// Copyright (c) embedded ocean GmbH
+#include "Oversampler.hpp"
+
+#include "Attributes.hpp"
+#include "ReadHandleTable.hpp"
+
+#include <xentara/data/DataType.hpp>
+#include <xentara/memory/memoryResources.hpp>
+#include <xentara/memory/WriteSentinel.hpp>
+#include <xentara/utils/core/Uuid.hpp>
+#include <xentara/utils/tools/Concepts.hpp>
+
+#include <array>
+#include <utility>
+
+namespace xentara::plugins::templateDriver
+{
+
+using namespace std::literals;
+using namespace xentara::literals;
+
+namespace
+{
+
+	/// @brief Determines the data type of the minimum and maximum attributes
+	template <typename ValueType>
+	constexpr auto aggregateDataType() -> const data::DataType &
+	{
+		if constexpr (utils::tools::Integral<ValueType>)
+		{
+			return data::DataType::kInteger;
+		}
+		else
+		{
+			return data::DataType::kFloatingPoint;
+		}
+	}
+
+} // namespace
+
+/// @todo assign a unique UUID
+template <typename ValueType>
+const model::Attribute Oversampler<ValueType>::kMinimumAttribute {
+	"deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "minimum"sv, model::Attribute::Access::ReadOnly, aggregateDataType<ValueType>() };
+
+/// @todo assign a unique UUID
+template <typename ValueType>
+const model::Attribute Oversampler<ValueType>::kMaximumAttribute {
+	"deadbeef-dead-beef-dead-beefdeadbeef"_uuid, "maximum"sv, model::Attribute::Access::ReadOnly, aggregateDataType<ValueType>() };
+
+template <typename ValueType>
+auto Oversampler<ValueType>::forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool
+{
+	// Handle all the attributes we support
+	return
+		function(kMinimumAttribute) ||
+		function(kMaximumAttribute) ||
+		function(attributes::kMean) ||
+		function(attributes::kSampleCount);
+}
+
+template <typename ValueType>
+auto Oversampler<ValueType>::makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>
+{
+	// All the attributes we support
+	static constexpr std::array<ReadHandleEntry<Oversampler>, 4> kReadHandles { {
+		{ &kMinimumAttribute, [](const Oversampler &self) { return data::ReadHandle(self._dataBlock.member(&Aggregate<ValueType>::_minimum)); } },
+		{ &kMaximumAttribute, [](const Oversampler &self) { return data::ReadHandle(self._dataBlock.member(&Aggregate<ValueType>::_maximum)); } },
+		{ &attributes::kMean, [](const Oversampler &self) { return data::ReadHandle(self._dataBlock.member(&Aggregate<ValueType>::_mean)); } },
+		{ &attributes::kSampleCount, [](const Oversampler &self) { return data::ReadHandle(self._dataBlock.member(&Aggregate<ValueType>::_count)); } }
+	} };
+
+	return lookUpReadHandle<kReadHandles>(*this, attribute);
+}
+
+template <typename ValueType>
+auto Oversampler<ValueType>::realize() -> void
+{
+	// Create the data block
+	_dataBlock.create(memory::memoryResources::data());
+}
+
+template <typename ValueType>
+auto Oversampler<ValueType>::addSample(Sample &&sample) -> void
+{
+	std::scoped_lock lock { _mutex };
+
+	// Only values go into the aggregate
+	if (sample._valueOrError)
+	{
+		_pendingValues.push_back(*sample._valueOrError);
+	}
+	_lastSample = std::move(sample);
+}
+
+template <typename ValueType>
+auto Oversampler<ValueType>::collect() -> std::optional<Sample>
+{
+	std::optional<Sample> lastSample;
+
+	// Take the pending values, holding the lock as briefly as possible
+	{
+		std::scoped_lock lock { _mutex };
+		std::swap(_pendingValues, _values);
+		lastSample = std::exchange(_lastSample, std::nullopt);
+	}
+
+	// Compute the aggregate outside the lock, so that the sampler thread is not held up
+	_aggregate = aggregate<ValueType>(_values);
+	_values.clear();
+
+	return lastSample;
+}
+
+template <typename ValueType>
+auto Oversampler<ValueType>::publish() -> void
+{
+	// Make a write sentinel and commit the aggregate
+	memory::WriteSentinel sentinel { _dataBlock };
+	*sentinel = _aggregate;
+	sentinel.commit();
+}
+
+/// @class xentara::plugins::templateDriver::Oversampler
+/// @todo change list of template instantiations to the supported types
+template class Oversampler<std::uint8_t>;
+template class Oversampler<std::uint16_t>;
+template class Oversampler<std::uint32_t>;
+template class Oversampler<std::uint64_t>;
+template class Oversampler<std::int8_t>;
+template class Oversampler<std::int16_t>;
+template class Oversampler<std::int32_t>;
+template class Oversampler<std::int64_t>;
+template class Oversampler<float>;
+template class Oversampler<double>;
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,113 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include "Aggregate.hpp"
+#include "MemoryFootprint.hpp"
+
+#include <xentara/data/ReadHandle.hpp>
+#include <xentara/memory/ObjectBlock.hpp>
+#include <xentara/model/Attribute.hpp>
+#include <xentara/model/ForEachAttributeFunction.hpp>
+#include <xentara/utils/eh/expected.hpp>
+
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <vector>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief Collects samples taken at a higher rate than the read task, and publishes their minimum, maximum and mean.
+///
+/// The samples are added by the sampler thread of the I/O component, and collected once per cycle of the read task.
+template <typename ValueType>
+class Oversampler final
+{
+public:
+	/// @brief The last sample taken
+	struct Sample final
+	{
+		/// @brief The value, or the error that occurred when reading it
+		utils::eh::expected<ValueType, std::error_code> _valueOrError;
+		/// @brief The acquisition time stamp, or std::nullopt if acquisition time stamps are disabled
+		std::optional<std::chrono::system_clock::time_point> _timeStamp;
+	};
+
+	/// @brief Iterates over all the attributes that belong to the oversampler.
+	/// @param function The function that should be called for each attribute
+	/// @return The return value of the last function call
+	auto forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool;
+
+	/// @brief Creates a read-handle for an attribute that belongs to the oversampler.
+	/// @param attribute The attribute to create the handle for
+	/// @return A read handle for the attribute, or std::nullopt if the attribute is unknown
+	auto makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>;
+
+	/// @brief Realizes the oversampler
+	auto realize() -> void;
+
+	/// @brief Adds the memory used by the oversampler to a footprint
+	/// @note The sample buffers are not included, because they are owned by the sampler thread. They grow to the
+	/// largest number of samples taken in a single cycle.
+	auto addFootprint(MemoryFootprint &footprint) const noexcept -> void
+	{
+		footprint._handler += sizeof(*this);
+		footprint._dataBlock += sizeof(Aggregate<ValueType>);
+	}
+
+	/// @brief Adds a sample.
+	/// @note This function is called from the sampler thread of the I/O component.
+	/// @param sample The sample. Errors are not included in the aggregate.
+	auto addSample(Sample &&sample) -> void;
+
+	/// @brief Aggregates the samples added since the last call.
+	/// @return The last sample added since the last call, or std::nullopt if no samples were added
+	auto collect() -> std::optional<Sample>;
+
+	/// @brief Publishes the aggregate computed by the last call to collect()
+	auto publish() -> void;
+
+	/// @brief A Xentara attribute containing the smallest sample of the last cycle.
+	/// @note This is a member of this class rather than of the attributes namespace, because the type depends on the
+	/// value type
+	static const model::Attribute kMinimumAttribute;
+	/// @brief A Xentara attribute containing the largest sample of the last cycle.
+	/// @note This is a member of this class rather than of the attributes namespace, because the type depends on the
+	/// value type
+	static const model::Attribute kMaximumAttribute;
+
+private:
+	/// @brief The mutex protecting the pending samples
+	std::mutex _mutex;
+	/// @brief The values added since the last call to collect()
+	std::vector<ValueType> _pendingValues;
+	/// @brief The last sample added since the last call to collect(), or std::nullopt if none were added
+	std::optional<Sample> _lastSample;
+
+	/// @brief The values being aggregated.
+	///
+	/// This is swapped with _pendingValues, so that neither vector needs to allocate once they have grown to size.
+	std::vector<ValueType> _values;
+	/// @brief The aggregate computed by the last call to collect()
+	Aggregate<ValueType> _aggregate;
+
+	/// @brief The data block that contains the aggregate
+	memory::ObjectBlock<Aggregate<ValueType>> _dataBlock;
+};
+
+/// @class xentara::plugins::templateDriver::Oversampler
+/// @todo change list of extern template statements to the supported types
+extern template class Oversampler<std::uint8_t>;
+extern template class Oversampler<std::uint16_t>;
+extern template class Oversampler<std::uint32_t>;
+extern template class Oversampler<std::uint64_t>;
+extern template class Oversampler<std::int8_t>;
+extern template class Oversampler<std::int16_t>;
+extern template class Oversampler<std::int32_t>;
+extern template class Oversampler<std::int64_t>;
+extern template class Oversampler<float>;
+extern template class Oversampler<double>;
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,108 @@
+// Copyright (c) embedded ocean GmbH
+#include "PackedWord.hpp"
+
+#include "TemplateIoComponent.hpp"
+
+#include <xentara/utils/eh/currentErrorCode.hpp>
+
+#include <exception>
+
+namespace xentara::plugins::templateDriver
+{
+
+PackedWord::PackedWord(std::reference_wrapper<TemplateIoComponent> ioComponent, std::uint64_t address) :
+	_ioComponent(ioComponent), _address(address)
+{
+	// The word has not been read yet
+	publish(utils::eh::unexpected(make_error_code(CustomError::NoData)));
+}
+
+auto PackedWord::refresh() noexcept -> void
+{
+	utils::eh::expected<std::uint64_t, std::error_code> word { utils::eh::unexpected(make_error_code(CustomError::NoData)) };
+	try
+	{
+		word = _ioComponent.get().readWord(_address);
+	}
+	catch (const std::exception &)
+	{
+		// Get the error from the current exception using this special utility function
+		word = utils::eh::unexpected(utils::eh::currentErrorCode());
+	}
+
+	publish(word);
+}
+
+auto PackedWord::publish(const utils::eh::expected<std::uint64_t, std::error_code> &word) noexcept -> void
+{
+	std::scoped_lock lock { _publishMutex };
+
+	// Make the sequence number odd while the word is being updated
+	const auto sequence = _sequence.load(std::memory_order_relaxed);
+	_sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	if (word)
+	{
+		_word.store(*word, std::memory_order_relaxed);
+		_errorValue.store(0, std::memory_order_relaxed);
+	}
+	else
+	{
+		_errorValue.store(word.error().value(), std::memory_order_relaxed);
+		_errorCategory.store(&word.error().category(), std::memory_order_relaxed);
+	}
+
+	_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+auto PackedWord::bit(unsigned index) const -> bool
+{
+	// Read the word until we get a consistent copy
+	std::uint64_t word = 0;
+	int errorValue = 0;
+	const std::error_category *errorCategory = nullptr;
+	for (;;)
+	{
+		const auto sequence = _sequence.load(std::memory_order_acquire);
+		if ((sequence & 1u) != 0)
+		{
+			continue;
+		}
+
+		word = _word.load(std::memory_order_relaxed);
+		errorValue = _errorValue.load(std::memory_order_relaxed);
+		errorCategory = _errorCategory.load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (_sequence.load(std::memory_order_relaxed) == sequence) [[likely]]
+		{
+			break;
+		}
+	}
+
+	if (errorValue != 0)
+	{
+		throw std::system_error(errorValue, *errorCategory);
+	}
+
+	// Extract the bit without branching
+	return ((word >> index) & 1u) != 0;
+}
+
+auto PackedWord::writeBit(unsigned index, bool value) -> void
+{
+	// Build the new bits without branching
+	const auto mask = std::uint64_t(1) << index;
+	const auto bits = std::uint64_t(0) - std::uint64_t(value);
+	modify(mask, bits & mask);
+}
+
+auto PackedWord::modify(std::uint64_t mask, std::uint64_t bits) -> void
+{
+	// Hold the lock across the whole read-modify-write, so that two writers don't both read the old word
+	std::scoped_lock lock { _writeMutex };
+	_ioComponent.get().modifyWord(_address, mask, bits);
+}
+
+} // namespace xentara::plugins::templateDriver
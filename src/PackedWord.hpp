@@ -0,0 +1,94 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include "CustomError.hpp"
+
+#include <xentara/utils/eh/expected.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <system_error>
+
+namespace xentara::plugins::templateDriver
+{
+
+class TemplateIoComponent;
+
+/// @brief A word on the I/O component whose bits are mapped to individual boolean inputs and outputs.
+///
+/// Devices often pack many boolean signals into a single register. Instead of reading the register once for every
+/// boolean data point, all the data points mapped to the same word share a single PackedWord object. The I/O component
+/// reads each word once per cycle using refresh(), and the data points then extract their bit from the cached word.
+///
+/// The word is read by the read task of the I/O component, by worker threads, and by the read tasks of the data points.
+/// The cached word is published using a sequence lock, so that extracting a bit never blocks. Changes to the word on the
+/// I/O component are read-modify-write operations, so they are serialized using a mutex.
+class PackedWord final
+{
+public:
+	/// @brief The number of bits in a word
+	static constexpr unsigned kBitCount = 64;
+
+	/// @brief Constructor
+	/// @param ioComponent The I/O component the word is read from
+	/// @param address The address of the word on the I/O component
+	PackedWord(std::reference_wrapper<TemplateIoComponent> ioComponent, std::uint64_t address);
+
+	/// @brief Returns the address of the word on the I/O component
+	auto address() const noexcept -> std::uint64_t
+	{
+		return _address;
+	}
+
+	/// @brief Reads the word from the I/O component, and caches it for use by bit().
+	///
+	/// If the word cannot be read, the error is cached instead.
+	auto refresh() noexcept -> void;
+
+	/// @brief Extracts a bit from the word cached by the last call to refresh()
+	/// @param index The index of the bit, where 0 is the least significant bit. Must be less than kBitCount.
+	/// @return The value of the bit
+	/// @throw std::system_error The last read of the word failed, or the word has not been read yet
+	auto bit(unsigned index) const -> bool;
+
+	/// @brief Changes a single bit of the word using a read-modify-write operation
+	/// @param index The index of the bit, where 0 is the least significant bit. Must be less than kBitCount.
+	/// @param value The new value of the bit
+	/// @throw std::system_error The word could not be read or written
+	auto writeBit(unsigned index, bool value) -> void;
+
+	/// @brief Changes some of the bits of the word using a single read-modify-write operation.
+	///
+	/// The whole operation is performed under a lock, so that concurrent changes to other bits of the same word are not lost.
+	/// @param mask The bits to change
+	/// @param bits The new values of the bits in *mask*. Bits not in *mask* are ignored.
+	/// @throw std::system_error The word could not be read or written
+	auto modify(std::uint64_t mask, std::uint64_t bits) -> void;
+
+private:
+	/// @brief The I/O component the word is read from
+	std::reference_wrapper<TemplateIoComponent> _ioComponent;
+	/// @brief The address of the word on the I/O component
+	std::uint64_t _address;
+
+	/// @brief Publishes the result of reading the word
+	auto publish(const utils::eh::expected<std::uint64_t, std::error_code> &word) noexcept -> void;
+
+	/// @brief The sequence number of the cached word. The number is odd while the word is being updated.
+	std::atomic<std::uint64_t> _sequence { 0 };
+	/// @brief The word read by the last call to refresh(), if it succeeded
+	std::atomic<std::uint64_t> _word { 0 };
+	/// @brief The value of the error that occurred reading the word, or 0 if the word was read successfully
+	std::atomic<int> _errorValue { 0 };
+	/// @brief The category of the error that occurred reading the word
+	std::atomic<const std::error_category *> _errorCategory { nullptr };
+
+	/// @brief A mutex serializing updates of the cached word
+	std::mutex _publishMutex;
+	/// @brief A mutex serializing read-modify-write operations on the word
+	std::mutex _writeMutex;
+};
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,54 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <cstdint>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief Decides on which executions of a task a data point is actually polled.
+///
+/// A divider of *N* makes the data point be polled on every *N*th execution only. The phase determines on which
+/// of the *N* executions this happens, which allows the polls of different data points to be spread evenly across
+/// the executions.
+class PollDivider final
+{
+public:
+	/// @brief The default constructor creates a divider that polls on every execution
+	PollDivider() noexcept = default;
+
+	/// @brief Constructor for a specific divider and phase
+	/// @param divider The divider. Must not be 0.
+	/// @param phase The number of executions to skip before the first poll.
+	PollDivider(std::uint32_t divider, std::uint32_t phase) noexcept :
+		_divider(divider), _countdown(phase % divider)
+	{
+	}
+
+	/// @brief Returns the divider
+	auto divider() const noexcept -> std::uint32_t
+	{
+		return _divider;
+	}
+
+	/// @brief Checks whether the data point must be polled on this execution, and advances to the next execution
+	auto due() noexcept -> bool
+	{
+		if (_countdown == 0)
+		{
+			_countdown = _divider - 1;
+			return true;
+		}
+
+		--_countdown;
+		return false;
+	}
+
+private:
+	/// @brief The divider
+	std::uint32_t _divider { 1 };
+	/// @brief The number of executions to skip until the next poll
+	std::uint32_t _countdown { 0 };
+};
+
+} // namespace xentara::plugins::templateDriver
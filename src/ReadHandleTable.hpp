@@ -0,0 +1,64 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <xentara/data/ReadHandle.hpp>
+#include <xentara/model/Attribute.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <type_traits>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief An entry in the table of readable attributes of a type.
+///
+/// Each type with readable attributes keeps a single static constexpr array of these entries, which is shared by all
+/// objects of the type. The array is searched using lookUpReadHandle().
+/// @tparam Owner The type the attributes belong to
+template <typename Owner>
+struct ReadHandleEntry final
+{
+	/// @brief The attribute
+	const model::Attribute *_attribute;
+	/// @brief The function that creates the read handle for the attribute from an object of the owning type
+	auto (*_accessor)(const Owner &owner) -> data::ReadHandle;
+};
+
+/// @brief Creates a read-handle for an attribute using a table of readable attributes.
+///
+/// The attribute is looked up by identity, because Xentara passes back the attributes reported by forEachAttribute().
+/// This also works for the custom attributes of the template, which all share the same placeholder UUID, and for
+/// attributes like "value" that are different objects for each data type, but have the same name.
+///
+/// The addresses of the attributes cannot be compared in a constant expression, so the table is sorted by address the
+/// first time it is used, and then searched using a binary search.
+/// @tparam kTable The table. This must be a static constexpr array of ReadHandleEntry<Owner> objects.
+/// @param owner The object the attributes belong to
+/// @param attribute The attribute to create the handle for
+/// @return A read handle for the attribute, or std::nullopt if the attribute is not in the table
+template <const auto &kTable, typename Owner>
+auto lookUpReadHandle(const Owner &owner, const model::Attribute &attribute) noexcept -> std::optional<data::ReadHandle>
+{
+	using Entry = typename std::remove_cvref_t<decltype(kTable)>::value_type;
+	static_assert(std::is_same_v<Entry, ReadHandleEntry<Owner>>, "the table does not belong to the owner");
+
+	// Sort the table once for all the objects of the type
+	static const auto kSorted = []
+	{
+		auto entries = kTable;
+		std::ranges::sort(entries, std::less {}, &Entry::_attribute);
+		return entries;
+	}();
+
+	const auto entry = std::ranges::lower_bound(kSorted, &attribute, std::less {}, &Entry::_attribute);
+	if (entry == kSorted.end() || entry->_attribute != &attribute)
+	{
+		return std::nullopt;
+	}
+
+	return entry->_accessor(owner);
+}
+
+} // namespace xentara::plugins::templateDriver
@@ -2,11 +2,15 @@
 #include "ReadState.hpp"
 
 #include "Attributes.hpp"
+#include "ReadHandleTable.hpp"
 
 #include <xentara/memory/memoryResources.hpp>
 #include <xentara/memory/WriteSentinel.hpp>
 #include <xentara/process/EventList.hpp>
 
+#include <array>
+#include <utility>
+
 namespace xentara::plugins::templateDriver
 {
 
@@ -24,33 +28,43 @@ auto ReadState<DataType>::forEachAttribute(const model::ForEachAttributeFunction
 template <std::regular DataType>
 auto ReadState<DataType>::forEachEvent(const model::ForEachEventFunction &function, std::shared_ptr<void> parent) -> bool
 {
+	// Create the event the first time it is needed
+	if (!_changedEvent)
+	{
+		_changedEvent = std::make_unique<process::Event>(io::Direction::Input);
+	}
+
 	// Handle all the events we support
 	return
-		function(process::Event::kChanged, std::shared_ptr<process::Event>(parent, &_changedEvent));
+		function(process::Event::kChanged, std::shared_ptr<process::Event>(parent, _changedEvent.get()));
 }
 
 template <std::regular DataType>
 auto ReadState<DataType>::makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>
 {
-	// Try each readable attribute
-	if (attribute == model::Attribute::kUpdateTime)
-	{
-		return _dataBlock.member(&State::_updateTime);
-	}
-	else if (attribute == model::Attribute::kChangeTime)
-	{
-		return _dataBlock.member(&State::_changeTime);
-	}
-	else if (attribute == model::Attribute::kQuality)
-	{
-		return _dataBlock.member(&State::_quality);
-	}
-	else if (attribute == attributes::kError)
+	// All the attributes we support
+	static constexpr std::array<ReadHandleEntry<ReadState>, 4> kReadHandles { {
+		{ &model::Attribute::kUpdateTime, [](const ReadState &self) { return self.metadataReadHandle(&Metadata::_updateTime); } },
+		{ &model::Attribute::kChangeTime, [](const ReadState &self) { return self.metadataReadHandle(&Metadata::_changeTime); } },
+		{ &model::Attribute::kQuality, [](const ReadState &self) { return data::ReadHandle(self._dataBlock.member(&State::_quality)); } },
+		{ &attributes::kError, [](const ReadState &self) { return self.metadataReadHandle(&Metadata::_error); } }
+	} };
+
+	return lookUpReadHandle<kReadHandles>(*this, attribute);
+}
+
+template <std::regular DataType>
+template <typename Member>
+auto ReadState<DataType>::metadataReadHandle(Member Metadata::*member) const noexcept -> data::ReadHandle
+{
+	// If the state has already been realized without the metadata, there is no storage to read from
+	if (_realized && !_metadataUsed) [[unlikely]]
 	{
-		return _dataBlock.member(&State::_error);
+		return std::make_error_code(std::errc::operation_not_supported);
 	}
 
-	return std::nullopt;
+	_metadataUsed = true;
+	return _metadataBlock.member(member);
 }
 
 template <std::regular DataType>
@@ -62,56 +76,148 @@ auto ReadState<DataType>::valueReadHandle() const noexcept -> data::ReadHandle
 template <std::regular DataType>
 auto ReadState<DataType>::realize() -> void
 {
-	// Create the data block
+	// Create the data blocks. The metadata is only needed if someone has asked for it.
 	_dataBlock.create(memory::memoryResources::data());
+	if (_metadataUsed)
+	{
+		_metadataBlock.create(memory::memoryResources::data());
+	}
+	_realized = true;
+}
+
+template <std::regular DataType>
+auto ReadState<DataType>::addFootprint(MemoryFootprint &footprint) const noexcept -> void
+{
+	footprint._dataBlock += sizeof(State);
+	if (_metadataUsed)
+	{
+		footprint._dataBlock += sizeof(Metadata);
+	}
+	if (_changedEvent)
+	{
+		footprint._events += sizeof(process::Event);
+	}
 }
 
 template <std::regular DataType>
 auto ReadState<DataType>::update(std::chrono::system_clock::time_point timeStamp, const utils::eh::expected<DataType, std::error_code> &valueOrError) -> void
+{
+	doUpdate(timeStamp, valueOrError);
+}
+
+template <std::regular DataType>
+auto ReadState<DataType>::update(std::chrono::system_clock::time_point timeStamp, utils::eh::expected<DataType, std::error_code> &&valueOrError) -> void
+{
+	doUpdate(timeStamp, std::move(valueOrError));
+}
+
+template <std::regular DataType>
+template <typename ValueOrError>
+auto ReadState<DataType>::doUpdate(std::chrono::system_clock::time_point timeStamp, ValueOrError &&valueOrError) -> void
 {
 	// Make a write sentinel
 	memory::WriteSentinel sentinel { _dataBlock };
 	auto &state = *sentinel;
-	const auto &oldState = sentinel.oldValue();
-
-	state._updateTime = timeStamp;
 
 	// See if we have a value
 	if (valueOrError)
 	{
 		// Set the value
-		state._value = *valueOrError;
+		assignValue(state._value, *std::forward<ValueOrError>(valueOrError));
 
-		// Reset the error
+		// Reset the error, and commit the data
 		state._quality = data::Quality::Good;
-		state._error = {};
+		commitChanges(sentinel, timeStamp, {});
 	}
 	// We don't have a value, but an error
 	else
 	{
-		// Reset the value to a default constructed value
-		state._value = {};
-
-		// Set the error
+		// Reset the value to a default constructed value. Strings are cleared instead, so that they keep their memory
+		// for the next value.
+		if constexpr (std::same_as<StoredType, std::string>)
+		{
+			state._value.clear();
+		}
+		else
+		{
+			state._value = {};
+		}
+
+		// Set the error, and commit the data
 		state._quality = data::Quality::Bad;
-		state._error = valueOrError.error();
+		commitChanges(sentinel, timeStamp, valueOrError.error());
+	}
+}
+
+template <std::regular DataType>
+auto ReadState<DataType>::updateUnconfirmed(std::chrono::system_clock::time_point timeStamp,
+	const DataType &value,
+	data::Quality quality,
+	std::error_code reason) -> void
+{
+	// Make a write sentinel
+	memory::WriteSentinel sentinel { _dataBlock };
+	auto &state = *sentinel;
+
+	// Set the value, with the given quality and reason
+	assignValue(state._value, value);
+	state._quality = quality;
+
+	// Commit the data
+	commitChanges(sentinel, timeStamp, reason);
+}
+
+template <std::regular DataType>
+template <typename Value>
+auto ReadState<DataType>::assignValue(StoredType &target, Value &&value) -> void
+{
+	// Fixed capacity strings are copied into the existing string, which reuses its memory.
+	if constexpr (FixedStringType<DataType>)
+	{
+		target.assign(value.view());
+	}
+	else
+	{
+		target = std::forward<Value>(value);
 	}
+}
+
+template <std::regular DataType>
+auto ReadState<DataType>::commitChanges(memory::WriteSentinel<State> &sentinel, std::chrono::system_clock::time_point timeStamp, std::error_code error) -> void
+{
+	auto &state = *sentinel;
+	const auto &oldState = sentinel.oldValue();
 
 	// Detect changes
 	const auto valueChanged = state._value != oldState._value;
 	const auto qualityChanged = state._quality != oldState._quality;
-	const auto errorChanged = state._error != oldState._error;
-	const auto changed = valueChanged || qualityChanged || errorChanged;
+	auto changed = valueChanged || qualityChanged;
+
+	// Update the metadata, if anyone uses it. Changes to the error alone can only be detected if the metadata exists,
+	// but without the metadata, nobody can see the error anyway.
+	if (_metadataUsed)
+	{
+		memory::WriteSentinel metadataSentinel { _metadataBlock };
+		auto &metadata = *metadataSentinel;
+		const auto &oldMetadata = metadataSentinel.oldValue();
+
+		changed = changed || error != oldMetadata._error;
 
-	// Update the change time, if necessary. We always need to write the change time, even if it is the same as before,
-	// because memory resources use swap-in.
-	state._changeTime = changed ? timeStamp : oldState._changeTime;
+		// We always need to write all the members, even if they are the same as before, because memory resources use
+		// swap-in.
+		metadata._updateTime = timeStamp;
+		metadata._changeTime = changed ? timeStamp : oldMetadata._changeTime;
+		metadata._error = error;
+
+		// Commit the metadata first, so that it is up to date when the change event is raised
+		metadataSentinel.commit();
+	}
 
 	// Collect the events to raise
 	process::StaticEventList<1> events;
-	if (changed)
+	if (changed && _changedEvent)
 	{
-		events.push_back(_changedEvent);
+		events.push_back(*_changedEvent);
 	}
 
 	// Commit the data and raise the events
@@ -132,5 +238,6 @@ template class ReadState<std::int64_t>;
 template class ReadState<float>;
 template class ReadState<double>;
 template class ReadState<std::string>;
+template class ReadState<InlineString>;
 
 } // namespace xentara::plugins::templateDriver
\ No newline at end of file
@@ -3,10 +3,14 @@
 
 #include "Attributes.hpp"
 #include "CustomError.hpp"
+#include "FixedString.hpp"
+#include "MemoryFootprint.hpp"
 
 #include <xentara/data/Quality.hpp>
 #include <xentara/data/ReadHandle.hpp>
 #include <xentara/memory/ObjectBlock.hpp>
+#include <xentara/memory/WriteSentinel.hpp>
+#include <xentara/model/Attribute.hpp>
 #include <xentara/model/ForEachAttributeFunction.hpp>
 #include <xentara/model/ForEachEventFunction.hpp>
 #include <xentara/process/Event.hpp>
@@ -16,6 +20,8 @@
 #include <concepts>
 #include <optional>
 #include <memory>
+#include <string>
+#include <type_traits>
 
 namespace xentara::plugins::templateDriver
 {
@@ -43,6 +49,9 @@ public:
 	auto forEachEvent(const model::ForEachEventFunction &function, std::shared_ptr<void> parent) -> bool;
 
 	/// @brief Creates a read-handle for an attribute that belong to this state.
+	///
+	/// The storage for the update time, the change time and the error is only allocated if a handle for one of them was
+	/// created before the state was realized. Handles for them that are created later read as errors.
 	/// @note The value attribute is not handled, it must be gotten separately using valueReadHandle().
 	/// @param attribute The attribute to create the handle for
 	/// @return A read handle for the attribute, or std::nullopt if the attribute is unknown (including the value attribute)
@@ -55,33 +64,97 @@ public:
 	/// @brief Realizes the state
 	auto realize() -> void;
 
+	/// @brief Adds the memory used by the data block and the events to a footprint
+	/// @note The memory used by the state object itself is part of the object containing it.
+	auto addFootprint(MemoryFootprint &footprint) const noexcept -> void;
+
 	/// @brief Updates the data and sends events
 	/// @param timeStamp The update time stamp
 	/// @param valueOrError This is a variant-like type that will hold either the new value, or an std::error_code object
 	/// containing an read error
 	auto update(std::chrono::system_clock::time_point timeStamp, const utils::eh::expected<DataType, std::error_code> &valueOrError) -> void;
 
+	/// @brief Updates the data and sends events, moving the value into the state
+	/// @param timeStamp The update time stamp
+	/// @param valueOrError This is a variant-like type that will hold either the new value, or an std::error_code object
+	/// containing an read error
+	auto update(std::chrono::system_clock::time_point timeStamp, utils::eh::expected<DataType, std::error_code> &&valueOrError) -> void;
+
+	/// @brief Updates the data with a value that was not read from the I/O component, and sends events
+	///
+	/// This is used for values that are known without reading them, like values restored from a snapshot, or values that
+	/// were just written. The value keeps the given quality and reason until the next call to update().
+	/// @param timeStamp The update time stamp
+	/// @param value The value
+	/// @param quality The quality to give the value
+	/// @param reason The error code describing why the value is not confirmed
+	auto updateUnconfirmed(std::chrono::system_clock::time_point timeStamp,
+		const DataType &value,
+		data::Quality quality,
+		std::error_code reason) -> void;
+
 private:
+	/// @brief The type used to store the value inside the memory block.
+	///
+	/// Fixed capacity strings are stored as std::string, which keeps the characters on the heap. Xentara can only read
+	/// string attributes from an std::string, and a read handle cannot convert the value when it is read, so the
+	/// characters cannot stay inline in the memory block.
+	using StoredType = std::conditional_t<FixedStringType<DataType>, std::string, DataType>;
+
 	/// @brief This structure is used to represent the state inside the memory block
 	struct State final
+	{
+		/// @brief The current value
+		StoredType _value {};
+		/// @brief The quality of the value
+		data::Quality _quality { data::Quality::Bad };
+	};
+
+	/// @brief This structure is used to represent the metadata inside its own memory block.
+	///
+	/// The metadata is kept separately from the value, so that it need not be allocated or updated if nobody uses it.
+	struct Metadata final
 	{
 		/// @brief The update time stamp
 		std::chrono::system_clock::time_point _updateTime { std::chrono::system_clock::time_point::min() };
-		/// @brief The current value
-		DataType _value {};
 		/// @brief The change time stamp
 		std::chrono::system_clock::time_point _changeTime { std::chrono::system_clock::time_point::min() };
-		/// @brief The quality of the value
-		data::Quality _quality { data::Quality::Bad };
 		/// @brief The error code when reading the value, or a default constructed std::error_code object for none.
 		std::error_code _error { CustomError::NoData };
 	};
 
-	/// @brief A summary event that is raised when anything changes
-	process::Event _changedEvent { io::Direction::Input };
+	/// @brief Common implementation of the update() overloads
+	template <typename ValueOrError>
+	auto doUpdate(std::chrono::system_clock::time_point timeStamp, ValueOrError &&valueOrError) -> void;
+
+	/// @brief Assigns a value to the value stored in the memory block
+	template <typename Value>
+	static auto assignValue(StoredType &target, Value &&value) -> void;
+
+	/// @brief Creates a read handle for a member of the metadata, and marks the metadata as used
+	template <typename Member>
+	auto metadataReadHandle(Member Metadata::*member) const noexcept -> data::ReadHandle;
+
+	/// @brief Updates the metadata, if used, and commits the data, raising the change event if anything changed
+	auto commitChanges(memory::WriteSentinel<State> &sentinel, std::chrono::system_clock::time_point timeStamp, std::error_code error) -> void;
+
+	/// @brief A summary event that is raised when anything changes, or nullptr if nobody has asked for the event.
+	///
+	/// The event is created the first time forEachEvent() is called, so that data points whose events are never used
+	/// don't pay for them.
+	std::unique_ptr<process::Event> _changedEvent;
 
 	/// @brief The data block that contains the state
 	memory::ObjectBlock<State> _dataBlock;
+	/// @brief The data block that contains the metadata. This is only created if _metadataUsed is set.
+	memory::ObjectBlock<Metadata> _metadataBlock;
+
+	/// @brief Whether a read handle was created for any of the metadata
+	///
+	/// This is mutable, because it is set by makeReadHandle(), which is const.
+	mutable bool _metadataUsed { false };
+	/// @brief Whether the state has been realized
+	bool _realized { false };
 };
 
 /// @class xentara::plugins::templateDriver::ReadState
@@ -98,5 +171,6 @@ extern template class ReadState<std::int64_t>;
 extern template class ReadState<float>;
 extern template class ReadState<double>;
 extern template class ReadState<std::string>;
+extern template class ReadState<InlineString>;
 
 } // namespace xentara::plugins::templateDriver
\ No newline at end of file
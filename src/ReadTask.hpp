@@ -1,9 +1,13 @@
 // Copyright (c) embedded ocean GmbH
 #pragma once
 
+#include "PollDivider.hpp"
+#include "RuntimeCounters.hpp"
+
 #include <xentara/process/Task.hpp>
 #include <xentara/process/ExecutionContext.hpp>
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 
@@ -20,6 +24,64 @@ public:
 	{
 	}
 
+	/// @brief Sets the divider that determines on which executions the target is polled
+	auto setPollDivider(const PollDivider &pollDivider) noexcept -> void
+	{
+		_pollDivider = pollDivider;
+	}
+
+	/// @brief Sets the counters that count the executions on which the target was not polled
+	auto setRuntimeCounters(RuntimeCounters &counters) noexcept -> void
+	{
+		_counters = &counters;
+	}
+
+	/// @brief Enables or disables periodic polling.
+	///
+	/// If periodic polling is disabled, the target is only read initially, and when requested using requestRead().
+	auto setPeriodicPolling(bool enabled) noexcept -> void
+	{
+		_periodicPolling = enabled;
+	}
+
+	/// @brief Hands the periodic reads of the target to another task.
+	///
+	/// If the reads are delegated, this task only performs the initial read, and invalidates the data when it stops.
+	/// The task that reads the target instead must use pollDue() to decide when to read it.
+	auto setDelegated(bool delegated) noexcept -> void
+	{
+		_delegated = delegated;
+	}
+
+	/// @brief Requests that the target be read on the next execution, regardless of the poll divider.
+	/// @note This function may be called from any thread.
+	auto requestRead() noexcept -> void
+	{
+		_readRequested.store(true, std::memory_order_relaxed);
+	}
+
+	/// @brief Checks whether the target must be polled on this execution, and advances the poll divider
+	auto pollDue() noexcept -> bool
+	{
+		// Always advance the poll divider, so that the phase stays the same
+		const auto due = _pollDivider.due() && _periodicPolling;
+
+		// Check for a requested read. The flag is only exchanged if it is set, so that the common case is a plain load.
+		const auto requested =
+			_readRequested.load(std::memory_order_relaxed) && _readRequested.exchange(false, std::memory_order_relaxed);
+
+		if (!due && !requested)
+		{
+			if (_counters)
+			{
+				_counters->increment(RuntimeCounters::Counter::SkippedCycles);
+			}
+			return false;
+		}
+
+		return true;
+	}
+
 	/// @name Virtual Overrides for process::Task
 	/// @{
 
@@ -45,17 +107,29 @@ public:
 private:
 	/// @brief A reference to the target element
 	std::reference_wrapper<Target> _target;
+
+	/// @brief The divider that determines on which executions the target is polled
+	PollDivider _pollDivider;
+	/// @brief Whether the target is polled periodically
+	bool _periodicPolling { true };
+	/// @brief Whether the periodic reads of the target are performed by another task
+	bool _delegated { false };
+	/// @brief Whether a read was requested using requestRead()
+	std::atomic<bool> _readRequested { false };
+	/// @brief The counters that count the executions on which the target was not polled, or nullptr for none
+	RuntimeCounters *_counters { nullptr };
 };
 
 template <typename Target>
 auto ReadTask<Target>::preparePreOperational(const process::ExecutionContext &context) -> Status
 {
-	// Read the value once to initialize it
-	operational(context);
-
-	// We are done now. Even if we couldn't read the value, we proceed to the next stage,
-	// because attempting again is unlikely to succeed any better.
-	return Status::Ready;
+	// Read the value once to initialize it. The initial read bypasses the poll divider, because it must always be performed.
+	// The initial reads of an I/O component and all its data points are performed together as a batch, so the target tells us
+	// whether the batch has completed yet.
+	//
+	// Even if we couldn't read the value, the target reports ready once the batch is complete, because attempting
+	// again is unlikely to succeed any better.
+	return _target.get().performInitialRead(context);
 }
 
 template <typename Target>
@@ -70,6 +144,19 @@ auto ReadTask<Target>::preOperational(const process::ExecutionContext &context)
 template <typename Target>
 auto ReadTask<Target>::operational(const process::ExecutionContext &context) -> void
 {
+	// Leave the target alone if another task reads it
+	if (_delegated)
+	{
+		return;
+	}
+
+	// Skip the executions on which the target is not due. The value and its update time stamp simply remain unchanged
+	// until the next read.
+	if (!pollDue())
+	{
+		return;
+	}
+
 	_target.get().performReadTask(context);
 }
 
@@ -0,0 +1,324 @@
+// Copyright (c) embedded ocean GmbH
+#include "Replayer.hpp"
+
+#include "FrameCodec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cerrno>
+#include <charconv>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace xentara::plugins::templateDriver
+{
+
+using namespace std::literals;
+
+namespace
+{
+
+	/// @brief The signature at the start of a binary replay file
+	constexpr auto kSignature = "XTDRPLY1"sv;
+	/// @brief The layout of a record in a binary replay file: the time, the point and the value
+	using RecordCodec = FrameCodec<
+		FrameField<std::uint64_t, 0, std::endian::little>,
+		FrameField<std::uint32_t, 8, std::endian::little>,
+		FrameField<double, 12, std::endian::little>>;
+	static_assert(RecordCodec::kSize == 20);
+
+	/// @brief Parses a number in a CSV field
+	/// @return Whether the whole field was a valid number
+	template <typename Number>
+	auto parseField(std::string_view field, Number &number) noexcept -> bool
+	{
+		// Ignore surrounding white space
+		const auto first = field.find_first_not_of(" \t");
+		const auto last = field.find_last_not_of(" \t");
+		if (first == std::string_view::npos)
+		{
+			return false;
+		}
+		field = field.substr(first, last - first + 1);
+
+		const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), number);
+		return error == std::errc() && end == field.data() + field.size();
+	}
+
+} // namespace
+
+auto Replayer::open(std::size_t pointCount) -> void
+{
+	close();
+
+	_file.open(_path, std::ios::in | std::ios::binary);
+	if (!_file)
+	{
+		throw std::system_error(errno, std::generic_category(), "could not open replay file");
+	}
+
+	// Check the signature of binary files
+	_csv = _path.extension() == ".csv";
+	if (!_csv)
+	{
+		char signature[kSignature.size()];
+		if (!_file.read(signature, sizeof(signature)) || std::string_view(signature, sizeof(signature)) != kSignature)
+		{
+			throw std::runtime_error("replay file has an invalid signature");
+		}
+	}
+	_lineNumber = 0;
+
+	// Start out without values
+	_points = std::make_unique<Point[]>(pointCount);
+	_pointCount = pointCount;
+
+	// Read the first record, which defines the start time
+	Record record;
+	if (!readRecord(record))
+	{
+		throw std::runtime_error("replay file does not contain any values");
+	}
+	_firstTime = record._time;
+	_lastTime = record._time;
+	_loopOffset = {};
+	_nextRecord = record;
+
+	// Replay the values of the first time stamp right away, so that the initial read has values
+	_startTime = std::chrono::steady_clock::now();
+	replayUntil(_firstTime);
+	scheduleNextRecord();
+}
+
+auto Replayer::close() -> void
+{
+	_file.close();
+	_nextRecord.reset();
+	_nextDue.store(std::numeric_limits<std::chrono::steady_clock::rep>::max(), std::memory_order_relaxed);
+}
+
+auto Replayer::advance() noexcept -> void
+{
+	std::scoped_lock lock { _mutex };
+
+	if (!_nextRecord)
+	{
+		return;
+	}
+
+	try
+	{
+		// When replaying as fast as possible, replay the next time stamp
+		if (_speed == 0)
+		{
+			replayUntil(_nextRecord->_time);
+		}
+		// Otherwise, replay everything that is due
+		else
+		{
+			const auto elapsed = std::chrono::steady_clock::now() - _startTime;
+			replayUntil(_firstTime + std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed * _speed));
+		}
+	}
+	catch (const std::exception &)
+	{
+		// Treat an invalid record like the end of the file
+		_nextRecord.reset();
+	}
+
+	scheduleNextRecord();
+}
+
+auto Replayer::poll() noexcept -> void
+{
+	// Only real time replays are advanced by reads
+	if (_speed == 0)
+	{
+		return;
+	}
+
+	// Check if anything is due without locking
+	const auto now = std::chrono::steady_clock::now();
+	if (now.time_since_epoch().count() < _nextDue.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	// Let whichever thread got here first do the work
+	std::unique_lock lock { _mutex, std::try_to_lock };
+	if (!lock || !_nextRecord)
+	{
+		return;
+	}
+
+	try
+	{
+		replayUntil(_firstTime + std::chrono::duration_cast<std::chrono::nanoseconds>((now - _startTime) * _speed));
+	}
+	catch (const std::exception &)
+	{
+		// Treat an invalid record like the end of the file
+		_nextRecord.reset();
+	}
+	scheduleNextRecord();
+}
+
+auto Replayer::value(std::size_t point) const noexcept -> std::optional<double>
+{
+	if (point >= _pointCount)
+	{
+		return std::nullopt;
+	}
+
+	// The flag is set after the first value was stored, so acquire it to see the value
+	if (!_points[point]._replayed.load(std::memory_order_acquire))
+	{
+		return std::nullopt;
+	}
+	return _points[point]._value.load(std::memory_order_relaxed);
+}
+
+auto Replayer::replayUntil(std::chrono::nanoseconds time) -> void
+{
+	while (_nextRecord && _nextRecord->_time <= time)
+	{
+		// Ignore values for points nobody is interested in
+		if (_nextRecord->_point < _pointCount)
+		{
+			auto &point = _points[_nextRecord->_point];
+			point._value.store(_nextRecord->_value, std::memory_order_relaxed);
+			point._replayed.store(true, std::memory_order_release);
+		}
+
+		readNextRecord();
+	}
+}
+
+auto Replayer::scheduleNextRecord() noexcept -> void
+{
+	// When replaying as fast as possible, the records are replayed by advance() regardless of their time, and poll()
+	// never looks at _nextDue
+	if (!_nextRecord || _speed == 0)
+	{
+		_nextDue.store(std::numeric_limits<std::chrono::steady_clock::rep>::max(), std::memory_order_relaxed);
+		return;
+	}
+
+	const auto delay = std::chrono::duration_cast<std::chrono::steady_clock::duration>((_nextRecord->_time - _firstTime) / _speed);
+	_nextDue.store((_startTime + delay).time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+auto Replayer::readNextRecord() -> bool
+{
+	Record record;
+	auto found = readRecord(record);
+
+	// Start over at the end of the file, if requested. The first record of the next round follows right after the
+	// last record, so the replay continues seamlessly.
+	if (!found && _loop)
+	{
+		_loopOffset = _lastTime + 1ns - _firstTime;
+		rewind();
+		found = readRecord(record);
+	}
+
+	if (!found)
+	{
+		_nextRecord.reset();
+		return false;
+	}
+
+	// Make sure the time never goes backwards
+	record._time = std::max(record._time + _loopOffset, _lastTime);
+	_lastTime = record._time;
+	_nextRecord = record;
+	return true;
+}
+
+auto Replayer::readRecord(Record &record) -> bool
+{
+	return _csv ? readCsvRecord(record) : readBinaryRecord(record);
+}
+
+auto Replayer::readBinaryRecord(Record &record) -> bool
+{
+	std::array<std::byte, RecordCodec::kSize> data;
+	_file.read(reinterpret_cast<char *>(data.data()), data.size());
+	if (_file.gcount() == 0)
+	{
+		return false;
+	}
+	if (std::size_t(_file.gcount()) != data.size())
+	{
+		throw std::runtime_error("replay file is truncated");
+	}
+
+	// Decode the record straight from the read buffer
+	const auto [time, point, value] = RecordCodec::decode(data);
+	record._time = std::chrono::nanoseconds(time);
+	record._point = point;
+	record._value = value;
+	return true;
+}
+
+auto Replayer::readCsvRecord(Record &record) -> bool
+{
+	std::string line;
+	while (std::getline(_file, line))
+	{
+		++_lineNumber;
+
+		// Skip empty lines and comments
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+		if (line.empty() || line.front() == '#')
+		{
+			continue;
+		}
+
+		// Split the line into its three fields
+		const std::string_view view(line);
+		const auto firstComma = view.find(',');
+		const auto secondComma = firstComma == std::string_view::npos ? firstComma : view.find(',', firstComma + 1);
+		double seconds = 0;
+		std::uint32_t point = 0;
+		double value = 0;
+		if (secondComma == std::string_view::npos ||
+			!parseField(view.substr(0, firstComma), seconds) ||
+			!parseField(view.substr(firstComma + 1, secondComma - firstComma - 1), point) ||
+			!parseField(view.substr(secondComma + 1), value) ||
+			!(seconds >= 0))
+		{
+			// Skip a header line at the start of the file
+			if (_lineNumber == 1)
+			{
+				continue;
+			}
+			throw std::runtime_error("invalid record in line " + std::to_string(_lineNumber) + " of replay file");
+		}
+
+		record._time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(seconds));
+		record._point = point;
+		record._value = value;
+		return true;
+	}
+
+	return false;
+}
+
+auto Replayer::rewind() -> void
+{
+	_file.clear();
+	_file.seekg(_csv ? 0 : std::streamoff(kSignature.size()));
+	_lineNumber = 0;
+}
+
+} // namespace xentara::plugins::templateDriver
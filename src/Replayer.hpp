@@ -0,0 +1,183 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief Replays recorded values instead of reading them from the I/O device.
+///
+/// The replay file contains time stamped values for numbered points. Each input is mapped to a point, and reads the most
+/// recent value replayed for that point. The file is streamed, so it can be much larger than the available memory.
+///
+/// Two file formats are supported:
+///
+/// - A binary format, consisting of the 8 byte signature "XTDRPLY1", followed by records of 20 bytes each: the time in
+///   nanoseconds as a 64 bit unsigned integer, the point as a 32 bit unsigned integer, and the value as a 64 bit IEEE 754
+///   double, all in little endian byte order.
+/// - A CSV format, used if the file name ends in ".csv". Each line contains the time in seconds, the point and the value,
+///   separated by commas. Empty lines, lines starting with "#", and a header line are ignored.
+///
+/// The times must not decrease. Only differences between the times matter, so they can be relative to any epoch.
+/// An invalid record after the first one ends the replay, as if the end of the file had been reached.
+///
+/// The values are replayed either in real time, optionally sped up, or as fast as possible. When replaying as fast as
+/// possible, each cycle of the I/O component replays the values of the next time stamp in the file, so that every cycle
+/// sees a new set of values regardless of how long it takes.
+class Replayer final
+{
+public:
+	/// @brief Enables or disables the replay
+	auto setEnabled(bool enabled) noexcept -> void
+	{
+		_enabled = enabled;
+	}
+
+	/// @brief Checks whether the replay is enabled
+	auto enabled() const noexcept -> bool
+	{
+		return _enabled;
+	}
+
+	/// @brief Sets the path of the replay file
+	auto setPath(std::filesystem::path path) -> void
+	{
+		_path = std::move(path);
+	}
+
+	/// @brief Returns the path of the replay file
+	auto path() const noexcept -> const std::filesystem::path &
+	{
+		return _path;
+	}
+
+	/// @brief Sets the speed of the replay
+	/// @param speed The factor by which the replay is sped up, or 0 to replay as fast as possible
+	auto setSpeed(double speed) noexcept -> void
+	{
+		_speed = speed;
+	}
+
+	/// @brief Sets whether to start over once the end of the file has been reached
+	auto setLoop(bool loop) noexcept -> void
+	{
+		_loop = loop;
+	}
+
+	/// @brief Opens the replay file, and replays the values of the first time stamp
+	/// @param pointCount The number of points. Values for points outside the range are ignored.
+	/// @throw std::runtime_error The file could not be opened, or is invalid
+	auto open(std::size_t pointCount) -> void;
+
+	/// @brief Closes the replay file
+	auto close() -> void;
+
+	/// @brief Replays the values that are due.
+	///
+	/// This function is called once per cycle of the I/O component. When replaying as fast as possible, it replays the
+	/// values of the next time stamp.
+	auto advance() noexcept -> void;
+
+	/// @brief Replays the values that are due in real time, if another thread is not doing so already.
+	///
+	/// This function is called before each read, so that data points that are read by their own tasks see current
+	/// values. It does nothing when replaying as fast as possible.
+	auto poll() noexcept -> void;
+
+	/// @brief Returns the current value of a point
+	/// @return The value, or std::nullopt if no value has been replayed for the point yet
+	auto value(std::size_t point) const noexcept -> std::optional<double>;
+
+private:
+	/// @brief A record in the replay file
+	struct Record final
+	{
+		/// @brief The time, relative to the epoch used in the file
+		std::chrono::nanoseconds _time;
+		/// @brief The point
+		std::uint32_t _point;
+		/// @brief The value
+		double _value;
+	};
+
+	/// @brief Reads the next record into _nextRecord, starting over at the end of the file if looping is enabled
+	/// @return Whether there was another record
+	auto readNextRecord() -> bool;
+	/// @brief Reads a record from the file
+	/// @return Whether there was another record
+	auto readRecord(Record &record) -> bool;
+	/// @brief Reads a record from a binary file
+	auto readBinaryRecord(Record &record) -> bool;
+	/// @brief Reads a record from a CSV file
+	auto readCsvRecord(Record &record) -> bool;
+	/// @brief Positions the file at the first record
+	auto rewind() -> void;
+
+	/// @brief Replays all the records up to a certain time
+	/// @param time The time, relative to the start of the replay
+	auto replayUntil(std::chrono::nanoseconds time) -> void;
+
+	/// @brief Calculates the time at which _nextRecord becomes due, and stores it in _nextDue
+	auto scheduleNextRecord() noexcept -> void;
+
+	/// @brief The current value of a point
+	struct Point final
+	{
+		/// @brief The value
+		std::atomic<double> _value { 0 };
+		/// @brief Whether a value has been replayed yet. This is a separate flag, because the file may contain any
+		/// value, including NaN.
+		std::atomic<bool> _replayed { false };
+	};
+
+	/// @brief Whether the replay is enabled
+	bool _enabled { false };
+	/// @brief The path of the replay file
+	std::filesystem::path _path;
+	/// @brief The factor by which the replay is sped up, or 0 to replay as fast as possible
+	double _speed { 1.0 };
+	/// @brief Whether to start over at the end of the file
+	bool _loop { false };
+
+	/// @brief The file
+	std::ifstream _file;
+	/// @brief Whether the file is a CSV file
+	bool _csv { false };
+	/// @brief The number of the line last read from a CSV file
+	std::size_t _lineNumber { 0 };
+
+	/// @brief The next record to replay, or std::nullopt if the end of the file has been reached
+	std::optional<Record> _nextRecord;
+	/// @brief The time of the first record in the file
+	std::chrono::nanoseconds _firstTime {};
+	/// @brief The offset added to the times in the file, which grows each time the replay starts over
+	std::chrono::nanoseconds _loopOffset {};
+	/// @brief The time of the last record that was read, including the loop offset
+	std::chrono::nanoseconds _lastTime {};
+	/// @brief The steady clock time at which the replay was started
+	std::chrono::steady_clock::time_point _startTime;
+
+	/// @brief The steady clock time at which the next record becomes due, as a tick count
+	///
+	/// This is used by poll() to check whether there is anything to replay without locking.
+	std::atomic<std::chrono::steady_clock::rep> _nextDue { 0 };
+	/// @brief A mutex that serializes replaying
+	std::mutex _mutex;
+
+	/// @brief The current values of the points
+	std::unique_ptr<Point[]> _points;
+	/// @brief The number of points
+	std::size_t _pointCount { 0 };
+};
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,57 @@
+// Copyright (c) embedded ocean GmbH
+#include "RuntimeCounters.hpp"
+
+#include "Attributes.hpp"
+#include "ReadHandleTable.hpp"
+
+#include <array>
+#include <functional>
+
+namespace xentara::plugins::templateDriver
+{
+
+namespace
+{
+
+	/// @brief The attributes of the counters, indexed by RuntimeCounters::Counter
+	const std::array<std::reference_wrapper<const model::Attribute>, RuntimeCounters::kCounterCount> kCounterAttributes {
+		attributes::kReadCount,
+		attributes::kReadErrorCount,
+		attributes::kWriteCount,
+		attributes::kWriteErrorCount,
+		attributes::kOverwrittenValueCount,
+		attributes::kSkippedCycleCount
+	};
+
+} // namespace
+
+auto RuntimeCounters::forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool
+{
+	// Handle all the attributes we support
+	for (auto &&attribute : kCounterAttributes)
+	{
+		if (function(attribute))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+auto RuntimeCounters::makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>
+{
+	// All the attributes we support
+	static constexpr std::array<ReadHandleEntry<RuntimeCounters>, kCounterCount> kReadHandles { {
+		{ &attributes::kReadCount, &counterReadHandle<Counter::Reads> },
+		{ &attributes::kReadErrorCount, &counterReadHandle<Counter::ReadErrors> },
+		{ &attributes::kWriteCount, &counterReadHandle<Counter::Writes> },
+		{ &attributes::kWriteErrorCount, &counterReadHandle<Counter::WriteErrors> },
+		{ &attributes::kOverwrittenValueCount, &counterReadHandle<Counter::OverwrittenValues> },
+		{ &attributes::kSkippedCycleCount, &counterReadHandle<Counter::SkippedCycles> }
+	} };
+
+	return lookUpReadHandle<kReadHandles>(*this, attribute);
+}
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,117 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include "CacheLine.hpp"
+
+#include <xentara/data/ReadHandle.hpp>
+#include <xentara/model/Attribute.hpp>
+#include <xentara/model/ForEachAttributeFunction.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief Counters for the operations performed by a data point or I/O component.
+///
+/// The counters are incremented using relaxed atomic operations, so that they can be updated from any thread without
+/// locking. The counters of an object share a single cache line, which no other object uses, so that threads updating
+/// the counters of different data points do not contend.
+///
+/// The totals of an I/O component are not updated on each increment. Instead, the I/O component adds up the counters of
+/// its data points using values() and store() once per cycle.
+class alignas(kCacheLineSize) RuntimeCounters final
+{
+public:
+	/// @brief The counters
+	enum class Counter : std::size_t
+	{
+		/// @brief The number of values read from the I/O component, including failed reads
+		Reads,
+		/// @brief The number of reads that failed
+		ReadErrors,
+		/// @brief The number of values written to the I/O component, including failed writes
+		Writes,
+		/// @brief The number of writes that failed
+		WriteErrors,
+		/// @brief The number of pending output values that were replaced by a newer value before they were written
+		OverwrittenValues,
+		/// @brief The number of executions of the "read" task on which a data point was not read, because it was not due
+		SkippedCycles
+	};
+
+	/// @brief The number of counters
+	static constexpr std::size_t kCounterCount = std::size_t(Counter::SkippedCycles) + 1;
+
+	/// @brief The values of all the counters, indexed by Counter
+	using Values = std::array<std::uint64_t, kCounterCount>;
+
+	/// @brief Increments a counter
+	auto increment(Counter counter) noexcept -> void
+	{
+		_counters[std::size_t(counter)].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/// @brief Returns the current values of all the counters
+	auto values() const noexcept -> Values
+	{
+		Values values;
+		for (std::size_t index = 0; index < kCounterCount; ++index)
+		{
+			values[index] = _counters[index].load(std::memory_order_relaxed);
+		}
+		return values;
+	}
+
+	/// @brief Adds the current values of all the counters to a set of totals
+	auto addTo(Values &totals) const noexcept -> void
+	{
+		for (std::size_t index = 0; index < kCounterCount; ++index)
+		{
+			totals[index] += _counters[index].load(std::memory_order_relaxed);
+		}
+	}
+
+	/// @brief Replaces the values of all the counters.
+	///
+	/// This is used for counters that hold totals computed using addTo(). Such counters must not be incremented.
+	auto store(const Values &values) noexcept -> void
+	{
+		for (std::size_t index = 0; index < kCounterCount; ++index)
+		{
+			_counters[index].store(values[index], std::memory_order_relaxed);
+		}
+	}
+
+	/// @brief Iterates over all the attributes that belong to the counters.
+	/// @param function The function that should be called for each attribute
+	/// @return The return value of the last function call
+	auto forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool;
+
+	/// @brief Creates a read-handle for an attribute that belongs to the counters.
+	/// @param attribute The attribute to create the handle for
+	/// @return A read handle for the attribute, or std::nullopt if the attribute is unknown
+	auto makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>;
+
+private:
+	/// @brief Creates a read handle for a counter
+	template <Counter kCounter>
+	static auto counterReadHandle(const RuntimeCounters &counters) noexcept -> data::ReadHandle
+	{
+		return counters._counters[std::size_t(kCounter)];
+	}
+
+	/// @brief The counters, indexed by Counter
+	std::array<std::atomic<std::uint64_t>, kCounterCount> _counters {};
+
+	// Check that the counters are lock free, or blocking will occurr
+	static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+	// Check that the counters fit into the cache line of the object
+	static_assert(sizeof(_counters) <= kCacheLineSize);
+};
+
+} // namespace xentara::plugins::templateDriver
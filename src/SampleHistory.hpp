@@ -0,0 +1,163 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <xentara/data/Quality.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief A fixed-capacity history of the most recent samples of a value.
+///
+/// The history can be filled by a single thread, and read by any number of threads at the same time without locking.
+/// Each slot is protected by a sequence number, so readers can detect samples that were overwritten while they
+/// were reading them.
+///
+/// Only trivially copyable value types are supported.
+template <typename ValueType>
+class SampleHistory final
+{
+public:
+	/// @brief Whether the value type is supported
+	static constexpr bool kSupported = std::is_trivially_copyable_v<ValueType>;
+
+	/// @brief A single sample
+	struct Sample final
+	{
+		/// @brief The time stamp of the sample
+		std::chrono::system_clock::time_point _timeStamp;
+		/// @brief The value
+		ValueType _value {};
+		/// @brief The quality of the value
+		data::Quality _quality { data::Quality::Bad };
+	};
+
+	/// @brief Constructor
+	/// @param capacity The maximum number of samples kept. Must not be 0.
+	explicit SampleHistory(std::size_t capacity) requires kSupported :
+		_capacity(capacity), _slots(std::make_unique<Slot[]>(capacity))
+	{
+	}
+
+	/// @brief Returns the maximum number of samples kept
+	auto capacity() const noexcept -> std::size_t
+	{
+		return _capacity;
+	}
+
+	/// @brief Returns the memory used by the history, including the slots
+	auto memoryUsage() const noexcept -> std::size_t
+	{
+		return sizeof(*this) + _capacity * sizeof(Slot);
+	}
+
+	/// @brief Adds a sample, overwriting the oldest sample if the history is full.
+	/// @note This function must only be called from one thread at a time.
+	auto push(const Sample &sample) noexcept -> void;
+
+	/// @brief Visits the most recent samples, starting with the newest one.
+	///
+	/// Samples that are overwritten while they are being read are not visited, and neither are any older samples.
+	/// @param count The maximum number of samples to visit
+	/// @param visitor A function that is called with each sample
+	/// @return The number of samples visited
+	template <std::invocable<const Sample &> Visitor>
+	auto readLast(std::size_t count, Visitor &&visitor) const -> std::size_t;
+
+private:
+	/// @brief The number of 64-bit words needed to store a sample
+	static constexpr std::size_t kWordCount = (sizeof(Sample) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+	/// @brief A slot that holds a single sample
+	struct Slot final
+	{
+		/// @brief The sequence number of the slot.
+		/// 
+		/// This is 2 * (index + 1) once the sample with the given index was written, and odd while the slot is being written.
+		std::atomic<std::uint64_t> _sequence { 0 };
+		/// @brief The sample, stored as atomic words so that concurrent reads are well-defined
+		std::array<std::atomic<std::uint64_t>, kWordCount> _words {};
+	};
+
+	/// @brief The capacity
+	std::size_t _capacity;
+	/// @brief The slots
+	std::unique_ptr<Slot[]> _slots;
+	/// @brief The total number of samples pushed so far
+	std::atomic<std::uint64_t> _count { 0 };
+};
+
+template <typename ValueType>
+auto SampleHistory<ValueType>::push(const Sample &sample) noexcept -> void
+{
+	const auto index = _count.load(std::memory_order_relaxed);
+	auto &slot = _slots[index % _capacity];
+
+	// Copy the sample into words
+	std::array<std::uint64_t, kWordCount> words {};
+	std::memcpy(words.data(), &sample, sizeof(Sample));
+
+	// Mark the slot as being written
+	slot._sequence.store(2 * index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	for (std::size_t word = 0; word < kWordCount; ++word)
+	{
+		slot._words[word].store(words[word], std::memory_order_relaxed);
+	}
+
+	// Mark the slot as complete, and publish the new count
+	slot._sequence.store(2 * (index + 1), std::memory_order_release);
+	_count.store(index + 1, std::memory_order_release);
+}
+
+template <typename ValueType>
+template <std::invocable<const typename SampleHistory<ValueType>::Sample &> Visitor>
+auto SampleHistory<ValueType>::readLast(std::size_t count, Visitor &&visitor) const -> std::size_t
+{
+	const auto total = _count.load(std::memory_order_acquire);
+
+	std::size_t visited = 0;
+	for (; visited < count && visited < total && visited < _capacity; ++visited)
+	{
+		const auto index = total - 1 - visited;
+		const auto &slot = _slots[index % _capacity];
+
+		// Make sure the slot still contains the sample we want
+		const auto sequence = slot._sequence.load(std::memory_order_acquire);
+		if (sequence != 2 * (index + 1))
+		{
+			break;
+		}
+
+		std::array<std::uint64_t, kWordCount> words;
+		for (std::size_t word = 0; word < kWordCount; ++word)
+		{
+			words[word] = slot._words[word].load(std::memory_order_relaxed);
+		}
+
+		// Make sure the slot was not overwritten while we were reading it
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot._sequence.load(std::memory_order_relaxed) != sequence)
+		{
+			break;
+		}
+
+		Sample sample;
+		std::memcpy(&sample, words.data(), sizeof(Sample));
+		visitor(sample);
+	}
+
+	return visited;
+}
+
+} // namespace xentara::plugins::templateDriver
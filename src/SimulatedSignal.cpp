@@ -0,0 +1,51 @@
+// Copyright (c) embedded ocean GmbH
+#include "SimulatedSignal.hpp"
+
+#include "Simulator.hpp"
+
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+namespace xentara::plugins::templateDriver
+{
+
+auto SimulatedSignal::start(std::uint64_t seed) noexcept -> void
+{
+	_seed = seed;
+	// Use the last number in the sequence for the phase, so it does not coincide with any of the steps
+	_phase = Simulator::random(seed, std::numeric_limits<std::uint64_t>::max());
+	_walkSteps = 0;
+	_walkPosition = 0.0;
+}
+
+auto SimulatedSignal::value(std::chrono::duration<double> elapsed) noexcept -> double
+{
+	const auto periods = elapsed.count() / _period + _phase;
+
+	switch (_shape)
+	{
+	case Shape::Ramp:
+	default:
+		return _offset + _amplitude * (2.0 * (periods - std::floor(periods)) - 1.0);
+
+	case Shape::Sine:
+		return _offset + _amplitude * std::sin(2.0 * std::numbers::pi * periods);
+
+	case Shape::RandomWalk:
+		{
+			// Take all the steps that are due. This is usually at most one step per read.
+			const auto dueSteps = std::uint64_t(elapsed.count() / _period);
+			for (; _walkSteps < dueSteps; ++_walkSteps)
+			{
+				_walkPosition += _amplitude * (2.0 * Simulator::random(_seed, _walkSteps) - 1.0);
+			}
+			return _offset + _walkPosition;
+		}
+
+	case Shape::Step:
+		return _offset + _amplitude * (2.0 * Simulator::random(_seed, std::uint64_t(periods)) - 1.0);
+	}
+}
+
+} // namespace xentara::plugins::templateDriver
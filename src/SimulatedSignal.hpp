@@ -0,0 +1,93 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace xentara::plugins::templateDriver
+{
+
+using namespace std::literals;
+
+/// @brief The deterministic signal generated by a simulated input.
+///
+/// All shapes vary between offset - amplitude and offset + amplitude, except for the random walk, which starts at the
+/// offset and moves by up to one amplitude each period.
+class SimulatedSignal final
+{
+public:
+	/// @brief The shape of the signal
+	enum class Shape
+	{
+		/// @brief A sawtooth that rises over one period and then jumps back
+		Ramp,
+		/// @brief A sine wave with the given period
+		Sine,
+		/// @brief A value that moves by a random amount once per period
+		RandomWalk,
+		/// @brief A value that jumps to a random level once per period
+		Step
+	};
+
+	/// @brief Sets the shape
+	auto setShape(Shape shape) noexcept -> void
+	{
+		_shape = shape;
+	}
+
+	/// @brief Sets the period, or the interval between changes for random walks and steps
+	auto setPeriod(std::chrono::duration<double> period) noexcept -> void
+	{
+		_period = period.count();
+	}
+
+	/// @brief Sets the amplitude
+	auto setAmplitude(double amplitude) noexcept -> void
+	{
+		_amplitude = amplitude;
+	}
+
+	/// @brief Sets the offset
+	auto setOffset(double offset) noexcept -> void
+	{
+		_offset = offset;
+	}
+
+	/// @brief Returns the offset, which is the centre of the signal
+	auto offset() const noexcept -> double
+	{
+		return _offset;
+	}
+
+	/// @brief Restarts the signal with a new seed
+	/// @param seed The seed. Signals with different seeds have different phases and random values.
+	auto start(std::uint64_t seed) noexcept -> void;
+
+	/// @brief Returns the value of the signal at a certain time
+	///
+	/// This function is not thread safe, because random walks keep state. For random walks, the time must never
+	/// decrease between calls.
+	/// @param elapsed The time since the simulation was started
+	auto value(std::chrono::duration<double> elapsed) noexcept -> double;
+
+private:
+	/// @brief The shape
+	Shape _shape { Shape::Ramp };
+	/// @brief The period in seconds
+	double _period { 10.0 };
+	/// @brief The amplitude
+	double _amplitude { 100.0 };
+	/// @brief The offset
+	double _offset { 0.0 };
+
+	/// @brief The seed
+	std::uint64_t _seed { 0 };
+	/// @brief The phase, as a fraction of the period
+	double _phase { 0.0 };
+	/// @brief The number of steps the random walk has taken so far
+	std::uint64_t _walkSteps { 0 };
+	/// @brief The distance the random walk has moved from the offset
+	double _walkPosition { 0.0 };
+};
+
+} // namespace xentara::plugins::templateDriver
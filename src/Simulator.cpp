@@ -0,0 +1,62 @@
+// Copyright (c) embedded ocean GmbH
+#include "Simulator.hpp"
+
+#include <system_error>
+#include <thread>
+
+namespace xentara::plugins::templateDriver
+{
+
+namespace
+{
+
+	/// @brief The sequence used for the injected errors, so they don't correlate with the signals
+	constexpr std::uint64_t kErrorSequence = 0x6572726f72736571;
+
+} // namespace
+
+auto Simulator::start() noexcept -> void
+{
+	_startTime = std::chrono::steady_clock::now();
+	_transactionCount.store(0, std::memory_order_relaxed);
+}
+
+auto Simulator::write() -> void
+{
+	// Take as long as a real device would
+	if (_writeLatency > std::chrono::microseconds::zero())
+	{
+		std::this_thread::sleep_for(_writeLatency);
+	}
+
+	injectError();
+}
+
+auto Simulator::injectError() -> void
+{
+	// Don't even count the transactions if there are no errors, so the counter does not become a point of contention
+	if (_errorRate <= 0)
+	{
+		return;
+	}
+
+	const auto transaction = _transactionCount.fetch_add(1, std::memory_order_relaxed);
+	if (random(_seed ^ kErrorSequence, transaction) < _errorRate)
+	{
+		throw std::system_error(std::make_error_code(std::errc::io_error), "simulated I/O error");
+	}
+}
+
+auto Simulator::random(std::uint64_t seed, std::uint64_t index) noexcept -> double
+{
+	// Use the SplitMix64 finalizer, which gives well distributed values even for consecutive indices
+	auto value = seed + (index + 1) * 0x9e3779b97f4a7c15;
+	value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+	value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+	value ^= value >> 31;
+
+	// Use the top 53 bits as the mantissa of a double between 0 and 1
+	return double(value >> 11) * 0x1.0p-53;
+}
+
+} // namespace xentara::plugins::templateDriver
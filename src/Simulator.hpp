@@ -0,0 +1,104 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief A simulated I/O component that is used instead of the real device.
+///
+/// The simulator does not store any values itself. The inputs generate their values using a SimulatedSignal, and the
+/// outputs echo the last value written to them. The simulator provides the time base for the signals, and injects
+/// latency and errors into the transactions.
+///
+/// All the values and errors are derived from the seed, so that two runs with the same seed and the same configuration
+/// produce the same signals.
+class Simulator final
+{
+public:
+	/// @brief Enables or disables the simulation
+	auto setEnabled(bool enabled) noexcept -> void
+	{
+		_enabled = enabled;
+	}
+
+	/// @brief Checks whether the simulation is enabled
+	auto enabled() const noexcept -> bool
+	{
+		return _enabled;
+	}
+
+	/// @brief Sets the seed for the signals and the injected errors
+	auto setSeed(std::uint64_t seed) noexcept -> void
+	{
+		_seed = seed;
+	}
+
+	/// @brief Returns the seed for the signals and the injected errors
+	auto seed() const noexcept -> std::uint64_t
+	{
+		return _seed;
+	}
+
+	/// @brief Sets the time each write takes
+	auto setWriteLatency(std::chrono::microseconds latency) noexcept -> void
+	{
+		_writeLatency = latency;
+	}
+
+	/// @brief Sets the probability with which a read or write fails
+	/// @param errorRate The probability, between 0 and 1
+	auto setErrorRate(double errorRate) noexcept -> void
+	{
+		_errorRate = errorRate;
+	}
+
+	/// @brief Starts the time base of the signals, and resets the injected errors
+	auto start() noexcept -> void;
+
+	/// @brief Returns the time elapsed since start() was called
+	auto elapsed() const noexcept -> std::chrono::duration<double>
+	{
+		return std::chrono::steady_clock::now() - _startTime;
+	}
+
+	/// @brief Simulates a read transaction
+	/// @throw std::system_error An error was injected
+	auto read() -> void
+	{
+		injectError();
+	}
+
+	/// @brief Simulates a write transaction, waiting for the write latency
+	/// @throw std::system_error An error was injected
+	auto write() -> void;
+
+	/// @brief Returns a pseudo-random number between 0 and 1 derived from a seed and an index
+	/// @param seed The seed
+	/// @param index The index of the number within the sequence belonging to the seed
+	/// @return A number that is greater than or equal to 0, and less than 1
+	static auto random(std::uint64_t seed, std::uint64_t index) noexcept -> double;
+
+private:
+	/// @brief Throws an error with the configured probability
+	auto injectError() -> void;
+
+	/// @brief Whether the simulation is enabled
+	bool _enabled { false };
+	/// @brief The seed
+	std::uint64_t _seed { 0 };
+	/// @brief The time each write takes
+	std::chrono::microseconds _writeLatency { 0 };
+	/// @brief The probability with which a read or write fails
+	double _errorRate { 0 };
+
+	/// @brief The time the simulation was started
+	std::chrono::steady_clock::time_point _startTime;
+	/// @brief The number of transactions performed so far, which is used to decide which transactions fail
+	std::atomic<std::uint64_t> _transactionCount { 0 };
+};
+
+} // namespace xentara::plugins::templateDriver
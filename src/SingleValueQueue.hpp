@@ -24,9 +24,10 @@ public:
 	/// 
 	/// Any value already in the queue will be replaced.
 	/// @param value The value to place in the queue
-	auto enqueue(const value_type &value) noexcept -> void
+	/// @return Whether a value that had not been dequeued yet was replaced
+	auto enqueue(const value_type &value) noexcept -> bool
 	{
-		_value.store(value, std::memory_order_release);
+		return _value.exchange(value, std::memory_order_acq_rel).has_value();
 	}
 
 	/// @brief Gets the last scheduled value and removes it from the queue
@@ -36,6 +37,12 @@ public:
 		return _value.exchange(std::nullopt, std::memory_order_acq_rel);
 	}
 
+	/// @brief Checks whether the queue is empty
+	auto empty() const noexcept -> bool
+	{
+		return !_value.load(std::memory_order_acquire);
+	}
+
 private:
 	/// @brief The queued value, or std::nullopt if the queue is empty.
 	utils::atomic::Optional<value_type> _value;
@@ -56,16 +63,23 @@ public:
 	/// 
 	/// Any value already in the queue will be replaced.
 	/// @param value The value to place in the queue
+	/// @return Whether a value that had not been dequeued yet was replaced
 	template <typename... Arguments> requires std::constructible_from<value_type, Arguments &&...>
-	auto enqueue(Arguments &&... arguments) noexcept -> void
+	auto enqueue(Arguments &&... arguments) noexcept -> bool
 	{
-		_value.store(std::make_unique<value_type>(std::forward<Arguments>(arguments)...), std::memory_order_release);
+		return _value.exchange(std::make_unique<value_type>(std::forward<Arguments>(arguments)...), std::memory_order_acq_rel) != nullptr;
 	}
 
 	/// @brief Gets the last scheduled value and removes it from the queue
 	/// @return The scheduled value or std::nullopt if none was scheduled since the last call
 	auto dequeue() noexcept -> std::optional<value_type>;
 
+	/// @brief Checks whether the queue is empty
+	auto empty() const noexcept -> bool
+	{
+		return _value.load(std::memory_order_acquire) == nullptr;
+	}
+
 private:
 	/// @brief The queued value, or std::nullopt if the queue is empty.
 	utils::atomic::UniquePointer<value_type> _value;
@@ -14,7 +14,7 @@ auto Skill::createElement(const skill::Element::Class &elementClass, skill::Elem
 {
 	if (&elementClass == &TemplateIoComponent::Class::instance())
 	{
-		return factory.makeShared<TemplateIoComponent>();
+		return factory.makeShared<TemplateIoComponent>(_workerPool);
 	}
 
 	/// @todo handle any additional top-level I/O component classes
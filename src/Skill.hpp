@@ -4,6 +4,7 @@
 #include "TemplateIoComponent.hpp"
 #include "TemplateOutput.hpp"
 #include "TemplateInput.hpp"
+#include "WorkerPool.hpp"
 
 #include <xentara/skill/Skill.hpp>
 #include <xentara/utils/core/Uuid.hpp>
@@ -34,6 +35,9 @@ public:
 	/// @}
 
 private:
+	/// @brief The worker pool shared by all I/O components that perform their I/O in parallel
+	WorkerPool _workerPool;
+
 	/// @brief The skill class
 	/// @todo change class name
 	/// @todo assign a unique UUID
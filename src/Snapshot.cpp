@@ -0,0 +1,211 @@
+// Copyright (c) embedded ocean GmbH
+#include "Snapshot.hpp"
+
+#include <numeric>
+#include <system_error>
+
+#if defined(_WIN32)
+#	include <Windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace xentara::plugins::templateDriver
+{
+
+Snapshot::~Snapshot()
+{
+	close();
+}
+
+auto Snapshot::hash(std::span<const std::byte> data, std::uint64_t hash) noexcept -> std::uint64_t
+{
+	for (auto byte : data)
+	{
+		hash ^= std::to_integer<std::uint64_t>(byte);
+		hash *= 0x100000001b3;
+	}
+	return hash;
+}
+
+auto Snapshot::flushIfDue(std::chrono::system_clock::time_point timeStamp, std::chrono::milliseconds interval) noexcept -> void
+{
+	const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(timeStamp.time_since_epoch()).count();
+
+	// Claim the flush before performing it, so that threads publishing at the same time don't all flush
+	auto lastFlush = _lastFlush.load(std::memory_order_relaxed);
+	if (now - lastFlush < std::chrono::nanoseconds(interval).count() ||
+		!_lastFlush.compare_exchange_strong(lastFlush, now, std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	flush();
+}
+
+auto Snapshot::open(const std::filesystem::path &path, std::span<const std::size_t> recordSizes, std::uint64_t layout) -> bool
+{
+	close();
+	_lastFlush.store(0, std::memory_order_relaxed);
+
+	// Include the record sizes in the layout, so that a different number or size of records is detected
+	for (auto recordSize : recordSizes)
+	{
+		layout = hash(std::as_bytes(std::span(&recordSize, 1)), layout);
+	}
+
+	// Map the file
+	const auto size = std::accumulate(recordSizes.begin(), recordSizes.end(), sizeof(FileHeader));
+	map(path, size);
+
+	// Check the header
+	FileHeader header;
+	std::memcpy(&header, _data, sizeof(header));
+	const auto valid = header._magic == kMagic && header._layout == layout;
+
+	// If the file was empty or written with a different layout, start afresh
+	if (!valid)
+	{
+		std::memset(_data, 0, _size);
+		header = { kMagic, layout };
+		std::memcpy(_data, &header, sizeof(header));
+	}
+
+	// Create the records
+	_records.clear();
+	_records.reserve(recordSizes.size());
+	auto offset = sizeof(FileHeader);
+	for (auto recordSize : recordSizes)
+	{
+		_records.emplace_back(_data + offset, recordSize);
+		offset += recordSize;
+	}
+
+	return valid;
+}
+
+#if defined(_WIN32)
+
+auto Snapshot::map(const std::filesystem::path &path, std::size_t size) -> void
+{
+	auto file = ::CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		throw std::system_error(int(::GetLastError()), std::system_category(), "could not open snapshot file");
+	}
+
+	// Resize the file. A file of the wrong size cannot contain a valid snapshot anyway.
+	LARGE_INTEGER fileSize {};
+	fileSize.QuadPart = LONGLONG(size);
+	if (!::SetFilePointerEx(file, fileSize, nullptr, FILE_BEGIN) || !::SetEndOfFile(file))
+	{
+		const auto error = ::GetLastError();
+		::CloseHandle(file);
+		throw std::system_error(int(error), std::system_category(), "could not resize snapshot file");
+	}
+
+	auto mapping = ::CreateFileMappingW(file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+	auto data = mapping ? ::MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size) : nullptr;
+	if (!data)
+	{
+		const auto error = ::GetLastError();
+		if (mapping)
+		{
+			::CloseHandle(mapping);
+		}
+		::CloseHandle(file);
+		throw std::system_error(int(error), std::system_category(), "could not map snapshot file");
+	}
+
+	_file = std::intptr_t(file);
+	_mapping = std::intptr_t(mapping);
+	_data = static_cast<std::byte *>(data);
+	_size = size;
+}
+
+auto Snapshot::flush() noexcept -> void
+{
+	if (_data)
+	{
+		// FlushViewOfFile() starts the write without waiting for the data to reach the disk
+		::FlushViewOfFile(_data, _size);
+	}
+}
+
+auto Snapshot::close() noexcept -> void
+{
+	if (_data)
+	{
+		::FlushViewOfFile(_data, _size);
+		::UnmapViewOfFile(_data);
+		::CloseHandle(HANDLE(_mapping));
+		::CloseHandle(HANDLE(_file));
+		_data = nullptr;
+		_size = 0;
+		_file = -1;
+		_mapping = 0;
+	}
+	_records.clear();
+}
+
+#else
+
+auto Snapshot::map(const std::filesystem::path &path, std::size_t size) -> void
+{
+	const auto file = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (file < 0)
+	{
+		throw std::system_error(errno, std::system_category(), "could not open snapshot file");
+	}
+
+	// Resize the file. A file of the wrong size cannot contain a valid snapshot anyway.
+	struct stat status {};
+	if (::fstat(file, &status) != 0 || (std::size_t(status.st_size) != size && ::ftruncate(file, off_t(size)) != 0))
+	{
+		const auto error = errno;
+		::close(file);
+		throw std::system_error(error, std::system_category(), "could not resize snapshot file");
+	}
+
+	auto data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	if (data == MAP_FAILED)
+	{
+		const auto error = errno;
+		::close(file);
+		throw std::system_error(error, std::system_category(), "could not map snapshot file");
+	}
+
+	_file = file;
+	_data = static_cast<std::byte *>(data);
+	_size = size;
+}
+
+auto Snapshot::flush() noexcept -> void
+{
+	if (_data)
+	{
+		// MS_ASYNC schedules the write without waiting for the data to reach the disk
+		::msync(_data, _size, MS_ASYNC);
+	}
+}
+
+auto Snapshot::close() noexcept -> void
+{
+	if (_data)
+	{
+		::msync(_data, _size, MS_SYNC);
+		::munmap(_data, _size);
+		::close(int(_file));
+		_data = nullptr;
+		_size = 0;
+		_file = -1;
+	}
+	_records.clear();
+}
+
+#endif
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,208 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief A memory mapped file containing the last known values of the inputs of an I/O component.
+///
+/// The inputs write their values into their records whenever they publish a new value, and whichever task publishes
+/// values periodically flushes the file to disk. On startup, the values are restored from the file, so that the inputs
+/// have a value right away, instead of having to wait for the first read.
+///
+/// The file consists of a header followed by one record for each input. Each record contains a checksum, so that
+/// records that were only partially written when the system went down are detected.
+class Snapshot final
+{
+public:
+	/// @brief Default constructor
+	Snapshot() = default;
+	/// @brief Destructor. Closes the file.
+	~Snapshot();
+
+	/// @brief Snapshots cannot be copied
+	Snapshot(const Snapshot &) = delete;
+	/// @brief Snapshots cannot be copied
+	auto operator=(const Snapshot &) -> Snapshot & = delete;
+
+	/// @brief Returns the size of the record needed for a value type
+	template <typename ValueType>
+		requires std::is_trivially_copyable_v<ValueType>
+	static constexpr auto recordSize() noexcept -> std::size_t
+	{
+		return sizeof(RecordHeader) + alignedSize(sizeof(ValueType));
+	}
+
+	/// @brief Stores a value in a record
+	/// @param record The record. Must have been created for the value type.
+	/// @param timeStamp The time stamp of the value
+	/// @param value The value
+	template <typename ValueType>
+		requires std::is_trivially_copyable_v<ValueType>
+	static auto store(std::span<std::byte> record, std::chrono::system_clock::time_point timeStamp, const ValueType &value) noexcept -> void;
+
+	/// @brief Loads a value from a record
+	/// @param record The record. Must have been created for the value type.
+	/// @return The time stamp and the value, or std::nullopt if the record is empty or was only partially written
+	template <typename ValueType>
+		requires std::is_trivially_copyable_v<ValueType>
+	static auto load(std::span<const std::byte> record) noexcept
+		-> std::optional<std::pair<std::chrono::system_clock::time_point, ValueType>>;
+
+	/// @brief Opens or creates the snapshot file
+	/// @param path The path of the file
+	/// @param recordSizes The size of each record, as returned by recordSize()
+	/// @param layout A value that identifies the layout of the records. If the file was written with a different layout,
+	/// its contents are discarded.
+	/// @return Whether the file contained a valid snapshot with the same layout
+	/// @throw std::system_error The file could not be opened or mapped
+	auto open(const std::filesystem::path &path, std::span<const std::size_t> recordSizes, std::uint64_t layout) -> bool;
+
+	/// @brief Returns the record with the given index
+	auto record(std::size_t index) noexcept -> std::span<std::byte>
+	{
+		return _records[index];
+	}
+
+	/// @brief Starts writing any modified records to disk, without waiting for the write to complete
+	auto flush() noexcept -> void;
+
+	/// @brief Calls flush() if a certain time has passed since the last flush.
+	///
+	/// This function may be called from several threads at once. Only one of them will flush the file.
+	/// @param timeStamp The current time
+	/// @param interval The time that must pass between two flushes
+	auto flushIfDue(std::chrono::system_clock::time_point timeStamp, std::chrono::milliseconds interval) noexcept -> void;
+
+	/// @brief Closes the file
+	auto close() noexcept -> void;
+
+	/// @brief Checks whether the file is open
+	explicit operator bool() const noexcept
+	{
+		return _data != nullptr;
+	}
+
+	/// @brief Computes an FNV-1a hash, used for checksums and layout identifiers
+	/// @param data The data to hash
+	/// @param hash The hash of any preceding data
+	static auto hash(std::span<const std::byte> data, std::uint64_t hash = kHashBasis) noexcept -> std::uint64_t;
+
+	/// @brief Computes an FNV-1a hash of a string
+	static auto hash(std::string_view string, std::uint64_t hash = kHashBasis) noexcept -> std::uint64_t
+	{
+		return Snapshot::hash(std::as_bytes(std::span(string)), hash);
+	}
+
+	/// @brief The initial value of a hash
+	static constexpr std::uint64_t kHashBasis = 0xcbf29ce484222325;
+
+private:
+	/// @brief The header at the start of the file
+	struct FileHeader final
+	{
+		/// @brief The magic number identifying the file type
+		std::uint64_t _magic;
+		/// @brief The value identifying the layout of the records
+		std::uint64_t _layout;
+	};
+
+	/// @brief The header at the start of each record, followed by the value
+	struct RecordHeader final
+	{
+		/// @brief The checksum of the time stamp and the value
+		std::uint64_t _checksum;
+		/// @brief The time stamp in nanoseconds since the epoch, or 0 if the record is empty
+		std::int64_t _timeStamp;
+	};
+
+	/// @brief The magic number identifying the file type
+	static constexpr std::uint64_t kMagic = 0x31'50'41'4e'53'44'54'58; // "XTDSNAP1"
+
+	/// @brief Rounds a size up so that the next record is aligned correctly
+	static constexpr auto alignedSize(std::size_t size) noexcept -> std::size_t
+	{
+		return (size + alignof(RecordHeader) - 1) / alignof(RecordHeader) * alignof(RecordHeader);
+	}
+
+	/// @brief Computes the checksum of a record
+	static auto checksum(std::int64_t timeStamp, std::span<const std::byte> value) noexcept -> std::uint64_t
+	{
+		return hash(value, hash(std::as_bytes(std::span(&timeStamp, 1))));
+	}
+
+	/// @brief Maps the file into memory
+	auto map(const std::filesystem::path &path, std::size_t size) -> void;
+
+	/// @brief The mapped data, or nullptr if the file is not open
+	std::byte *_data { nullptr };
+	/// @brief The size of the mapped data
+	std::size_t _size { 0 };
+	/// @brief The native file handle
+	std::intptr_t _file { -1 };
+	/// @brief The native mapping handle. This is only used on Windows.
+	std::intptr_t _mapping { 0 };
+
+	/// @brief The records
+	std::vector<std::span<std::byte>> _records;
+
+	/// @brief The time of the last flush by flushIfDue(), in nanoseconds since the epoch
+	std::atomic<std::int64_t> _lastFlush { 0 };
+};
+
+template <typename ValueType>
+	requires std::is_trivially_copyable_v<ValueType>
+auto Snapshot::store(std::span<std::byte> record, std::chrono::system_clock::time_point timeStamp, const ValueType &value) noexcept -> void
+{
+	const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(timeStamp.time_since_epoch()).count();
+	const auto valueBytes = std::as_bytes(std::span(&value, 1));
+
+	// Write the value first and the checksum last, so that a partially written record is detected on load
+	std::memcpy(record.data() + sizeof(RecordHeader), valueBytes.data(), valueBytes.size());
+	std::memcpy(record.data() + offsetof(RecordHeader, _timeStamp), &nanoseconds, sizeof(nanoseconds));
+	const auto recordChecksum = checksum(nanoseconds, valueBytes);
+	std::memcpy(record.data() + offsetof(RecordHeader, _checksum), &recordChecksum, sizeof(recordChecksum));
+}
+
+template <typename ValueType>
+	requires std::is_trivially_copyable_v<ValueType>
+auto Snapshot::load(std::span<const std::byte> record) noexcept
+	-> std::optional<std::pair<std::chrono::system_clock::time_point, ValueType>>
+{
+	RecordHeader header;
+	std::memcpy(&header, record.data(), sizeof(header));
+
+	// Check for an empty record
+	if (header._timeStamp == 0)
+	{
+		return std::nullopt;
+	}
+
+	// Verify the checksum
+	const auto valueBytes = record.subspan(sizeof(RecordHeader), sizeof(ValueType));
+	if (header._checksum != checksum(header._timeStamp, valueBytes))
+	{
+		return std::nullopt;
+	}
+
+	ValueType value;
+	std::memcpy(&value, valueBytes.data(), sizeof(ValueType));
+	const auto timeStamp = std::chrono::system_clock::time_point(
+		std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(header._timeStamp)));
+	return std::pair { timeStamp, value };
+}
+
+} // namespace xentara::plugins::templateDriver
@@ -11,5 +11,9 @@ namespace xentara::plugins::templateDriver::tasks
 extern const process::Task::Role kRead;
 /// @brief A Xentara task used to write a data point
 extern const process::Task::Role kWrite;
+/// @brief A Xentara task used to start the reads and writes of an I/O component
+extern const process::Task::Role kDispatch;
+/// @brief A Xentara task used to wait for the reads and writes of an I/O component and publish the results
+extern const process::Task::Role kCollect;
 
 } // namespace xentara::plugins::templateDriver::tasks
\ No newline at end of file
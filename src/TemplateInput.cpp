@@ -2,8 +2,12 @@
 #include "TemplateInput.hpp"
 
 #include "AbstractTemplateInputHandler.hpp"
+#include "PackedWord.hpp"
+#include "Snapshot.hpp"
 #include "Tasks.hpp"
+#include "TemplateIoComponent.hpp"
 #include "TemplateInputHandler.hpp"
+#include "Tracer.hpp"
 
 #include <xentara/config/Errors.hpp>
 #include <xentara/model/Attribute.hpp>
@@ -11,16 +15,50 @@
 #include <xentara/model/ForEachEventFunction.hpp>
 #include <xentara/model/ForEachTaskFunction.hpp>
 #include <xentara/process/ExecutionContext.hpp>
+#include <xentara/utils/eh/currentErrorCode.hpp>
 #include <xentara/utils/json/decoder/Object.hpp>
 #include <xentara/utils/json/decoder/Errors.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <span>
+#include <typeinfo>
+
 namespace xentara::plugins::templateDriver
 {
 	
 using namespace std::literals;
 
+namespace
+{
+
+	/// @brief Creates an input handler for a specific value type
+	template <typename ValueType>
+	auto makeTypedHandler() -> std::unique_ptr<AbstractTemplateInputHandler>
+	{
+		return std::make_unique<TemplateInputHandler<ValueType>>();
+	}
+
+	/// @brief Adds an optional value to a hash
+	template <typename Value>
+	auto hashOptional(const std::optional<Value> &value, std::uint64_t hash) noexcept -> std::uint64_t
+	{
+		// Include whether the value is set, so that a missing value is distinct from a value of 0
+		const auto present = std::byte(value.has_value());
+		hash = Snapshot::hash(std::span(&present, 1), hash);
+		return value ? Snapshot::hash(std::as_bytes(std::span(&*value, 1)), hash) : hash;
+	}
+
+} // namespace
+
 auto TemplateInput::load(utils::json::decoder::Object &jsonObject, config::Context &context) -> void
 {
+	// The history size and oversampling must be applied after the handler was created, so we remember them here
+	std::size_t historySize = 0;
+	bool oversample = false;
+
 	// Go through all the members of the JSON object that represents this object
 	for (auto && [name, value] : jsonObject)
     {
@@ -28,6 +66,106 @@ auto TemplateInput::load(utils::json::decoder::Object &jsonObject, config::Conte
 		{
 			// Create the handler
 			_handler = createHandler(value);
+			_handler->setRuntimeCounters(_runtimeCounters);
+		}
+		else if (name == "pollEvery"sv)
+		{
+			const auto pollEvery = value.asNumber<std::uint32_t>();
+
+			// Check that the value is valid
+			if (pollEvery == 0)
+			{
+				/// @todo replace "template input" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("poll divider of template input must not be 0"));
+			}
+
+			// Set the divider, using a phase that spreads the polls evenly across the executions
+			_readTask.setPollDivider({ pollEvery, _ioComponent.get().allocatePollPhase(pollEvery) });
+		}
+		else if (name == "historySize"sv)
+		{
+			historySize = value.asNumber<std::size_t>();
+
+			// Check that the value is valid
+			if (historySize == 0)
+			{
+				/// @todo replace "template input" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("history size of template input must not be 0"));
+			}
+		}
+		else if (name == "oversample"sv)
+		{
+			oversample = value.asBool();
+		}
+		else if (name == "compact"sv)
+		{
+			_compact = value.asBool();
+		}
+		else if (name == "address"sv)
+		{
+			_address = value.asNumber<std::uint64_t>();
+		}
+		else if (name == "bit"sv)
+		{
+			_bit = value.asNumber<unsigned>();
+
+			// Check that the value is valid
+			if (*_bit >= PackedWord::kBitCount)
+			{
+				/// @todo replace "template input" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("bit of template input must be less than 64"));
+			}
+		}
+		else if (name == "replayPoint"sv)
+		{
+			_replayPoint = value.asNumber<std::uint32_t>();
+		}
+		else if (name == "signal"sv)
+		{
+			// Get the keyword from the value
+			const auto keyword = value.asString<std::string>();
+			if (keyword == "ramp"sv)
+			{
+				_signal.setShape(SimulatedSignal::Shape::Ramp);
+			}
+			else if (keyword == "sine"sv)
+			{
+				_signal.setShape(SimulatedSignal::Shape::Sine);
+			}
+			else if (keyword == "randomWalk"sv)
+			{
+				_signal.setShape(SimulatedSignal::Shape::RandomWalk);
+			}
+			else if (keyword == "step"sv)
+			{
+				_signal.setShape(SimulatedSignal::Shape::Step);
+			}
+			else
+			{
+				/// @todo replace "template input" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("unknown simulated signal in template input"));
+			}
+		}
+		else if (name == "signalPeriod"sv)
+		{
+			const auto signalPeriod = std::chrono::milliseconds(value.asNumber<std::uint32_t>());
+
+			// Check that the value is valid
+			if (signalPeriod == 0ms)
+			{
+				/// @todo replace "template input" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("simulated signal period of template input must not be 0"));
+			}
+
+			_signal.setPeriod(signalPeriod);
+		}
+		else if (name == "signalAmplitude"sv)
+		{
+			_signal.setAmplitude(value.asNumber<double>());
+		}
+		else if (name == "signalOffset"sv)
+		{
+			_signal.setOffset(value.asNumber<double>());
 		}
 		/// @todo load custom configuration parameters
 		else if (name == "TODO"sv)
@@ -56,6 +194,48 @@ auto TemplateInput::load(utils::json::decoder::Object &jsonObject, config::Conte
 		/// @todo replace "template input" with a more descriptive name
 		utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("Missing data type in template input"));
 	}
+
+	// Enable the history, if requested
+	if (historySize != 0 && !_handler->enableHistory(historySize))
+	{
+		/// @todo replace "template input" with a more descriptive name
+		utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("the data type of the template input does not support a sample history"));
+	}
+
+	// Map the value to a bit of a word shared with other inputs, if requested
+	if (_bit)
+	{
+		if (!_address)
+		{
+			/// @todo replace "template input" with a more descriptive name
+			utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("a template input mapped to a bit needs an address"));
+		}
+
+		// The sampler thread would only ever see the word read by the last cycle of the I/O component
+		if (oversample)
+		{
+			/// @todo replace "template input" with a more descriptive name
+			utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("a template input mapped to a bit cannot be oversampled"));
+		}
+
+		if (!_handler->mapBit(_ioComponent.get().packedWord(*_address), *_bit))
+		{
+			/// @todo replace "template input" with a more descriptive name
+			utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("the data type of the template input cannot be mapped to a bit"));
+		}
+	}
+
+	// Enable oversampling, if requested, and register with the sampler thread of the I/O component
+	if (oversample)
+	{
+		if (!_handler->enableOversampling())
+		{
+			/// @todo replace "template input" with a more descriptive name
+			utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("the data type of the template input does not support oversampling"));
+		}
+		_ioComponent.get().addOversampledInput(*this);
+	}
+
 	/// @todo perform consistency and completeness checks
 	if (!"TODO")
 	{
@@ -68,65 +248,88 @@ auto TemplateInput::createHandler(utils::json::decoder::Value &value) -> std::un
 {
 	// Get the keyword from the value
 	auto keyword = value.asString<std::string>();
-	
+
+	// Create the handler
+	auto handler = makeHandler(keyword);
+	if (!handler)
+	{
+		/// @todo replace "template input" with a more descriptive name
+		utils::json::decoder::throwWithLocation(value, std::runtime_error("unknown data type in template input"));
+	}
+
+	return handler;
+}
+
+auto TemplateInput::makeHandler(std::string_view keyword) -> std::unique_ptr<AbstractTemplateInputHandler>
+{
+	const auto factory = handlerFactory(keyword);
+	return factory ? factory() : nullptr;
+}
+
+auto TemplateInput::handlerFactory(std::string_view keyword) -> HandlerFactory
+{
 	/// @todo use keywords that are appropriate to the I/O component
 	if (keyword == "bool"sv)
 	{
-		return std::make_unique<TemplateInputHandler<bool>>();
+		return &makeTypedHandler<bool>;
 	}
 	else if (keyword == "uint8"sv)
 	{
-		return std::make_unique<TemplateInputHandler<std::uint8_t>>();
+		return &makeTypedHandler<std::uint8_t>;
 	}
 	else if (keyword == "uint16"sv)
 	{
-		return std::make_unique<TemplateInputHandler<std::uint16_t>>();
+		return &makeTypedHandler<std::uint16_t>;
 	}
 	else if (keyword == "uint32"sv)
 	{
-		return std::make_unique<TemplateInputHandler<std::uint32_t>>();
+		return &makeTypedHandler<std::uint32_t>;
 	}
 	else if (keyword == "uint64"sv)
 	{
-		return std::make_unique<TemplateInputHandler<std::uint64_t>>();
+		return &makeTypedHandler<std::uint64_t>;
 	}
 	else if (keyword == "int8"sv)
 	{
-		return std::make_unique<TemplateInputHandler<std::int8_t>>();
+		return &makeTypedHandler<std::int8_t>;
 	}
 	else if (keyword == "int16"sv)
 	{
-		return std::make_unique<TemplateInputHandler<std::int16_t>>();
+		return &makeTypedHandler<std::int16_t>;
 	}
 	else if (keyword == "int32"sv)
 	{
-		return std::make_unique<TemplateInputHandler<std::int32_t>>();
+		return &makeTypedHandler<std::int32_t>;
 	}
 	else if (keyword == "int64"sv)
 	{
-		return std::make_unique<TemplateInputHandler<std::int64_t>>();
+		return &makeTypedHandler<std::int64_t>;
 	}
 	else if (keyword == "float32"sv)
 	{
-		return std::make_unique<TemplateInputHandler<float>>();
+		return &makeTypedHandler<float>;
 	}
 	else if (keyword == "float64"sv)
 	{
-		return std::make_unique<TemplateInputHandler<double>>();
+		return &makeTypedHandler<double>;
 	}
 	else if (keyword == "string"sv)
 	{
-		return std::make_unique<TemplateInputHandler<std::string>>();
+		return &makeTypedHandler<std::string>;
 	}
-
-	// The keyword is not known
-	else
+	else if (keyword == "string[64]"sv)
 	{
-		/// @todo replace "template input" with a more descriptive name
-		utils::json::decoder::throwWithLocation(value, std::runtime_error("unknown data type in template input"));
+		return &makeTypedHandler<InlineString>;
 	}
 
-	return std::unique_ptr<AbstractTemplateInputHandler>();
+	// The keyword is not known
+	return nullptr;
+}
+
+auto TemplateInput::performInitialRead(const process::ExecutionContext &context) -> process::Task::Status
+{
+	// The I/O component performs the initial read for all its data points at once
+	return _ioComponent.get().performInitialRead(context);
 }
 
 auto TemplateInput::performReadTask(const process::ExecutionContext &context) -> void
@@ -138,8 +341,135 @@ auto TemplateInput::performReadTask(const process::ExecutionContext &context) ->
 		throw std::logic_error("internal error: \"read\" task of xentara::plugins::templateDriver::TemplateInput executed before configuration has been loaded");
 	}
 
+	TraceSpan span(_ioComponent.get().tracer(), "task"sv, "read"sv, _traceName);
+
 	// Ask the handler to read the data
-	_handler->read(context.scheduledTime());
+	_handler->read(context.scheduledTime(), _ioComponent.get().acquisitionClock());
+
+	// The handler has stored the value in the snapshot, so flush it to disk periodically
+	_ioComponent.get().flushSnapshot(context.scheduledTime());
+}
+
+auto TemplateInput::acquire() -> void
+{
+	// tasks must not be executed before the configuration was loaded, so the handler should have been
+	// created already.
+	if (!_handler) [[unlikely]]
+	{
+		throw std::logic_error("internal error: xentara::plugins::templateDriver::TemplateInput::acquire() called before configuration has been loaded");
+	}
+
+	TraceSpan span(_ioComponent.get().tracer(), "device"sv, "read"sv, _traceName);
+
+	// Ask the handler to acquire the data
+	_handler->acquire(_ioComponent.get().acquisitionClock());
+}
+
+auto TemplateInput::publish(std::chrono::system_clock::time_point timeStamp) -> void
+{
+	// tasks must not be executed before the configuration was loaded, so the handler should have been
+	// created already.
+	if (!_handler) [[unlikely]]
+	{
+		throw std::logic_error("internal error: xentara::plugins::templateDriver::TemplateInput::publish() called before configuration has been loaded");
+	}
+
+	// Ask the handler to publish the data
+	_handler->publish(timeStamp);
+}
+
+auto TemplateInput::snapshotSize() const -> std::size_t
+{
+	// The snapshot is set up after the configuration was loaded, so the handler should have been created already.
+	if (!_handler) [[unlikely]]
+	{
+		throw std::logic_error("internal error: xentara::plugins::templateDriver::TemplateInput::snapshotSize() called before configuration has been loaded");
+	}
+
+	return _handler->snapshotSize();
+}
+
+auto TemplateInput::snapshotKey() const -> std::uint64_t
+{
+	// The snapshot is set up after the configuration was loaded, so the handler should have been created already.
+	if (!_handler) [[unlikely]]
+	{
+		throw std::logic_error("internal error: xentara::plugins::templateDriver::TemplateInput::snapshotKey() called before configuration has been loaded");
+	}
+
+	// The type of the handler uniquely identifies the data type
+	auto key = Snapshot::hash(typeid(*_handler).name());
+
+	// Add where the value comes from, so that the value of one input is never restored into another
+	key = hashOptional(_address, key);
+	key = hashOptional(_bit, key);
+	key = hashOptional(_replayPoint, key);
+
+	/// @todo add any custom configuration parameters that identify where the value comes from
+
+	return key;
+}
+
+auto TemplateInput::attachSnapshot(std::span<std::byte> record, bool restore) -> void
+{
+	// The snapshot is set up after the configuration was loaded, so the handler should have been created already.
+	if (!_handler) [[unlikely]]
+	{
+		throw std::logic_error("internal error: xentara::plugins::templateDriver::TemplateInput::attachSnapshot() called before configuration has been loaded");
+	}
+
+	_handler->attachSnapshot(record, restore);
+}
+
+auto TemplateInput::simulate(Simulator &simulator, std::size_t index) -> void
+{
+	// The simulation is set up after the configuration was loaded, so the handler should have been created already.
+	if (!_handler) [[unlikely]]
+	{
+		throw std::logic_error("internal error: xentara::plugins::templateDriver::TemplateInput::simulate() called before configuration has been loaded");
+	}
+
+	// Give each input its own seed, so that the inputs don't all generate the same values
+	_signal.start(simulator.seed() + index);
+	_handler->simulate(simulator, _signal);
+}
+
+auto TemplateInput::replay(Replayer &replayer, std::size_t index) -> void
+{
+	// The replay is set up after the configuration was loaded, so the handler should have been created already.
+	if (!_handler) [[unlikely]]
+	{
+		throw std::logic_error("internal error: xentara::plugins::templateDriver::TemplateInput::replay() called before configuration has been loaded");
+	}
+
+	_handler->replay(replayer, replayPoint(index));
+}
+
+auto TemplateInput::sample() -> void
+{
+	// Only inputs that have a handler are ever registered with the sampler thread, so we don't need to check
+	// the handler here.
+	TraceSpan span(_ioComponent.get().tracer(), "device"sv, "sample"sv, _traceName);
+	_handler->sample(_ioComponent.get().acquisitionClock());
+}
+
+auto TemplateInput::compact() const noexcept -> bool
+{
+	return _compact.value_or(_ioComponent.get().compactDataPoints());
+}
+
+auto TemplateInput::footprint() const noexcept -> MemoryFootprint
+{
+	// The footprint is computed after the configuration was loaded, so the handler should have been created already.
+	if (!_handler) [[unlikely]]
+	{
+		// Don't throw an exception, because this function is noexcept
+		return { ._object = sizeof(*this) };
+	}
+
+	auto footprint = _handler->footprint();
+	footprint._object += sizeof(*this);
+	return footprint;
 }
 
 auto TemplateInput::invalidateData(std::chrono::system_clock::time_point timeStamp) -> void
@@ -182,9 +512,23 @@ auto TemplateInput::forEachAttribute(const model::ForEachAttributeFunction &func
 		throw std::logic_error("internal error: xentara::plugins::templateDriver::TemplateInput::forEachAttribute() called before configuration has been loaded");
 	}
 
+	// Leave out the change time in the compact representation
+	if (compact())
+	{
+		const auto filtered = [&function](const model::Attribute &attribute)
+		{
+			return attribute != model::Attribute::kChangeTime && function(attribute);
+		};
+		return
+			_handler->forEachAttribute(filtered) ||
+			_runtimeCounters.forEachAttribute(function);
+	}
+
 	return
 		// Handle the handler attributes
-		_handler->forEachAttribute(function);
+		_handler->forEachAttribute(function) ||
+		// Handle the runtime counters
+		_runtimeCounters.forEachAttribute(function);
 
 	/// @todo handle any additional attributes this class supports, including attributes inherited from the I/O component
 }
@@ -198,6 +542,12 @@ auto TemplateInput::forEachEvent(const model::ForEachEventFunction &function) ->
 		throw std::logic_error("internal error: xentara::plugins::templateDriver::TemplateInput::forEachEvent() called before configuration has been loaded");
 	}
 
+	// The compact representation has no events. Not asking the handler means that the events are never created.
+	if (compact())
+	{
+		return false;
+	}
+
 	return
 		// Handle the handler events
 		_handler->forEachEvent(function, sharedFromThis());
@@ -224,11 +574,22 @@ auto TemplateInput::makeReadHandle(const model::Attribute &attribute) const noex
 		return std::make_error_code(std::errc::invalid_argument);
 	}
 
+	// Leave out the change time in the compact representation
+	if (compact() && &attribute == &model::Attribute::kChangeTime)
+	{
+		return std::nullopt;
+	}
+
 	// Handle the handler attributes
 	if (auto handle = _handler->makeReadHandle(attribute))
 	{
 		return handle;
 	}
+	// Handle the runtime counters
+	if (auto handle = _runtimeCounters.makeReadHandle(attribute))
+	{
+		return handle;
+	}
 
 	/// @todo handle any additional readable attributes this class supports, including attributes inherited from the I/O component
 
@@ -246,6 +607,10 @@ auto TemplateInput::realize() -> void
 
 	// Realize the handler
 	_handler->realize();
+
+	// Leave the periodic reads to the I/O component, if its tasks perform them. The configuration of the I/O component
+	// has been loaded by now.
+	_readTask.setDelegated(_ioComponent.get().componentTasks());
 }
 
 } // namespace xentara::plugins::templateDriver
\ No newline at end of file
@@ -2,14 +2,26 @@
 #pragma once
 
 #include "ReadTask.hpp"
+#include "Replayer.hpp"
 #include "AbstractTemplateInputHandler.hpp"
+#include "MemoryFootprint.hpp"
+#include "RuntimeCounters.hpp"
+#include "SampleHistory.hpp"
+#include "SimulatedSignal.hpp"
+#include "Simulator.hpp"
+#include "TemplateInputHandler.hpp"
 
 #include <xentara/process/Task.hpp>
 #include <xentara/skill/DataPoint.hpp>
 #include <xentara/skill/EnableSharedFromThis.hpp>
 #include <xentara/utils/json/decoder/Value.hpp>
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <optional>
+#include <span>
+#include <string>
 #include <string_view>
 
 namespace xentara::plugins::templateDriver
@@ -34,6 +46,7 @@ public:
 	TemplateInput(std::reference_wrapper<TemplateIoComponent> ioComponent) :
 		_ioComponent(ioComponent)
 	{
+		_readTask.setRuntimeCounters(_runtimeCounters);
 	}
 
 	/// @name Virtual Overrides for skill::DataPoint
@@ -53,9 +66,39 @@ public:
 
 	/// @}
 
+	/// @brief A function that creates an input handler for a specific data type
+	using HandlerFactory = auto (*)() -> std::unique_ptr<AbstractTemplateInputHandler>;
+
+	/// @brief Creates an input handler for a data type
+	/// @param keyword The keyword used for the data type in the configuration
+	/// @return The handler, or nullptr if the keyword is unknown
+	static auto makeHandler(std::string_view keyword) -> std::unique_ptr<AbstractTemplateInputHandler>;
+
+	/// @brief Looks up the function that creates input handlers for a data type.
+	///
+	/// This allows the keyword to be looked up only once when creating many handlers of the same type.
+	/// @param keyword The keyword used for the data type in the configuration
+	/// @return The function, or nullptr if the keyword is unknown
+	static auto handlerFactory(std::string_view keyword) -> HandlerFactory;
+
+	/// @brief Returns the history of the most recent samples
+	/// @tparam ValueType The value type of the input
+	/// @return The sample history, or nullptr if no sample history was configured, or if the input has a different
+	/// value type.
+	template <typename ValueType>
+	auto sampleHistory() const noexcept -> const SampleHistory<ValueType> *
+	{
+		const auto handler = dynamic_cast<const TemplateInputHandler<ValueType> *>(_handler.get());
+		return handler ? handler->history() : nullptr;
+	}
+
 private:
 	/// @brief The read task needs access to out private member functions
 	friend class ReadTask<TemplateInput>;
+	/// @brief The I/O component needs access to out private member functions to read all its inputs at once
+	friend class TemplateIoComponent;
+	/// @brief The read handle benchmark sets the handler, which is normally created by load()
+	friend class ReadHandleBenchmark;
 
 	/// @brief Creates an input handler based on a configuration value
 	auto createHandler(utils::json::decoder::Value &value) -> std::unique_ptr<AbstractTemplateInputHandler>;
@@ -64,9 +107,57 @@ private:
 	///
 	/// This function attempts to read the value if the I/O component is up.
 	auto performReadTask(const process::ExecutionContext &context) -> void;
+	/// @brief This function is called by the "read" task before going operational.
+	///
+	/// This function waits for the initial read of the I/O component, which includes this data point.
+	/// @return process::Task::Status::Ready once the initial read has completed, or process::Task::Status::Pending otherwise
+	auto performInitialRead(const process::ExecutionContext &context) -> process::Task::Status;
+	/// @brief Acquires the value from the I/O component without publishing it.
+	///
+	/// This function is called by the I/O component, and may be called from a worker thread.
+	auto acquire() -> void;
+	/// @brief Publishes a value acquired using acquire(), if any
+	auto publish(std::chrono::system_clock::time_point timeStamp) -> void;
+	/// @brief Takes a sample if the input is oversampled.
+	///
+	/// This function is called from the sampler thread of the I/O component.
+	auto sample() -> void;
+
+	/// @brief Reads the value from a simulation instead of the I/O component
+	/// @param simulator The simulator
+	/// @param index The index of the input within the I/O component, which is used to derive the seed of the signal
+	auto simulate(Simulator &simulator, std::size_t index) -> void;
+
+	/// @brief Returns the point in the replay file the input is replayed from
+	/// @param index The index of the input within the I/O component, which is used if no point was configured
+	auto replayPoint(std::size_t index) const noexcept -> std::size_t
+	{
+		return _replayPoint.value_or(index);
+	}
+	/// @brief Reads the value from a replay file instead of the I/O component
+	/// @param replayer The replayer
+	/// @param index The index of the input within the I/O component, which is used if no point was configured
+	auto replay(Replayer &replayer, std::size_t index) -> void;
+
+	/// @brief Returns whether the compact representation is used
+	auto compact() const noexcept -> bool;
+
+	/// @brief Returns the memory used by the input, including its handler, its data blocks and its events
+	auto footprint() const noexcept -> MemoryFootprint;
+
 	/// @brief Invalidates any read data
 	auto invalidateData(std::chrono::system_clock::time_point timeStamp) -> void;
 
+	/// @brief Returns the size of the snapshot record for the input
+	/// @return The record size, or 0 if the data type cannot be stored in a snapshot
+	auto snapshotSize() const -> std::size_t;
+	/// @brief Returns a value identifying the input in a snapshot
+	///
+	/// The key is derived from the data type and from where the value comes from, like the address.
+	auto snapshotKey() const -> std::uint64_t;
+	/// @brief Attaches a snapshot record to the input, and optionally restores the value from it
+	auto attachSnapshot(std::span<std::byte> record, bool restore) -> void;
+
 	/// @name Virtual Overrides for skill::DataPoint
 	/// @{
 
@@ -83,6 +174,25 @@ private:
 	/// @brief The handler for data type specific functionality, or nullptr, if the data type hans not been loaded yet
 	std::unique_ptr<AbstractTemplateInputHandler> _handler;
 
+	/// @brief The signal generated if the I/O component is simulated
+	SimulatedSignal _signal;
+	/// @brief The point in the replay file the input is replayed from, or std::nullopt to use the index of the input
+	std::optional<std::size_t> _replayPoint;
+
+	/// @brief Whether to use the compact representation, or std::nullopt to use the default of the I/O component
+	std::optional<bool> _compact;
+
+	/// @brief The address of the value on the I/O component, or std::nullopt if none was configured
+	std::optional<std::uint64_t> _address;
+	/// @brief The bit of the word at _address the value is mapped to, or std::nullopt if the value is not mapped to a bit
+	std::optional<unsigned> _bit;
+
+	/// @brief The name of the input in trace files, assigned by the I/O component
+	std::string _traceName;
+
+	/// @brief The counters for the reads and writes
+	RuntimeCounters _runtimeCounters;
+
 	/// @brief The "read" task
 	ReadTask<TemplateInput> _readTask { *this };
 };
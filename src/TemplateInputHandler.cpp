@@ -2,6 +2,8 @@
 #include "TemplateInputHandler.hpp"
 
 #include "Attributes.hpp"
+#include "CustomError.hpp"
+#include "Snapshot.hpp"
 
 #include <xentara/data/DataType.hpp>
 #include <xentara/data/ReadHandle.hpp>
@@ -9,6 +11,14 @@
 #include <xentara/utils/eh/currentErrorCode.hpp>
 #include <xentara/utils/tools/Concepts.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
 namespace xentara::plugins::templateDriver
 {
 	
@@ -18,34 +28,270 @@ template <typename ValueType>
 const model::Attribute TemplateInputHandler<ValueType>::kValueAttribute { model::Attribute::kValue, model::Attribute::Access::ReadOnly, staticDataType() };
 
 template <typename ValueType>
-auto TemplateInputHandler<ValueType>::read(std::chrono::system_clock::time_point timeStamp) -> void
+auto TemplateInputHandler<ValueType>::read(std::chrono::system_clock::time_point timeStamp, const AcquisitionClock &clock) -> void
 {
-	try
+	// Read the packed word first if the value is mapped to a bit. Otherwise, the bit would be extracted from the word cached
+	// by the last cycle of the I/O component.
+	if (readsPackedWord())
 	{
-		// Call the other read function, but catch exceptions.
-		doRead(timeStamp);
+		_packedWord->refresh();
+	}
 
+	// Acquire the value and publish it right away
+	acquire(clock);
+	publish(timeStamp);
+}
+
+template <typename ValueType>
+auto TemplateInputHandler<ValueType>::acquire(const AcquisitionClock &clock) -> void
+{
+	// If we are oversampling, the value was already read by the sampler thread, so we just take the last sample
+	if constexpr (kOversamplingSupported)
+	{
+		if (_oversampler)
+		{
+			if (auto lastSample = _oversampler->collect())
+			{
+				_acquiredValue = std::move(lastSample->_valueOrError);
+				_acquisitionTime = lastSample->_timeStamp;
+			}
+			return;
+		}
+	}
+
+	try
+	{
+		// Call the read function, but catch exceptions.
+		_acquiredValue = doRead();
 	}
 	catch (const std::exception &)
 	{
 		// Get the error from the current exception using this special utility function
-		const auto error = utils::eh::currentErrorCode();
-		// Update the state
-		_state.update(timeStamp, utils::eh::unexpected(error));
+		_acquiredValue = utils::eh::unexpected(utils::eh::currentErrorCode());
+		count(RuntimeCounters::Counter::ReadErrors);
+	}
+	count(RuntimeCounters::Counter::Reads);
+
+	// Time stamp the value right after reading it
+	_acquisitionTime = clock.stamp();
+}
+
+template <typename ValueType>
+auto TemplateInputHandler<ValueType>::publish(std::chrono::system_clock::time_point timeStamp) -> void
+{
+	// Publish the aggregate of the samples. This is done even if the sampler thread took no samples, so that the
+	// sample count drops to 0.
+	if constexpr (kOversamplingSupported)
+	{
+		if (_oversampler)
+		{
+			_oversampler->publish();
+		}
+	}
+
+	// If nothing was acquired, just bail
+	if (!_acquiredValue)
+	{
+		return;
+	}
+
+	// Determine the time stamp, preferring the acquisition time stamp
+	const auto sampleTime = _acquisitionTime.value_or(timeStamp);
+
+	// Record the sample in the history, unless we are oversampling, in which case sample() has recorded all the samples
+	// already.
+	if (!_oversampler)
+	{
+		recordHistory(sampleTime, *_acquiredValue);
+	}
+
+	// Store the value in the snapshot
+	if constexpr (std::is_trivially_copyable_v<ValueType>)
+	{
+		if (!_snapshotRecord.empty() && *_acquiredValue)
+		{
+			Snapshot::store(_snapshotRecord, sampleTime, **_acquiredValue);
+		}
+	}
+
+	// Update the state. We don't need the value any more, so we can move it.
+	_state.update(sampleTime, std::move(*_acquiredValue));
+
+	_acquiredValue.reset();
+}
+
+template <typename ValueType>
+auto TemplateInputHandler<ValueType>::recordHistory(std::chrono::system_clock::time_point timeStamp,
+	const utils::eh::expected<ValueType, std::error_code> &valueOrError) noexcept -> void
+{
+	if constexpr (SampleHistory<ValueType>::kSupported)
+	{
+		if (_history)
+		{
+			if (valueOrError)
+			{
+				_history->push({ timeStamp, *valueOrError, data::Quality::Good });
+			}
+			else
+			{
+				_history->push({ timeStamp, {}, data::Quality::Bad });
+			}
+		}
+	}
+}
+
+template <typename ValueType>
+auto TemplateInputHandler<ValueType>::sample(const AcquisitionClock &clock) -> void
+{
+	if constexpr (kOversamplingSupported)
+	{
+		// Ignore this if we are not oversampling
+		if (!_oversampler)
+		{
+			return;
+		}
+
+		typename Oversampler<ValueType>::Sample sample;
+		try
+		{
+			// Call the read function, but catch exceptions.
+			sample._valueOrError = doRead();
+		}
+		catch (const std::exception &)
+		{
+			// Get the error from the current exception using this special utility function
+			sample._valueOrError = utils::eh::unexpected(utils::eh::currentErrorCode());
+			count(RuntimeCounters::Counter::ReadErrors);
+		}
+		count(RuntimeCounters::Counter::Reads);
+
+		// Time stamp the value right after reading it
+		sample._timeStamp = clock.stamp();
+
+		// Record every sample in the history, not just the last sample of each cycle. The history is only ever filled
+		// by this thread while we are oversampling.
+		recordHistory(sample._timeStamp.value_or(std::chrono::system_clock::now()), sample._valueOrError);
+
+		_oversampler->addSample(std::move(sample));
+	}
+}
+
+template <typename ValueType>
+auto TemplateInputHandler<ValueType>::mapBit(PackedWord &word, unsigned bit) -> bool
+{
+	// Only boolean values can be mapped to a bit
+	if constexpr (std::same_as<ValueType, bool>)
+	{
+		_packedWord = &word;
+		_bit = bit;
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
+template <typename ValueType>
+auto TemplateInputHandler<ValueType>::simulate(Simulator &simulator, const SimulatedSignal &signal) -> void
+{
+	_simulator = &simulator;
+	_signal = signal;
+}
+
+template <typename ValueType>
+auto TemplateInputHandler<ValueType>::doSimulatedRead() -> ValueType
+{
+	_simulator->read();
+	const auto value = _signal.value(_simulator->elapsed());
+
+	// Boolean inputs are true while the signal is above its centre
+	if constexpr (std::same_as<ValueType, bool>)
+	{
+		return value > _signal.offset();
+	}
+	else
+	{
+		return fromNumber(value);
+	}
+}
+
+template <typename ValueType>
+auto TemplateInputHandler<ValueType>::doReplayedRead() -> ValueType
+{
+	// Replay any values that have become due
+	_replayer->poll();
+
+	const auto value = _replayer->value(_replayPoint);
+	if (!value)
+	{
+		throw std::system_error(CustomError::NoData);
+	}
+	return fromNumber(*value);
+}
+
+template <typename ValueType>
+auto TemplateInputHandler<ValueType>::fromNumber(double value) -> ValueType
+{
+	if constexpr (std::same_as<ValueType, bool>)
+	{
+		return value != 0;
+	}
+	else if constexpr (utils::tools::Integral<ValueType>)
+	{
+		// Clamp the value to the range of the type. The limits are converted to double first, which may round
+		// the upper limit up, so we check for it separately.
+		constexpr auto kMin = double(std::numeric_limits<ValueType>::min());
+		constexpr auto kMax = double(std::numeric_limits<ValueType>::max());
+		const auto rounded = std::round(value);
+		if (rounded >= kMax)
+		{
+			return std::numeric_limits<ValueType>::max();
+		}
+		return rounded <= kMin ? std::numeric_limits<ValueType>::min() : ValueType(rounded);
+	}
+	else if constexpr (std::floating_point<ValueType>)
+	{
+		return ValueType(value);
+	}
+	else
+	{
+		// Format strings with a fixed number of decimals
+		char buffer[32];
+		const auto length = std::snprintf(buffer, sizeof(buffer), "%.3f", value);
+		return ValueType(std::string_view(buffer, std::size_t(std::clamp(length, 0, int(sizeof(buffer)) - 1))));
 	}
 }
 
 template <typename ValueType>
-auto TemplateInputHandler<ValueType>::doRead(std::chrono::system_clock::time_point timeStamp) -> void
+auto TemplateInputHandler<ValueType>::doRead() -> ValueType
 {
+	// Use the simulation or the replay file instead of the I/O component, if requested
+	if (_simulator)
+	{
+		return doSimulatedRead();
+	}
+	if (_replayer)
+	{
+		return doReplayedRead();
+	}
+
+	// Extract the value from the packed word, if it is mapped to a bit
+	if constexpr (std::same_as<ValueType, bool>)
+	{
+		if (_packedWord)
+		{
+			return _packedWord->bit(_bit);
+		}
+	}
+
 	/// @todo read the value
 	ValueType value = {};
 
 	/// @todo if the read function does not throw errors, but uses return types or internal handle state,
-	// throw an std::system_error here on failure, or call _state.update() directly.
+	// throw an std::system_error here on failure.
 
-	// The read was successful
-	_state.update(timeStamp, value);
+	return value;
 
 	/// @todo it may be advantageous to split this function up according to value type, either using explicit 
 	/// template specialization, or using if constexpr().
@@ -55,19 +301,23 @@ auto TemplateInputHandler<ValueType>::doRead(std::chrono::system_clock::time_poi
 	// 
 	// if constexpr (std::same_as<ValueType, bool>)
 	// {
-	//     doReadBoolean(timeStamp);
+	//     return doReadBoolean();
 	// }
 	// else if constexpr (utils::Tools::Integral<ValueType>)
 	// {
-	//     doReadInteger(timeStamp);
+	//     return doReadInteger();
 	// }
 	// else if constexpr (std::floating_point<ValueType>)
 	// {
-	//     doReadFloatingPoint(timeStamp);
+	//     return doReadFloatingPoint();
 	// }
 	// else if constexpr (utils::tools::StringType<ValueType>)
 	// {
-	//     doReadString(timeStamp);
+	//     return doReadString();
+	// }
+	// else if constexpr (FixedStringType<ValueType>)
+	// {
+	//     return doReadFixedString();
 	// }
 	// 
 	// To determine if a type is an integer type, you should use xentara::utils::Tools::Integral instead of std::integral,
@@ -92,7 +342,7 @@ constexpr auto TemplateInputHandler<ValueType>::staticDataType() -> const data::
 	{
 	    return data::DataType::kFloatingPoint;
 	}
-	else if constexpr (utils::tools::StringType<ValueType>)
+	else if constexpr (utils::tools::StringType<ValueType> || FixedStringType<ValueType>)
 	{
 	    return data::DataType::kString;
 	}
@@ -119,7 +369,10 @@ auto TemplateInputHandler<ValueType>::forEachAttribute(const model::ForEachAttri
 		function(kValueAttribute) ||
 
 		// Handle the state attributes
-		_state.forEachAttribute(function);
+		_state.forEachAttribute(function) ||
+
+		// Handle the aggregate attributes, if we are oversampling
+		forEachOversamplingAttribute(function);
 }
 
 template <typename ValueType>
@@ -133,26 +386,145 @@ auto TemplateInputHandler<ValueType>::forEachEvent(const model::ForEachEventFunc
 template <typename ValueType>
 auto TemplateInputHandler<ValueType>::makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>
 {
-	// Handle the value attribute separately
-	if (attribute == kValueAttribute)
+	// Handle the value attribute
+	if (&attribute == &kValueAttribute)
 	{
 		return _state.valueReadHandle();
 	}
-	
+
 	// Handle the state attributes
 	if (auto handle = _state.makeReadHandle(attribute))
 	{
 		return handle;
 	}
 
+	// Handle the aggregate attributes, if we are oversampling
+	if constexpr (kOversamplingSupported)
+	{
+		if (_oversampler)
+		{
+			return _oversampler->makeReadHandle(attribute);
+		}
+	}
+
 	return std::nullopt;
 }
 
+template <typename ValueType>
+auto TemplateInputHandler<ValueType>::enableHistory(std::size_t capacity) -> bool
+{
+	if constexpr (SampleHistory<ValueType>::kSupported)
+	{
+		_history = std::make_unique<SampleHistory<ValueType>>(capacity);
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
+template <typename ValueType>
+auto TemplateInputHandler<ValueType>::enableOversampling() -> bool
+{
+	if constexpr (kOversamplingSupported)
+	{
+		_oversampler = std::make_unique<Oversampler<ValueType>>();
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
+template <typename ValueType>
+auto TemplateInputHandler<ValueType>::snapshotSize() const noexcept -> std::size_t
+{
+	// Only values with a fixed size can be stored in a snapshot
+	if constexpr (std::is_trivially_copyable_v<ValueType>)
+	{
+		return Snapshot::recordSize<ValueType>();
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+template <typename ValueType>
+auto TemplateInputHandler<ValueType>::attachSnapshot(std::span<std::byte> record, bool restore) -> void
+{
+	if constexpr (std::is_trivially_copyable_v<ValueType>)
+	{
+		_snapshotRecord = record;
+
+		// Restore the last known value, if requested
+		if (restore)
+		{
+			if (auto snapshot = Snapshot::load<ValueType>(record))
+			{
+				// Mark the value as stale until it is read for the first time
+				_state.updateUnconfirmed(snapshot->first, snapshot->second, data::Quality::Unreliable, CustomError::StaleValue);
+			}
+		}
+	}
+}
+
+template <typename ValueType>
+auto TemplateInputHandler<ValueType>::forEachOversamplingAttribute(const model::ForEachAttributeFunction &function) const -> bool
+{
+	if constexpr (kOversamplingSupported)
+	{
+		if (_oversampler)
+		{
+			return _oversampler->forEachAttribute(function);
+		}
+	}
+
+	return false;
+}
+
 template <typename ValueType>
 auto TemplateInputHandler<ValueType>::realize() -> void
 {
 	// Realize the state object
 	_state.realize();
+
+	// Realize the oversampler
+	if constexpr (kOversamplingSupported)
+	{
+		if (_oversampler)
+		{
+			_oversampler->realize();
+		}
+	}
+}
+
+template <typename ValueType>
+auto TemplateInputHandler<ValueType>::footprint() const noexcept -> MemoryFootprint
+{
+	MemoryFootprint footprint { ._handler = sizeof(*this) };
+
+	// Add the state
+	_state.addFootprint(footprint);
+
+	// Add the history
+	if (_history)
+	{
+		footprint._handler += _history->memoryUsage();
+	}
+
+	// Add the oversampler
+	if constexpr (kOversamplingSupported)
+	{
+		if (_oversampler)
+		{
+			_oversampler->addFootprint(footprint);
+		}
+	}
+
+	return footprint;
 }
 
 /// @class xentara::plugins::templateDriver::TemplateInputHandler
@@ -169,5 +541,6 @@ template class TemplateInputHandler<std::int64_t>;
 template class TemplateInputHandler<float>;
 template class TemplateInputHandler<double>;
 template class TemplateInputHandler<std::string>;
+template class TemplateInputHandler<InlineString>;
 
 } // namespace xentara::plugins::templateDriver
\ No newline at end of file
@@ -2,11 +2,20 @@
 #pragma once
 
 #include "AbstractTemplateInputHandler.hpp"
+#include "FixedString.hpp"
+#include "Oversampler.hpp"
 #include "ReadState.hpp"
+#include "SampleHistory.hpp"
 
 #include <xentara/model/Attribute.hpp>
+#include <xentara/utils/eh/expected.hpp>
+#include <xentara/utils/tools/Concepts.hpp>
 
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <system_error>
 
 namespace xentara::plugins::templateDriver
 {
@@ -35,30 +44,132 @@ public:
 
 	auto makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle> final;
 
+	auto valueReadHandle() const noexcept -> data::ReadHandle final
+	{
+		return _state.valueReadHandle();
+	}
+
+	auto enableHistory(std::size_t capacity) -> bool final;
+
+	auto enableOversampling() -> bool final;
+
+	auto mapBit(PackedWord &word, unsigned bit) -> bool final;
+
+	auto snapshotSize() const noexcept -> std::size_t final;
+
+	auto attachSnapshot(std::span<std::byte> record, bool restore) -> void final;
+
+	auto setRuntimeCounters(RuntimeCounters &counters) -> void final
+	{
+		_counters = &counters;
+	}
+
+	auto simulate(Simulator &simulator, const SimulatedSignal &signal) -> void final;
+
+	auto replay(Replayer &replayer, std::size_t point) -> void final
+	{
+		_replayer = &replayer;
+		_replayPoint = point;
+	}
+
 	auto realize() -> void final;
+
+	auto footprint() const noexcept -> MemoryFootprint final;
 		
-	auto read(std::chrono::system_clock::time_point timeStamp) -> void final;
+	auto read(std::chrono::system_clock::time_point timeStamp, const AcquisitionClock &clock) -> void final;
+
+	auto acquire(const AcquisitionClock &clock) -> void final;
+
+	auto publish(std::chrono::system_clock::time_point timeStamp) -> void final;
+
+	auto sample(const AcquisitionClock &clock) -> void final;
 
 	auto invalidateData(std::chrono::system_clock::time_point timeStamp) -> void final;
 	
 	///@}
 
+	/// @brief Returns the sample history
+	/// @return The sample history, or nullptr if no sample history was configured
+	auto history() const noexcept -> const SampleHistory<ValueType> *
+	{
+		return _history.get();
+	}
+
 	/// @brief A Xentara attribute containing the current value.
 	/// @note This is a member of this class rather than of the attributes namespace, because the access flags
 	/// and type may differ from class to class
 	static const model::Attribute kValueAttribute;
 
 private:
-	/// @brief The actual implementation of read(), which may throw exceptions on error.
-	auto doRead(std::chrono::system_clock::time_point timeStamp) -> void;
+	/// @brief Whether the value type supports oversampling
+	static constexpr bool kOversamplingSupported = utils::tools::Integral<ValueType> || std::floating_point<ValueType>;
+
+	/// @brief Increments a runtime counter, if counters were set
+	auto count(RuntimeCounters::Counter counter) noexcept -> void
+	{
+		if (_counters)
+		{
+			_counters->increment(counter);
+		}
+	}
+
+	/// @brief Reads the value from the I/O component, throwing an exception on error.
+	auto doRead() -> ValueType;
+	/// @brief Generates the value from the simulated signal, throwing an exception on injected errors.
+	auto doSimulatedRead() -> ValueType;
+	/// @brief Takes the value from the replay file, throwing an exception if no value has been replayed yet.
+	auto doReplayedRead() -> ValueType;
+	/// @brief Checks whether the value is taken from a packed word that must be read by the handler itself
+	auto readsPackedWord() const noexcept -> bool
+	{
+		return _packedWord && !_simulator && !_replayer;
+	}
+	/// @brief Records a sample in the history, if there is one
+	auto recordHistory(std::chrono::system_clock::time_point timeStamp,
+		const utils::eh::expected<ValueType, std::error_code> &valueOrError) noexcept -> void;
+
+	/// @brief Converts a simulated or replayed number to the value type
+	static auto fromNumber(double value) -> ValueType;
+
+	/// @brief Iterates over the aggregate attributes, if oversampling is enabled
+	auto forEachOversamplingAttribute(const model::ForEachAttributeFunction &function) const -> bool;
 
 	/// @brief Determines the correct data type based on the *ValueType* template parameter
 	///
 	/// This function returns the same value as dataType(), but is static and constexpr.
 	static constexpr auto staticDataType() -> const data::DataType &;
 
+	/// @brief The counters for the reads, or nullptr if none were set
+	RuntimeCounters *_counters { nullptr };
+
 	/// @brief The state
 	ReadState<ValueType> _state;
+	/// @brief The value or error acquired using acquire() that has not been published yet, or std::nullopt if there is none
+	std::optional<utils::eh::expected<ValueType, std::error_code>> _acquiredValue;
+	/// @brief The acquisition time stamp of _acquiredValue, or std::nullopt if acquisition time stamps are disabled
+	std::optional<std::chrono::system_clock::time_point> _acquisitionTime;
+
+	/// @brief The history of the most recent samples, or nullptr if no history was configured
+	std::unique_ptr<SampleHistory<ValueType>> _history;
+	/// @brief The oversampler, or nullptr if oversampling is disabled
+	std::unique_ptr<Oversampler<ValueType>> _oversampler;
+	/// @brief The snapshot record the published values are stored in, or an empty span if there is none
+	std::span<std::byte> _snapshotRecord;
+
+	/// @brief The simulator, or nullptr if the value is read from the I/O component
+	Simulator *_simulator { nullptr };
+	/// @brief The simulated signal
+	SimulatedSignal _signal;
+
+	/// @brief The replayer, or nullptr if the value is not replayed
+	Replayer *_replayer { nullptr };
+	/// @brief The point in the replay file the value is taken from
+	std::size_t _replayPoint { 0 };
+
+	/// @brief The word the value is mapped to a bit of, or nullptr if the value is read by itself
+	PackedWord *_packedWord { nullptr };
+	/// @brief The index of the bit within _packedWord
+	unsigned _bit { 0 };
 };
 
 /// @class xentara::plugins::templateDriver::TemplateInputHandler
@@ -75,5 +186,6 @@ extern template class TemplateInputHandler<std::int64_t>;
 extern template class TemplateInputHandler<float>;
 extern template class TemplateInputHandler<double>;
 extern template class TemplateInputHandler<std::string>;
+extern template class TemplateInputHandler<InlineString>;
 
 } // namespace xentara::plugins::templateDriver
\ No newline at end of file
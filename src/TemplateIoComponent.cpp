@@ -1,7 +1,10 @@
 // Copyright (c) embedded ocean GmbH
 #include "TemplateIoComponent.hpp"
 
+#include "AbstractTemplateOutputHandler.hpp"
 #include "Attributes.hpp"
+#include "LoadCache.hpp"
+#include "Tasks.hpp"
 #include "TemplateInput.hpp"
 #include "TemplateOutput.hpp"
 
@@ -9,24 +12,305 @@
 #include <xentara/data/ReadHandle.hpp>
 #include <xentara/model/Attribute.hpp>
 #include <xentara/model/ForEachAttributeFunction.hpp>
+#include <xentara/model/ForEachTaskFunction.hpp>
+#include <xentara/process/ExecutionContext.hpp>
 #include <xentara/skill/ElementFactory.hpp>
+#include <xentara/utils/eh/currentErrorCode.hpp>
+#include <xentara/utils/json/decoder/Array.hpp>
 #include <xentara/utils/json/decoder/Object.hpp>
 #include <xentara/utils/json/decoder/Errors.hpp>
 
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <numeric>
+#include <string>
 #include <string_view>
+#include <unordered_set>
+#include <utility>
 
 namespace xentara::plugins::templateDriver
 {
 
 using namespace std::literals;
 
+namespace
+{
+
+	/// @brief The name of the I/O component in trace files
+	/// @todo replace "template I/O component" with a more descriptive name
+	constexpr auto kTraceName = "template I/O component"sv;
+
+	/// @brief The maximum number of executions of the read task over which the poll load is balanced
+	constexpr std::size_t kMaxPollCycle = 4096;
+
+} // namespace
+
 auto TemplateIoComponent::load(utils::json::decoder::Object &jsonObject, config::Context &context) -> void
 {
 	// Go through all the members of the JSON object that represents this object
 	for (auto && [name, value] : jsonObject)
     {
+		if (name == "parallelIo"sv)
+		{
+			_parallelIo = value.asBool();
+		}
+		else if (name == "componentTasks"sv)
+		{
+			_componentTasks = value.asBool();
+		}
+		else if (name == "backend"sv)
+		{
+			// Get the keyword from the value
+			const auto keyword = value.asString<std::string>();
+			if (keyword == "device"sv)
+			{
+				_simulator.setEnabled(false);
+				_replayer.setEnabled(false);
+			}
+			else if (keyword == "simulation"sv)
+			{
+				_simulator.setEnabled(true);
+				_replayer.setEnabled(false);
+			}
+			else if (keyword == "replay"sv)
+			{
+				_simulator.setEnabled(false);
+				_replayer.setEnabled(true);
+			}
+			else
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("unknown backend in template I/O component"));
+			}
+		}
+		else if (name == "replayFile"sv)
+		{
+			_replayer.setPath(value.asString<std::string>());
+
+			// Check that the value is valid
+			if (_replayer.path().empty())
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("replay file of template I/O component must not be empty"));
+			}
+		}
+		else if (name == "replaySpeed"sv)
+		{
+			const auto replaySpeed = value.asNumber<double>();
+
+			// Check that the value is valid
+			if (!(replaySpeed >= 0))
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("replay speed of template I/O component must not be negative"));
+			}
+
+			_replayer.setSpeed(replaySpeed);
+		}
+		else if (name == "replayLoop"sv)
+		{
+			_replayer.setLoop(value.asBool());
+		}
+		else if (name == "simulationSeed"sv)
+		{
+			_simulator.setSeed(value.asNumber<std::uint64_t>());
+		}
+		else if (name == "simulatedWriteLatency"sv)
+		{
+			_simulator.setWriteLatency(std::chrono::microseconds(value.asNumber<std::uint32_t>()));
+		}
+		else if (name == "simulatedErrorRate"sv)
+		{
+			const auto errorRate = value.asNumber<double>();
+
+			// Check that the value is valid
+			if (!(errorRate >= 0 && errorRate <= 1))
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("simulated error rate of template I/O component must be between 0 and 1"));
+			}
+
+			_simulator.setErrorRate(errorRate);
+		}
+		else if (name == "inputGroups"sv)
+		{
+			for (auto &&element : value.asArray())
+			{
+				auto group = std::make_unique<InputGroup>();
+				group->load(element.asObject());
+				_groupedInputCount += group->size();
+				_inputGroups.push_back(std::move(group));
+			}
+		}
+		else if (name == "loadCacheFile"sv)
+		{
+			_loadCachePath = value.asString<std::string>();
+
+			// Check that the value is valid
+			if (_loadCachePath.empty())
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("load cache file of template I/O component must not be empty"));
+			}
+		}
+		else if (name == "compactDataPoints"sv)
+		{
+			_compactDataPoints = value.asBool();
+		}
+		else if (name == "timeStamps"sv)
+		{
+			// Get the keyword from the value
+			const auto keyword = value.asString<std::string>();
+			if (keyword == "scheduled"sv)
+			{
+				_acquisitionClock.setEnabled(false);
+			}
+			else if (keyword == "acquisition"sv)
+			{
+				_acquisitionClock.setEnabled(true);
+			}
+			else
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("unknown time stamp mode in template I/O component"));
+			}
+		}
+		else if (name == "ioCpus"sv)
+		{
+			try
+			{
+				_ioThreadPlacement.setCpus(value.asString<std::string>());
+			}
+			catch (const std::runtime_error &error)
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("invalid I/O thread CPUs for template I/O component: "s + error.what()));
+			}
+		}
+		else if (name == "ioSchedulingPolicy"sv)
+		{
+			try
+			{
+				_ioThreadPlacement.setPolicy(value.asString<std::string>());
+			}
+			catch (const std::runtime_error &error)
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("invalid I/O thread scheduling policy for template I/O component: "s + error.what()));
+			}
+		}
+		else if (name == "ioPriority"sv)
+		{
+			_ioThreadPlacement.setPriority(value.asNumber<int>());
+		}
+		else if (name == "maxWriteSize"sv)
+		{
+			_maxWriteSize = value.asNumber<std::size_t>();
+
+			// Check that the value is valid
+			if (_maxWriteSize == 0)
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("maximum write size of template I/O component must not be 0"));
+			}
+		}
+		else if (name == "maxWriteRate"sv)
+		{
+			const auto maxWriteRate = value.asNumber<double>();
+
+			// Check that the value is valid
+			if (!(maxWriteRate > 0))
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("maximum write rate of template I/O component must be positive"));
+			}
+
+			_writeRateLimiter.setRate(maxWriteRate);
+		}
+		else if (name == "writeBurst"sv)
+		{
+			const auto writeBurst = value.asNumber<double>();
+
+			// Check that the value is valid
+			if (!(writeBurst >= 1))
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("write burst of template I/O component must be at least 1"));
+			}
+
+			_writeRateLimiter.setBurst(writeBurst);
+		}
+		else if (name == "sampleRate"sv)
+		{
+			const auto sampleRate = value.asNumber<double>();
+
+			// Check that the value is valid
+			if (!(sampleRate > 0))
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("sample rate of template I/O component must be positive"));
+			}
+
+			_sampleInterval = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(1.0 / sampleRate));
+		}
+		else if (name == "snapshotFile"sv)
+		{
+			_snapshotPath = value.asString<std::string>();
+
+			// Check that the value is valid
+			if (_snapshotPath.empty())
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("snapshot file of template I/O component must not be empty"));
+			}
+		}
+		else if (name == "snapshotInterval"sv)
+		{
+			_snapshotInterval = std::chrono::milliseconds(value.asNumber<std::uint32_t>());
+
+			// Check that the value is valid
+			if (_snapshotInterval == 0ms)
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("snapshot interval of template I/O component must not be 0"));
+			}
+		}
+		else if (name == "traceFile"sv)
+		{
+			_tracePath = value.asString<std::string>();
+
+			// Check that the value is valid
+			if (_tracePath.empty())
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("trace file of template I/O component must not be empty"));
+			}
+		}
+		else if (name == "traceFlushInterval"sv)
+		{
+			_traceFlushInterval = std::chrono::milliseconds(value.asNumber<std::uint32_t>());
+
+			// Check that the value is valid
+			if (_traceFlushInterval == 0ms)
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("trace flush interval of template I/O component must not be 0"));
+			}
+		}
+		else if (name == "initialReadJobs"sv)
+		{
+			_initialReadJobCount = value.asNumber<std::size_t>();
+
+			// Check that the value is valid
+			if (_initialReadJobCount == 0)
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("number of initial read jobs of template I/O component must not be 0"));
+			}
+		}
 		/// @todo load configuration parameters
-		if (name == "TODO"sv)
+		else if (name == "TODO"sv)
 		{
 			/// @todo parse the value correctly
 			auto todo = value.asNumber<std::uint64_t>();
@@ -46,6 +330,28 @@ auto TemplateIoComponent::load(utils::json::decoder::Object &jsonObject, config:
 		}
     }
 
+	// Check that there is a file to replay
+	if (_replayer.enabled() && _replayer.path().empty())
+	{
+		/// @todo replace "template I/O component" with a more descriptive name
+		utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("missing replay file in template I/O component"));
+	}
+
+	// Create the inputs of the input groups. This can only be done once everything is loaded, because the names of the
+	// inputs are checked against our own attributes, some of which depend on the configuration.
+	expandInputGroups(jsonObject);
+
+	// Check that the scheduling priority matches the policy
+	try
+	{
+		_ioThreadPlacement.validate();
+	}
+	catch (const std::runtime_error &error)
+	{
+		/// @todo replace "template I/O component" with a more descriptive name
+		utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("invalid I/O thread configuration for template I/O component: "s + error.what()));
+	}
+
 	/// @todo perform consistency and completeness checks
 	if (!"TODO")
 	{
@@ -54,16 +360,101 @@ auto TemplateIoComponent::load(utils::json::decoder::Object &jsonObject, config:
 	}
 }
 
+auto TemplateIoComponent::expandInputGroups(const utils::json::decoder::Object &jsonObject) -> void
+{
+	if (_inputGroups.empty())
+	{
+		return;
+	}
+
+	// The names and UUIDs of the inputs depend on our UUID and the parameters of the groups. Whether the names are
+	// valid also depends on the names of our own attributes.
+	auto key = Snapshot::hash(std::as_bytes(std::span(&LoadCache::kVersion, 1)));
+	key = Snapshot::hash(std::as_bytes(std::span(&uuid(), 1)), key);
+	for (auto &&group : _inputGroups)
+	{
+		key = group->hash(key);
+	}
+	forEachComponentAttribute([&](const model::Attribute &attribute)
+	{
+		key = Snapshot::hash(attribute.name(), key);
+		return false;
+	});
+
+	// Take the inputs from the cache if it is up to date. The names in the cache have already been checked.
+	LoadCache cache;
+	if (!_loadCachePath.empty() && cache.read(_loadCachePath, key) && cache.inputs().size() == _groupedInputCount)
+	{
+		auto inputs = cache.inputs();
+		for (auto &&group : _inputGroups)
+		{
+			group->expand(inputs.first(group->size()));
+			inputs = inputs.subspan(group->size());
+		}
+	}
+	else
+	{
+		// Generate the inputs and make sure that the names are unique
+		std::unordered_set<std::string_view> groupedInputNames;
+		groupedInputNames.reserve(_groupedInputCount);
+		for (auto &&group : _inputGroups)
+		{
+			group->expand(uuid(), cache);
+			for (std::size_t index = 0; index < group->size(); ++index)
+			{
+				if (!groupedInputNames.insert(group->name(index)).second)
+				{
+					/// @todo replace "template I/O component" with a more descriptive name
+					utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("duplicate input name \""s +
+						std::string(group->name(index)) + "\" in input groups of template I/O component"));
+				}
+			}
+		}
+
+		// Make sure that the inputs don't have the same name as one of our own attributes
+		forEachComponentAttribute([&](const model::Attribute &attribute)
+		{
+			if (groupedInputNames.contains(attribute.name()))
+			{
+				/// @todo replace "template I/O component" with a more descriptive name
+				utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("the input name \""s +
+					std::string(attribute.name()) + "\" in input groups of template I/O component is already used by an attribute"));
+			}
+			return false;
+		});
+
+		// Write the cache for the next start
+		if (!_loadCachePath.empty())
+		{
+			cache.write(_loadCachePath, key);
+		}
+	}
+
+	// Add the counters of the inputs to our totals
+	for (auto &&group : _inputGroups)
+	{
+		group->setRuntimeCounters(_runtimeCounters);
+	}
+}
+
 auto TemplateIoComponent::createChildElement(const skill::Element::Class &elementClass, skill::ElementFactory &factory)
 	-> std::shared_ptr<skill::Element>
 {
 	if (&elementClass == &TemplateInput::Class::instance())
 	{
-		return factory.makeShared<TemplateInput>(*this);
+		auto input = factory.makeShared<TemplateInput>(*this);
+		input->_traceName = "input " + std::to_string(_inputs.size());
+		_inputs.push_back(*input);
+		return input;
 	}
 	else if (&elementClass == &TemplateOutput::Class::instance())
 	{
-		return factory.makeShared<TemplateOutput>(*this);
+		auto output = factory.makeShared<TemplateOutput>(*this);
+		output->_traceName = "output " + std::to_string(_outputs.size());
+		_outputs.push_back(*output);
+		// Register the output with the write planner
+		_writePlanner.addOutput(*output);
+		return output;
 	}
 
 	/// @todo add any other supported child element types
@@ -73,27 +464,759 @@ auto TemplateIoComponent::createChildElement(const skill::Element::Class &elemen
 
 auto TemplateIoComponent::forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool
 {
+	// Handle our own attributes
+	if (forEachComponentAttribute(function))
+	{
+		return true;
+	}
+
+	// Handle the values of the inputs in input groups
+	for (auto &&group : _inputGroups)
+	{
+		if (group->forEachAttribute(function))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+auto TemplateIoComponent::forEachComponentAttribute(const model::ForEachAttributeFunction &function) const -> bool
+{
+	// Handle the rate limiter attributes, if there is a rate limit
+	if (_writeRateLimiter && _writeRateLimiter.forEachAttribute(function))
+	{
+		return true;
+	}
+
+	// Handle the write planner attributes
+	if (_writePlanner.forEachAttribute(function))
+	{
+		return true;
+	}
+
+	// Handle the runtime counters
+	if (_totalCounters.forEachAttribute(function))
+	{
+		return true;
+	}
+
+	// Handle the memory report attributes
+	if (_memoryReport.forEachAttribute(function))
+	{
+		return true;
+	}
+
 	/// @todo call the function with any attributes this class supports
 
 	return false;
 }
 
+auto TemplateIoComponent::forEachTask(const model::ForEachTaskFunction &function) -> bool
+{
+	// Handle all the tasks we support
+	return
+		function(tasks::kRead, sharedFromThis(&_readTask)) ||
+		function(tasks::kWrite, sharedFromThis(&_writeTask)) ||
+		function(tasks::kDispatch, sharedFromThis(&_dispatchTask)) ||
+		function(tasks::kCollect, sharedFromThis(&_collectTask));
+
+	/// @todo handle any additional tasks this class supports
+}
+
 auto TemplateIoComponent::makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>
 {
-	/// @todo create read handles for any readable attributes this class supports
+	// Handle the rate limiter attributes, if there is a rate limit
+	if (_writeRateLimiter)
+	{
+		if (auto handle = _writeRateLimiter.makeReadHandle(attribute))
+		{
+			return handle;
+		}
+	}
+
+	// Handle the write planner attributes
+	if (auto handle = _writePlanner.makeReadHandle(attribute))
+	{
+		return handle;
+	}
+
+	// Handle the runtime counters
+	if (auto handle = _totalCounters.makeReadHandle(attribute))
+	{
+		return handle;
+	}
+
+	// Handle the memory report attributes
+	if (auto handle = _memoryReport.makeReadHandle(attribute))
+	{
+		return handle;
+	}
+
+	// Handle the values of the inputs in input groups
+	for (auto &&group : _inputGroups)
+	{
+		if (auto handle = group->makeReadHandle(attribute))
+		{
+			return handle;
+		}
+	}
+
+	/// @todo handle any additional readable attributes this class supports
 
-	// Nothing found
 	return std::nullopt;
 }
 
+auto TemplateIoComponent::allocatePollPhase(std::uint32_t divider) -> std::uint32_t
+{
+	// Extend the cycle covered by the load table to a multiple of the new divider. The cycle is not extended beyond
+	// kMaxPollCycle executions, which only makes the balancing approximate for unusual combinations of dividers.
+	const auto cycle = _pollLoad.size();
+	const auto extendedCycle = std::lcm(cycle, std::size_t(divider));
+	if (extendedCycle > cycle && extendedCycle <= kMaxPollCycle)
+	{
+		_pollLoad.resize(extendedCycle);
+		for (auto execution = cycle; execution < extendedCycle; ++execution)
+		{
+			_pollLoad[execution] = _pollLoad[execution - cycle];
+		}
+	}
+
+	// Calls the callback for each execution of the cycle in which a data point with the given phase is polled
+	const auto pollsPerCycle = std::max<std::size_t>(_pollLoad.size() / divider, 1);
+	const auto forEachPoll = [&](std::uint32_t phase, auto &&callback)
+	{
+		for (std::size_t poll = 0; poll < pollsPerCycle; ++poll)
+		{
+			callback(_pollLoad[(phase + poll * divider) % _pollLoad.size()]);
+		}
+	};
+
+	// Only the phases up to the length of the cycle need to be considered. If the divider is longer than the cycle, the
+	// later phases map to the same executions as the earlier ones, so the scan never covers more than kMaxPollCycle
+	// phases, however large the divider.
+	const auto phaseCount = std::uint32_t(std::min<std::size_t>(divider, _pollLoad.size()));
+
+	// Choose the phase whose busiest execution is the least busy, preferring the one with the fewest polls overall
+	std::uint32_t bestPhase = 0;
+	auto bestLoad = std::pair { std::numeric_limits<std::uint32_t>::max(), std::numeric_limits<std::uint64_t>::max() };
+	for (std::uint32_t phase = 0; phase < phaseCount; ++phase)
+	{
+		std::pair<std::uint32_t, std::uint64_t> load;
+		forEachPoll(phase, [&](std::uint32_t executionLoad)
+		{
+			load.first = std::max(load.first, executionLoad);
+			load.second += executionLoad;
+		});
+		if (load < bestLoad)
+		{
+			bestPhase = phase;
+			bestLoad = load;
+		}
+	}
+
+	// Account for the polls of the new data point
+	forEachPoll(bestPhase, [](std::uint32_t &executionLoad) { ++executionLoad; });
+
+	return bestPhase;
+}
+
+auto TemplateIoComponent::writeBlock(std::uint64_t address, std::span<const std::byte> data) -> void
+{
+	// The outputs echo the values themselves once the block has been written, so the simulation only needs to
+	// simulate the transaction
+	if (_simulator.enabled() || _replayer.enabled())
+	{
+		_simulator.write();
+		return;
+	}
+
+	/// @todo write the data to the I/O component
+
+	/// @todo if the write function does not throw errors, but uses return types or internal handle state,
+	// throw an std::system_error here on failure.
+}
+
+auto TemplateIoComponent::readWord(std::uint64_t address) -> std::uint64_t
+{
+	// Bit-mapped data points take their values from the simulation or the replay file themselves
+	if (_simulator.enabled() || _replayer.enabled())
+	{
+		_simulator.read();
+		return 0;
+	}
+
+	/// @todo read the word from the I/O component
+	std::uint64_t word = 0;
+
+	/// @todo if the read function does not throw errors, but uses return types or internal handle state,
+	// throw an std::system_error here on failure.
+
+	return word;
+}
+
+auto TemplateIoComponent::modifyWord(std::uint64_t address, std::uint64_t mask, std::uint64_t bits) -> void
+{
+	// The outputs echo the values themselves once the word has been written, so the simulation only needs to
+	// simulate the transaction
+	if (_simulator.enabled() || _replayer.enabled())
+	{
+		_simulator.write();
+		return;
+	}
+
+	/// @todo if the I/O component supports masked writes, write only the bits in the mask instead
+
+	/// @todo read the word from the I/O component
+	std::uint64_t word = 0;
+
+	word = (word & ~mask) | (bits & mask);
+
+	/// @todo write the word back to the I/O component
+
+	/// @todo if the read and write functions do not throw errors, but use return types or internal handle state,
+	// throw an std::system_error here on failure.
+}
+
+auto TemplateIoComponent::packedWord(std::uint64_t address) -> PackedWord &
+{
+	// Reuse the word if another data point is already mapped to it
+	const auto [entry, inserted] = _packedWordIndices.try_emplace(address, _packedWords.size());
+	if (inserted)
+	{
+		_packedWords.emplace_back(*this, address);
+	}
+	return _packedWords[entry->second];
+}
+
+auto TemplateIoComponent::performReadTask(const process::ExecutionContext &context) -> void
+{
+	TraceSpan span(_activeTracer, "task"sv, "read"sv, kTraceName);
+
+	// Read all the values and publish them right away
+	acquireAll();
+	publishAll(context.scheduledTime(), _componentTasks);
+
+	// Update the totals of the counters
+	updateTotalCounters();
+}
+
+auto TemplateIoComponent::updateTotalCounters() noexcept -> void
+{
+	// Add up the counters of the data points here, once per cycle, instead of having every data point increment our
+	// counters as well, so that the data points never contend on the counters of the I/O component.
+	auto totals = _runtimeCounters.values();
+	for (auto &&input : _inputs)
+	{
+		input.get()._runtimeCounters.addTo(totals);
+	}
+	for (auto &&output : _outputs)
+	{
+		output.get()._runtimeCounters.addTo(totals);
+	}
+	_totalCounters.store(totals);
+}
+
+auto TemplateIoComponent::performInitialRead(const process::ExecutionContext &context) -> process::Task::Status
+{
+	std::scoped_lock lock { _initialReadMutex };
+
+	switch (_initialReadState)
+	{
+	case InitialReadState::Idle:
+		// Read the packed words up front, so that the jobs can extract the bits of the data points mapped to them
+		refreshPackedWords();
+
+		// Do the whole read right here if there is nothing to run in parallel
+		if (!initialReadUsesWorkers())
+		{
+			for (auto &&job : _initialReadJobs)
+			{
+				job->run();
+			}
+			publishAll(context.scheduledTime(), true);
+			_initialReadState = InitialReadState::Done;
+			return process::Task::Status::Ready;
+		}
+
+		// Start the jobs. The worker pool must be running while they execute.
+		workerPool().addUser();
+		for (auto &&job : _initialReadJobs)
+		{
+			workerPool().submit(*job);
+		}
+		_initialReadState = InitialReadState::Running;
+		return process::Task::Status::Pending;
+
+	case InitialReadState::Running:
+		// Keep waiting until all the jobs have finished
+		if (!std::ranges::all_of(_initialReadJobs, [](const auto &job) { return job->done(); }))
+		{
+			return process::Task::Status::Pending;
+		}
+
+		// Publish all the values at once
+		publishAll(context.scheduledTime(), true);
+		workerPool().removeUser();
+		_initialReadState = InitialReadState::Done;
+		return process::Task::Status::Ready;
+
+	case InitialReadState::Done:
+	default:
+		return process::Task::Status::Ready;
+	}
+}
+
+auto TemplateIoComponent::resetInitialRead() -> void
+{
+	std::scoped_lock lock { _initialReadMutex };
+
+	// Wait for any jobs that are still running. The initial read can only be running if it used the worker pool.
+	if (_initialReadState == InitialReadState::Running)
+	{
+		for (auto &&job : _initialReadJobs)
+		{
+			job->wait();
+		}
+		workerPool().removeUser();
+	}
+
+	_initialReadState = InitialReadState::Idle;
+}
+
+auto TemplateIoComponent::invalidateData(std::chrono::system_clock::time_point timeStamp) -> void
+{
+	// Perform the initial read again if we go operational again
+	resetInitialRead();
+
+	for (auto &&input : _inputs)
+	{
+		input.get().invalidateData(timeStamp);
+	}
+	for (auto &&output : _outputs)
+	{
+		output.get().invalidateData(timeStamp);
+	}
+	for (auto &&group : _inputGroups)
+	{
+		group->invalidateData(timeStamp);
+	}
+}
+
+auto TemplateIoComponent::performWriteTask(const process::ExecutionContext &context) -> void
+{
+	TraceSpan span(_activeTracer, "task"sv, "write"sv, kTraceName);
+
+	// Write all pending values, unless the outputs write them using their own tasks
+	if (_componentTasks)
+	{
+		_writePlanner.write(context.scheduledTime());
+	}
+}
+
+auto TemplateIoComponent::performDispatchTask(const process::ExecutionContext &context) -> void
+{
+	TraceSpan span(_activeTracer, "task"sv, "dispatch"sv, kTraceName);
+
+	// Make sure the job from the last cycle has finished, in case the "collect" task was not executed
+	_ioJob.wait();
+
+	// Either hand the job to the worker pool, or execute it right here
+	if (usesIoThread())
+	{
+		workerPool().submit(_ioJob);
+	}
+	else
+	{
+		_ioJob.run();
+	}
+}
+
+auto TemplateIoComponent::performCollectTask(const process::ExecutionContext &context) -> void
+{
+	TraceSpan span(_activeTracer, "task"sv, "collect"sv, kTraceName);
+
+	// Wait for the job to finish
+	_ioJob.wait();
+
+	// Publish the results
+	const auto timeStamp = context.scheduledTime();
+	publishAll(timeStamp, _componentTasks);
+	if (_componentTasks)
+	{
+		_writePlanner.commit(timeStamp);
+	}
+}
+
+auto TemplateIoComponent::refreshPackedWords() noexcept -> void
+{
+	// Bit-mapped data points that are simulated or replayed don't use the words
+	if (_simulator.enabled() || _replayer.enabled())
+	{
+		return;
+	}
+
+	for (auto &&word : _packedWords)
+	{
+		TraceSpan span(_activeTracer, "device"sv, "read word"sv, kTraceName);
+		word.refresh();
+	}
+}
+
+auto TemplateIoComponent::acquireAll() -> void
+{
+	// Replay the next values, if the inputs are replayed
+	if (_replayer.enabled())
+	{
+		_replayer.advance();
+	}
+
+	// Read each packed word once, before the data points mapped to it extract their bits
+	refreshPackedWords();
+
+	// Acquire the values of all the inputs and outputs that are due according to their poll divider. The inputs and outputs
+	// are only accessed here if their own tasks leave them to us, because both accessing them would race.
+	if (_componentTasks)
+	{
+		for (auto &&input : _inputs)
+		{
+			if (input.get()._readTask.pollDue())
+			{
+				input.get().acquire();
+			}
+		}
+		for (auto &&output : _outputs)
+		{
+			if (output.get()._readTask.pollDue())
+			{
+				output.get().acquire();
+			}
+		}
+	}
+	for (auto &&group : _inputGroups)
+	{
+		group->acquireAll(_acquisitionClock);
+	}
+}
+
+auto TemplateIoComponent::publishAll(std::chrono::system_clock::time_point timeStamp, bool dataPoints) -> void
+{
+	// Publish all the values. Inputs and outputs that were not acquired will simply ignore this.
+	if (dataPoints)
+	{
+		for (auto &&input : _inputs)
+		{
+			input.get().publish(timeStamp);
+		}
+		for (auto &&output : _outputs)
+		{
+			output.get().publish(timeStamp);
+		}
+	}
+	for (auto &&group : _inputGroups)
+	{
+		group->publish(timeStamp);
+	}
+
+	// Flush the snapshot to disk periodically. The inputs have already stored their values in it.
+	flushSnapshot(timeStamp);
+}
+
+auto TemplateIoComponent::openSnapshot() -> void
+{
+	// Collect the record sizes and the layout
+	std::vector<std::size_t> recordSizes;
+	auto layout = Snapshot::kHashBasis;
+	for (auto &&input : _inputs)
+	{
+		if (const auto size = input.get().snapshotSize())
+		{
+			recordSizes.push_back(size);
+			const auto key = input.get().snapshotKey();
+			layout = Snapshot::hash(std::as_bytes(std::span(&key, 1)), layout);
+		}
+	}
+
+	// Open the file
+	const auto restore = _snapshot.open(_snapshotPath, recordSizes, layout);
+
+	// Attach the records to the inputs
+	std::size_t index = 0;
+	for (auto &&input : _inputs)
+	{
+		if (input.get().snapshotSize())
+		{
+			input.get().attachSnapshot(_snapshot.record(index++), restore);
+		}
+	}
+}
+
+auto TemplateIoComponent::acquireDataPoint(std::size_t index) -> void
+{
+	if (index < _inputs.size())
+	{
+		_inputs[index].get().acquire();
+		return;
+	}
+	index -= _inputs.size();
+
+	if (index < _outputs.size())
+	{
+		_outputs[index].get().acquire();
+		return;
+	}
+	index -= _outputs.size();
+
+	// Find the input group the index belongs to
+	for (auto &&group : _inputGroups)
+	{
+		if (index < group->size())
+		{
+			group->acquire(index, _acquisitionClock);
+			return;
+		}
+		index -= group->size();
+	}
+}
+
+auto TemplateIoComponent::InitialReadJob::execute() noexcept -> void
+{
+	TraceSpan span(_ioComponent.get()._activeTracer, "job"sv, "initial read"sv, kTraceName);
+
+	/// @todo if the I/O component supports block reads, read the data points using as few block reads as possible instead
+
+	for (auto index = _first; index < _last; ++index)
+	{
+		_ioComponent.get().acquireDataPoint(index);
+	}
+}
+
+auto TemplateIoComponent::samplerMain(std::stop_token stopToken) -> void
+{
+	auto nextSample = std::chrono::steady_clock::now();
+	while (!stopToken.stop_requested())
+	{
+		// Sample all the inputs
+		for (auto &&input : _oversampledInputs)
+		{
+			input.get().sample();
+		}
+
+		// Wait for the next sample. If we have fallen behind, we skip the missed samples instead of trying
+		// to catch up.
+		nextSample = std::max(nextSample + _sampleInterval, std::chrono::steady_clock::now());
+		std::this_thread::sleep_until(nextSample);
+	}
+}
+
+auto TemplateIoComponent::IoJob::execute() noexcept -> void
+{
+	auto &ioComponent = _ioComponent.get();
+	TraceSpan span(ioComponent._activeTracer, "job"sv, "I/O"sv, kTraceName);
+
+	// Read the values first, then write the pending values, unless the outputs write them using their own tasks
+	ioComponent.acquireAll();
+	if (ioComponent._componentTasks)
+	{
+		ioComponent._writePlanner.plan();
+		ioComponent._writePlanner.execute();
+	}
+}
+
+auto TemplateIoComponent::realize() -> void
+{
+	// Realize the write planner
+	_writePlanner.realize();
+
+	// Realize the memory report
+	_memoryReport.realize();
+
+	// Realize the inputs in input groups
+	for (auto &&group : _inputGroups)
+	{
+		group->realize();
+	}
+
+	// Realize the rate limiter, if there is a rate limit
+	if (_writeRateLimiter)
+	{
+		_writeRateLimiter.realize();
+	}
+}
+
 auto TemplateIoComponent::prepare() -> void
 {
-	/// @todo open the handle for the I/O device
+	// Attach the inputs and outputs to the simulation, if requested
+	if (_simulator.enabled())
+	{
+		_simulator.start();
+		for (std::size_t index = 0; index < _inputs.size(); ++index)
+		{
+			_inputs[index].get().simulate(_simulator, index);
+		}
+		// The inputs in input groups follow the individual inputs
+		auto groupIndex = _inputs.size();
+		for (auto &&group : _inputGroups)
+		{
+			group->simulate(_simulator, groupIndex);
+			groupIndex += group->size();
+		}
+		for (auto &&output : _outputs)
+		{
+			output.get().simulate(_simulator);
+		}
+	}
+	// Open the replay file, and attach the inputs to it. The outputs echo the written values, like in a simulation.
+	else if (_replayer.enabled())
+	{
+		// The inputs in input groups use the points following the individual inputs
+		std::size_t pointCount = 0;
+		for (std::size_t index = 0; index < _inputs.size(); ++index)
+		{
+			pointCount = std::max(pointCount, _inputs[index].get().replayPoint(index) + 1);
+		}
+		const auto firstGroupPoint = std::max(pointCount, _inputs.size());
+		_replayer.open(firstGroupPoint + _groupedInputCount);
+
+		for (std::size_t index = 0; index < _inputs.size(); ++index)
+		{
+			_inputs[index].get().replay(_replayer, index);
+		}
+		auto groupPoint = firstGroupPoint;
+		for (auto &&group : _inputGroups)
+		{
+			group->replay(_replayer, groupPoint);
+			groupPoint += group->size();
+		}
+		_simulator.start();
+		for (auto &&output : _outputs)
+		{
+			output.get().simulate(_simulator);
+		}
+	}
+	else
+	{
+		/// @todo open the handle for the I/O device
+	}
+
+	// Calibrate the clock for acquisition time stamps
+	if (_acquisitionClock.enabled())
+	{
+		_acquisitionClock.prepare();
+	}
+
+	// Restore the last known values of the inputs, if requested
+	if (!_snapshotPath.empty())
+	{
+		openSnapshot();
+	}
+
+	// Report the memory used by the data points. This is done here, because the events are only created once they have
+	// been resolved by other elements.
+	MemoryFootprint inputFootprint;
+	for (auto &&input : _inputs)
+	{
+		inputFootprint += input.get().footprint();
+	}
+	for (auto &&group : _inputGroups)
+	{
+		inputFootprint += group->footprint();
+	}
+	MemoryFootprint outputFootprint;
+	for (auto &&output : _outputs)
+	{
+		outputFootprint += output.get().footprint();
+	}
+	_memoryReport.update(inputFootprint, _inputs.size() + _groupedInputCount, outputFootprint, _outputs.size());
+
+	// Prepare the write planner, now that the configuration of all the outputs has been loaded
+	_writePlanner.prepare(_maxWriteSize, _writeRateLimiter ? &_writeRateLimiter : nullptr);
+
+	// Start recording trace events, if requested
+	if (!_tracePath.empty())
+	{
+		_tracer.open(_tracePath, _traceFlushInterval);
+		_activeTracer = &_tracer;
+	}
+
+	// Split the initial read into jobs of roughly equal size
+	const auto dataPointCount = _inputs.size() + _outputs.size() + _groupedInputCount;
+	const auto jobCount = std::min(_initialReadJobCount, dataPointCount);
+	_initialReadJobs.clear();
+	for (std::size_t job = 0; job < jobCount; ++job)
+	{
+		_initialReadJobs.push_back(std::make_unique<InitialReadJob>(*this,
+			dataPointCount * job / jobCount, dataPointCount * (job + 1) / jobCount));
+	}
+
+	// Create a dedicated I/O thread, if requested. A single thread is enough, because the I/O component only
+	// ever submits one job at a time.
+	if (_ioThreadPlacement)
+	{
+		_ownWorkerPool = std::make_unique<WorkerPool>(1, _ioThreadPlacement);
+	}
+
+	// Register with the worker pool, so that the worker threads are running
+	if (usesIoThread())
+	{
+		workerPool().addUser();
+	}
+
+	// Start the sampler thread if there are any oversampled inputs
+	if (!_oversampledInputs.empty())
+	{
+		_samplerThread = std::jthread([this](std::stop_token stopToken) { samplerMain(stopToken); });
+	}
 }
 
 auto TemplateIoComponent::cleanup() -> void
 {
-	/// @todo close the handle to the I/O device
+	// Make sure the initial read has finished
+	resetInitialRead();
+
+	// Stop the sampler thread
+	if (_samplerThread.joinable())
+	{
+		_samplerThread.request_stop();
+		_samplerThread.join();
+	}
+
+	// Make sure no job is still running, and unregister from the worker pool
+	if (usesIoThread())
+	{
+		_ioJob.wait();
+		workerPool().removeUser();
+		_ownWorkerPool.reset();
+	}
+
+	// Stop recording trace events, now that no task, job or sampler is running anymore
+	if (_activeTracer)
+	{
+		_activeTracer = nullptr;
+		_tracer.close();
+	}
+
+	// Detach the inputs from the snapshot, and close it
+	if (_snapshot)
+	{
+		for (auto &&input : _inputs)
+		{
+			if (input.get().snapshotSize())
+			{
+				input.get().attachSnapshot({}, false);
+			}
+		}
+		_snapshot.close();
+	}
+
+	// Close the replay file
+	if (_replayer.enabled())
+	{
+		_replayer.close();
+	}
+
+	/// @todo close the handle to the I/O device, unless the I/O component is simulated or replayed
 }
 
 } // namespace xentara::plugins::templateDriver
\ No newline at end of file
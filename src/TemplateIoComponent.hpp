@@ -1,25 +1,60 @@
 // Copyright (c) embedded ocean GmbH
 #pragma once
 
+#include "AcquisitionClock.hpp"
 #include "Attributes.hpp"
+#include "CollectTask.hpp"
 #include "CustomError.hpp"
+#include "DispatchTask.hpp"
+#include "InputGroup.hpp"
+#include "MemoryReport.hpp"
+#include "PackedWord.hpp"
+#include "ReadTask.hpp"
+#include "Replayer.hpp"
+#include "RuntimeCounters.hpp"
+#include "Simulator.hpp"
+#include "Snapshot.hpp"
+#include "ThreadPlacement.hpp"
+#include "Tracer.hpp"
+#include "WorkerPool.hpp"
+#include "WritePlanner.hpp"
+#include "WriteRateLimiter.hpp"
+#include "WriteTask.hpp"
 
 #include <xentara/model/ElementCategory.hpp>
 #include <xentara/skill/Element.hpp>
+#include <xentara/skill/EnableSharedFromThis.hpp>
 #include <xentara/utils/tools/Unique.hpp>
 #include <xentara/utils/core/Uuid.hpp>
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
 #include <string_view>
 #include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace xentara::plugins::templateDriver
 {
 
 using namespace std::literals;
 
+class TemplateInput;
+class TemplateOutput;
+
 /// @brief A class representing a specific type of I/O component.
 /// @todo rename this class to something more descriptive
-class TemplateIoComponent final : public skill::Element
+class TemplateIoComponent final : public skill::Element, public skill::EnableSharedFromThis<TemplateIoComponent>
 {
 public:
 	/// @brief The class object containing meta-information about this element type
@@ -30,6 +65,13 @@ public:
 		"deadbeef-dead-beef-dead-beefdeadbeef"_uuid,
 		"template driver I/O component">;
 
+	/// @brief This constructor attaches the I/O component to the driver's worker pool
+	TemplateIoComponent(std::reference_wrapper<WorkerPool> workerPool) :
+		_workerPool(workerPool)
+	{
+		_readTask.setRuntimeCounters(_runtimeCounters);
+	}
+
 	/// @brief A handle used to access the I/O component
 	/// @todo implement a proper handle
 	class Handle final : private utils::tools::Unique
@@ -42,6 +84,96 @@ public:
 		return _handle;
 	}
 
+	/// @brief Checks whether the inputs and outputs are read and written by the tasks of the I/O component.
+	///
+	/// If this is the case, the "read" and "write" tasks of the data points only perform the initial read, so that the
+	/// data points are never accessed by both at the same time.
+	auto componentTasks() const noexcept -> bool
+	{
+		return _componentTasks;
+	}
+
+	/// @brief Returns the clock used to time stamp values when they are acquired
+	auto acquisitionClock() const noexcept -> const AcquisitionClock &
+	{
+		return _acquisitionClock;
+	}
+
+	/// @brief Returns whether data points use the compact representation unless configured otherwise
+	auto compactDataPoints() const noexcept -> bool
+	{
+		return _compactDataPoints;
+	}
+
+	/// @brief Flushes the snapshot to disk, if there is one and the snapshot interval has passed since the last flush.
+	///
+	/// This is called by every task that publishes input values, and may be called from several threads at once.
+	/// @param timeStamp The time stamp the values were published with
+	auto flushSnapshot(std::chrono::system_clock::time_point timeStamp) noexcept -> void
+	{
+		if (_snapshot)
+		{
+			_snapshot.flushIfDue(timeStamp, _snapshotInterval);
+		}
+	}
+
+	/// @brief Returns the tracer used to record trace events
+	/// @return The tracer, or nullptr if tracing is disabled
+	auto tracer() const noexcept -> Tracer *
+	{
+		return _activeTracer;
+	}
+
+	/// @brief Allocates the phase for a data point polled using a poll divider
+	///
+	/// Each data point is given the phase whose executions of the read task currently poll the fewest data points,
+	/// taking into account the data points of all dividers, so that the polls are spread evenly across the executions.
+	/// @param divider The poll divider of the data point
+	/// @return The phase to use for the data point
+	auto allocatePollPhase(std::uint32_t divider) -> std::uint32_t;
+
+	/// @brief Registers an input that is sampled by the sampler thread
+	/// @param input The input. The input must have enabled oversampling in its handler.
+	auto addOversampledInput(TemplateInput &input) -> void
+	{
+		_oversampledInputs.push_back(input);
+	}
+
+	/// @brief Performs the initial read of all the inputs and outputs before going operational.
+	///
+	/// This function is called by the "read" tasks of the I/O component and all its data points. The first call starts
+	/// the initial read on the worker pool, and the call that finds it completed publishes the values.
+	/// @return process::Task::Status::Ready once the initial read has completed, or process::Task::Status::Pending otherwise
+	auto performInitialRead(const process::ExecutionContext &context) -> process::Task::Status;
+
+	/// @brief Writes a block of consecutive bytes to the I/O component
+	/// @param address The address of the first byte
+	/// @param data The data to write
+	/// @throw std::system_error The block could not be written
+	auto writeBlock(std::uint64_t address, std::span<const std::byte> data) -> void;
+
+	/// @brief Reads a word whose bits are mapped to individual boolean inputs and outputs
+	/// @param address The address of the word
+	/// @return The word, with bit 0 being the least significant bit
+	/// @throw std::system_error The word could not be read
+	auto readWord(std::uint64_t address) -> std::uint64_t;
+
+	/// @brief Changes some of the bits of a word using a single read-modify-write operation
+	///
+	/// This function does not serialize concurrent changes to the same word. Use PackedWord::modify() instead.
+	/// @param address The address of the word
+	/// @param mask The bits to change
+	/// @param bits The new values of the bits in *mask*. Bits not in *mask* are ignored.
+	/// @throw std::system_error The word could not be read or written
+	auto modifyWord(std::uint64_t address, std::uint64_t mask, std::uint64_t bits) -> void;
+
+	/// @brief Gets the word at an address that boolean inputs and outputs can be mapped to, creating it if necessary
+	///
+	/// All data points mapped to the same address share the same word, so that it is only read once per cycle.
+	/// @param address The address of the word
+	/// @return The word. The reference remains valid for as long as the I/O component exists.
+	auto packedWord(std::uint64_t address) -> PackedWord &;
+
 	/// @name Virtual Overrides for skill::Element
 	/// @{
 
@@ -50,6 +182,8 @@ public:
 
 	auto forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool final;
 
+	auto forEachTask(const model::ForEachTaskFunction &function) -> bool final;
+
 	auto makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle> final;
 
 	auto category() const noexcept -> model::ElementCategory final
@@ -60,11 +194,164 @@ public:
 	/// @}
 
 private:
+	/// @brief The job that performs the reads and writes of a cycle on a worker thread
+	class IoJob final : public WorkerPool::Job
+	{
+	public:
+		/// @brief This constuctor attaches the job to its I/O component
+		IoJob(std::reference_wrapper<TemplateIoComponent> ioComponent) : _ioComponent(ioComponent)
+		{
+		}
+
+	protected:
+		/// @name Virtual Overrides for WorkerPool::Job
+		/// @{
+
+		auto execute() noexcept -> void final;
+
+		/// @}
+
+	private:
+		/// @brief The I/O component
+		std::reference_wrapper<TemplateIoComponent> _ioComponent;
+	};
+
+	/// @brief A job that performs the initial read of a range of inputs and outputs
+	class InitialReadJob final : public WorkerPool::Job
+	{
+	public:
+		/// @brief This constuctor attaches the job to its I/O component
+		/// @param ioComponent The I/O component
+		/// @param first The index of the first data point to read, as passed to acquireDataPoint()
+		/// @param last The index one past the last data point to read
+		InitialReadJob(std::reference_wrapper<TemplateIoComponent> ioComponent, std::size_t first, std::size_t last) :
+			_ioComponent(ioComponent), _first(first), _last(last)
+		{
+		}
+
+	protected:
+		/// @name Virtual Overrides for WorkerPool::Job
+		/// @{
+
+		auto execute() noexcept -> void final;
+
+		/// @}
+
+	private:
+		/// @brief The I/O component
+		std::reference_wrapper<TemplateIoComponent> _ioComponent;
+		/// @brief The index of the first data point to read
+		std::size_t _first;
+		/// @brief The index one past the last data point to read
+		std::size_t _last;
+	};
+
+	/// @brief The progress of the initial read
+	enum class InitialReadState
+	{
+		/// @brief The initial read has not been started yet
+		Idle,
+		/// @brief The initial read jobs have been submitted to the worker pool.
+		///
+		/// This state is skipped if the initial read is performed directly by the task that starts it.
+		Running,
+		/// @brief The initial read has completed, and the values have been published
+		Done
+	};
+
+	// The tasks need access to out private member functions
+	friend class ReadTask<TemplateIoComponent>;
+	friend class WriteTask<TemplateIoComponent>;
+	friend class DispatchTask<TemplateIoComponent>;
+	friend class CollectTask<TemplateIoComponent>;
+
+	/// @brief This function is called by the "read" task.
+	///
+	/// This function reads the values of all the inputs and outputs that are due.
+	auto performReadTask(const process::ExecutionContext &context) -> void;
+	/// @brief Invalidates the read data of all the inputs and outputs
+	auto invalidateData(std::chrono::system_clock::time_point timeStamp) -> void;
+
+	/// @brief This function is called by the "write" task.
+	///
+	/// This function writes the pending values of all the outputs, merging adjacent outputs into block writes.
+	auto performWriteTask(const process::ExecutionContext &context) -> void;
+
+	/// @brief This function is called by the "dispatch" task.
+	///
+	/// This function starts reading all inputs and outputs that are due, and writing all pending values. If the worker
+	/// pool is used, the work is done asynchronously on a worker thread. Otherwise, it is done on the calling thread.
+	auto performDispatchTask(const process::ExecutionContext &context) -> void;
+	/// @brief This function is called by the "collect" task.
+	///
+	/// This function waits for the work started by the "dispatch" task to finish, and then publishes the results.
+	auto performCollectTask(const process::ExecutionContext &context) -> void;
+
+	/// @brief Checks whether the "dispatch" task hands its job to a worker thread.
+	///
+	/// This is the case if parallel I/O was requested, or if a dedicated I/O thread was configured.
+	auto usesIoThread() const noexcept -> bool
+	{
+		return _parallelIo || bool(_ioThreadPlacement);
+	}
+
+	/// @brief Checks whether the initial read is performed by worker threads.
+	///
+	/// Otherwise, the initial read is performed directly by the task that starts it.
+	auto initialReadUsesWorkers() const noexcept -> bool
+	{
+		return usesIoThread() || _initialReadJobs.size() > 1;
+	}
+
+	/// @brief Returns the worker pool used by the "dispatch" task
+	auto workerPool() noexcept -> WorkerPool &
+	{
+		return _ownWorkerPool ? *_ownWorkerPool : _workerPool.get();
+	}
+
+	/// @brief Reads all the words whose bits are mapped to individual data points, unless the data points are simulated or replayed
+	auto refreshPackedWords() noexcept -> void;
+	/// @brief Acquires the values of all the inputs and outputs that are due, without publishing them
+	///
+	/// The inputs and outputs that are not in input groups are only acquired if _componentTasks is set.
+	auto acquireAll() -> void;
+	/// @brief Publishes the values acquired using acquireAll(), or by the initial read
+	/// @param timeStamp The time stamp to publish the values with
+	/// @param dataPoints Whether to also publish the inputs and outputs that are not in input groups
+	auto publishAll(std::chrono::system_clock::time_point timeStamp, bool dataPoints) -> void;
+	/// @brief Acquires the value of a single input or output, regardless of its poll divider
+	/// @param index The index of the data point. The inputs come first, followed by the outputs, and then the inputs in input groups.
+	auto acquireDataPoint(std::size_t index) -> void;
+
+	/// @brief Waits for any running initial read to finish, and resets the initial read so it is performed again
+	auto resetInitialRead() -> void;
+
+	/// @brief Updates the totals of the counters from the counters of the I/O component and all its inputs and outputs
+	auto updateTotalCounters() noexcept -> void;
+
+	/// @brief Creates the inputs of the input groups, using the load cache if it is up to date
+	/// @param jsonObject The JSON object describing the I/O component, for error messages
+	/// @throw std::runtime_error The names of the inputs are not unique
+	auto expandInputGroups(const utils::json::decoder::Object &jsonObject) -> void;
+
+	/// @brief Iterates over the attributes of the I/O component itself, without the values of the inputs in input groups.
+	/// @param function The function that should be called for each attribute
+	/// @return The return value of the last function call
+	auto forEachComponentAttribute(const model::ForEachAttributeFunction &function) const -> bool;
+
+	/// @brief Opens the snapshot file and restores the values of the inputs from it
+	auto openSnapshot() -> void;
+
+	/// @brief The main function of the sampler thread
+	auto samplerMain(std::stop_token stopToken) -> void;
+
 	/// @name Virtual Overrides for skill::Element
 	/// @{
 
 	auto load(utils::json::decoder::Object &jsonObject, config::Context &context) -> void final;
 
+	auto realize() -> void final;
+
 	auto prepare() -> void final;
 
 	auto cleanup() -> void final;
@@ -73,6 +360,116 @@ private:
 
 	/// @brief A handle to the I/O component
 	Handle _handle;
+
+	/// @brief The driver's worker pool
+	std::reference_wrapper<WorkerPool> _workerPool;
+	/// @brief Whether to use the worker pool for the "dispatch" task
+	bool _parallelIo { false };
+	/// @brief Whether the inputs and outputs are read and written by the tasks of the I/O component instead of their own tasks
+	bool _componentTasks { false };
+	/// @brief The CPUs and scheduling policy for a dedicated I/O thread
+	/// 
+	/// If this is set, the I/O component uses its own I/O thread instead of the driver's worker pool.
+	ThreadPlacement _ioThreadPlacement;
+	/// @brief The worker pool containing the dedicated I/O thread, or nullptr if the driver's worker pool is used
+	std::unique_ptr<WorkerPool> _ownWorkerPool;
+
+	/// @brief The inputs of the I/O component
+	std::vector<std::reference_wrapper<TemplateInput>> _inputs;
+	/// @brief The outputs of the I/O component
+	std::vector<std::reference_wrapper<TemplateOutput>> _outputs;
+	/// @brief The groups of inputs generated from a pattern
+	std::vector<std::unique_ptr<InputGroup>> _inputGroups;
+	/// @brief The path of the file caching the inputs of the input groups, or an empty path if no cache is kept
+	std::filesystem::path _loadCachePath;
+	/// @brief The total number of inputs in all the input groups
+	std::size_t _groupedInputCount { 0 };
+
+	/// @brief The words whose bits are mapped to individual data points. A deque is used, because the data points hold
+	/// references to the words.
+	std::deque<PackedWord> _packedWords;
+	/// @brief The indices of the packed words, by address
+	std::unordered_map<std::uint64_t, std::size_t> _packedWordIndices;
+
+	/// @brief The inputs that are sampled by the sampler thread
+	std::vector<std::reference_wrapper<TemplateInput>> _oversampledInputs;
+	/// @brief The interval at which the sampler thread samples the oversampled inputs
+	std::chrono::nanoseconds _sampleInterval { 1ms };
+	/// @brief The sampler thread, if there are any oversampled inputs
+	std::jthread _samplerThread;
+
+	/// @brief The clock used to time stamp values when they are acquired
+	AcquisitionClock _acquisitionClock;
+
+	/// @brief The simulation used instead of the I/O device, if enabled
+	///
+	/// When replaying, the simulator is used for the outputs, which echo the written values.
+	Simulator _simulator;
+	/// @brief The replay used for the inputs instead of the I/O device, if enabled
+	Replayer _replayer;
+
+	/// @brief Whether data points use the compact representation unless configured otherwise
+	bool _compactDataPoints { false };
+	/// @brief The report of the memory used by the data points
+	MemoryReport _memoryReport;
+
+	/// @brief The path of the snapshot file, or an empty path if no snapshot is kept
+	std::filesystem::path _snapshotPath;
+	/// @brief The interval at which the snapshot is flushed to disk
+	std::chrono::milliseconds _snapshotInterval { 1s };
+	/// @brief The snapshot of the last known values of the inputs
+	Snapshot _snapshot;
+
+	/// @brief The path of the trace file, or an empty path if no trace is recorded
+	std::filesystem::path _tracePath;
+	/// @brief The interval at which the recorded trace events are written to the trace file
+	std::chrono::milliseconds _traceFlushInterval { 1s };
+	/// @brief The tracer
+	Tracer _tracer;
+	/// @brief The tracer, if tracing is enabled and the I/O component has been prepared, or nullptr otherwise
+	Tracer *_activeTracer { nullptr };
+
+	/// @brief The maximum number of bytes that can be written to the I/O component using a single block write
+	std::size_t _maxWriteSize { std::numeric_limits<std::size_t>::max() };
+
+	/// @brief The rate limiter for writes to the I/O component
+	WriteRateLimiter _writeRateLimiter;
+
+	/// @brief The number of data points polled on each execution of the read task by the phases allocated so far.
+	///
+	/// The table covers a cycle of executions that is a multiple of all the poll dividers in use, where possible.
+	std::vector<std::uint32_t> _pollLoad { 0 };
+
+	/// @brief The planner used by the "write" task
+	WritePlanner _writePlanner { *this };
+
+	/// @brief The job used by the "dispatch" and "collect" tasks
+	IoJob _ioJob { *this };
+
+	/// @brief The number of jobs the initial read is split into
+	std::size_t _initialReadJobCount { 1 };
+	/// @brief The jobs that perform the initial read
+	std::vector<std::unique_ptr<InitialReadJob>> _initialReadJobs;
+	/// @brief The progress of the initial read
+	InitialReadState _initialReadState { InitialReadState::Idle };
+	/// @brief A mutex protecting the initial read, which may be driven by the "read" tasks of several data points at once
+	std::mutex _initialReadMutex;
+
+	/// @brief The counters for the operations performed by the I/O component itself, including the inputs in input groups
+	RuntimeCounters _runtimeCounters;
+	/// @brief The totals of _runtimeCounters and the counters of all the inputs and outputs, as published in the attributes.
+	///
+	/// The totals are updated by updateTotalCounters().
+	RuntimeCounters _totalCounters;
+
+	/// @brief The "read" task
+	ReadTask<TemplateIoComponent> _readTask { *this };
+	/// @brief The "write" task
+	WriteTask<TemplateIoComponent> _writeTask { *this };
+	/// @brief The "dispatch" task
+	DispatchTask<TemplateIoComponent> _dispatchTask { *this };
+	/// @brief The "collect" task
+	CollectTask<TemplateIoComponent> _collectTask { *this };
 };
 
 } // namespace xentara::plugins::templateDriver
\ No newline at end of file
@@ -2,8 +2,11 @@
 #include "TemplateOutput.hpp"
 
 #include "AbstractTemplateOutputHandler.hpp"
+#include "PackedWord.hpp"
 #include "Tasks.hpp"
+#include "TemplateIoComponent.hpp"
 #include "TemplateOutputHandler.hpp"
+#include "Tracer.hpp"
 
 #include <xentara/config/Errors.hpp>
 #include <xentara/model/Attribute.hpp>
@@ -11,9 +14,12 @@
 #include <xentara/model/ForEachEventFunction.hpp>
 #include <xentara/model/ForEachTaskFunction.hpp>
 #include <xentara/process/ExecutionContext.hpp>
+#include <xentara/utils/eh/currentErrorCode.hpp>
 #include <xentara/utils/json/decoder/Object.hpp>
 #include <xentara/utils/json/decoder/Errors.hpp>
 
+#include <exception>
+
 namespace xentara::plugins::templateDriver
 {
 	
@@ -21,6 +27,12 @@ using namespace std::literals;
 
 auto TemplateOutput::load(utils::json::decoder::Object &jsonObject, config::Context &context) -> void
 {
+	// The write feedback and rate limit must be applied after the handler was created, so we remember them here
+	bool writeThrough = false;
+	bool verifyWrites = false;
+	double maxWriteRate = 0;
+	double writeBurst = 1;
+
 	// Go through all the members of the JSON object that represents this object
 	for (auto && [name, value] : jsonObject)
     {
@@ -28,6 +40,106 @@ auto TemplateOutput::load(utils::json::decoder::Object &jsonObject, config::Cont
 		{
 			// Create the handler
 			_handler = createHandler(value);
+			_handler->setRuntimeCounters(_runtimeCounters);
+		}
+		else if (name == "address"sv)
+		{
+			_address = value.asNumber<std::uint64_t>();
+		}
+		else if (name == "bit"sv)
+		{
+			_bit = value.asNumber<unsigned>();
+
+			// Check that the value is valid
+			if (*_bit >= PackedWord::kBitCount)
+			{
+				/// @todo replace "template output" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("bit of template output must be less than 64"));
+			}
+		}
+		else if (name == "pollEvery"sv)
+		{
+			const auto pollEvery = value.asNumber<std::uint32_t>();
+
+			// Check that the value is valid
+			if (pollEvery == 0)
+			{
+				/// @todo replace "template output" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("poll divider of template output must not be 0"));
+			}
+
+			// Set the divider, using a phase that spreads the polls evenly across the executions
+			_readTask.setPollDivider({ pollEvery, _ioComponent.get().allocatePollPhase(pollEvery) });
+		}
+		else if (name == "priority"sv)
+		{
+			// Get the keyword from the value
+			const auto keyword = value.asString<std::string>();
+			if (keyword == "critical"sv)
+			{
+				_writePriority = WritePriority::Critical;
+			}
+			else if (keyword == "normal"sv)
+			{
+				_writePriority = WritePriority::Normal;
+			}
+			else if (keyword == "bulk"sv)
+			{
+				_writePriority = WritePriority::Bulk;
+			}
+			else
+			{
+				/// @todo replace "template output" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("unknown write priority in template output"));
+			}
+		}
+		else if (name == "writeThrough"sv)
+		{
+			writeThrough = value.asBool();
+		}
+		else if (name == "readBack"sv)
+		{
+			// Get the keyword from the value
+			const auto keyword = value.asString<std::string>();
+			if (keyword == "poll"sv)
+			{
+				verifyWrites = false;
+			}
+			else if (keyword == "verify"sv)
+			{
+				verifyWrites = true;
+			}
+			else
+			{
+				/// @todo replace "template output" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("unknown read back mode in template output"));
+			}
+		}
+		else if (name == "compact"sv)
+		{
+			_compact = value.asBool();
+		}
+		else if (name == "maxWriteRate"sv)
+		{
+			maxWriteRate = value.asNumber<double>();
+
+			// Check that the value is valid
+			if (!(maxWriteRate > 0))
+			{
+				/// @todo replace "template output" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("maximum write rate of template output must be positive"));
+			}
+		}
+		else if (name == "writeBurst"sv)
+		{
+			writeBurst = value.asNumber<double>();
+
+			// Check that the value is valid
+			if (!(writeBurst >= 1))
+			{
+				/// @todo replace "template output" with a more descriptive name
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("write burst of template output must be at least 1"));
+			}
 		}
 		/// @todo load custom configuration parameters
 		else if (name == "TODO"sv)
@@ -56,6 +168,37 @@ auto TemplateOutput::load(utils::json::decoder::Object &jsonObject, config::Cont
 		/// @todo replace "template output" with a more descriptive name
 		utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("Missing data type in template output"));
 	}
+
+	// Check the bit mapping, if any
+	if (_bit)
+	{
+		if (!_address)
+		{
+			/// @todo replace "template output" with a more descriptive name
+			utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("a template output mapped to a bit needs an address"));
+		}
+		if (!_handler->mapBit(_ioComponent.get().packedWord(*_address), *_bit))
+		{
+			/// @todo replace "template output" with a more descriptive name
+			utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("the data type of the template output cannot be mapped to a bit"));
+		}
+	}
+
+	// Configure what happens after a successful write. If written values are verified, the output is no longer polled
+	// periodically, but read back once after each write instead.
+	if (verifyWrites)
+	{
+		_readTask.setPeriodicPolling(false);
+		_handler->setWriteFeedback(writeThrough, [this] { _readTask.requestRead(); });
+	}
+	else
+	{
+		_handler->setWriteFeedback(writeThrough, {});
+	}
+
+	// Limit the write rate, if requested
+	_handler->setWriteRateLimit(maxWriteRate, writeBurst);
+
 	/// @todo perform consistency and completeness checks
 	if (!"TODO")
 	{
@@ -129,6 +272,12 @@ auto TemplateOutput::createHandler(utils::json::decoder::Value &value) -> std::u
 	return std::unique_ptr<AbstractTemplateOutputHandler>();
 }
 
+auto TemplateOutput::performInitialRead(const process::ExecutionContext &context) -> process::Task::Status
+{
+	// The I/O component performs the initial read for all its data points at once
+	return _ioComponent.get().performInitialRead(context);
+}
+
 auto TemplateOutput::performReadTask(const process::ExecutionContext &context) -> void
 {
 	// tasks must not be executed before the configuration was loaded, so the handler should have been
@@ -138,8 +287,10 @@ auto TemplateOutput::performReadTask(const process::ExecutionContext &context) -
 		throw std::logic_error("internal error: \"read\" task of xentara::plugins::templateDriver::TemplateOutput executed before configuration has been loaded");
 	}
 
+	TraceSpan span(_ioComponent.get().tracer(), "task"sv, "read"sv, _traceName);
+
 	// Ask the handler to read the data
-	_handler->read(context.scheduledTime());
+	_handler->read(context.scheduledTime(), _ioComponent.get().acquisitionClock());
 }
 
 auto TemplateOutput::performWriteTask(const process::ExecutionContext &context) -> void
@@ -151,10 +302,70 @@ auto TemplateOutput::performWriteTask(const process::ExecutionContext &context)
 		throw std::logic_error("internal error: \"write\" task of xentara::plugins::templateDriver::TemplateOutput executed before configuration has been loaded");
 	}
 
+	TraceSpan span(_ioComponent.get().tracer(), "task"sv, "write"sv, _traceName);
+
 	// Ask the handler to write the data
 	_handler->write(context.scheduledTime());
 }
 
+auto TemplateOutput::acquire() -> void
+{
+	// tasks must not be executed before the configuration was loaded, so the handler should have been
+	// created already.
+	if (!_handler) [[unlikely]]
+	{
+		throw std::logic_error("internal error: xentara::plugins::templateDriver::TemplateOutput::acquire() called before configuration has been loaded");
+	}
+
+	TraceSpan span(_ioComponent.get().tracer(), "device"sv, "read"sv, _traceName);
+
+	// Ask the handler to acquire the data
+	_handler->acquire(_ioComponent.get().acquisitionClock());
+}
+
+auto TemplateOutput::publish(std::chrono::system_clock::time_point timeStamp) -> void
+{
+	// tasks must not be executed before the configuration was loaded, so the handler should have been
+	// created already.
+	if (!_handler) [[unlikely]]
+	{
+		throw std::logic_error("internal error: xentara::plugins::templateDriver::TemplateOutput::publish() called before configuration has been loaded");
+	}
+
+	// Ask the handler to publish the data
+	_handler->publish(timeStamp);
+}
+
+auto TemplateOutput::simulate(Simulator &simulator) -> void
+{
+	// The simulation is set up after the configuration was loaded, so the handler should have been created already.
+	if (!_handler) [[unlikely]]
+	{
+		throw std::logic_error("internal error: xentara::plugins::templateDriver::TemplateOutput::simulate() called before configuration has been loaded");
+	}
+
+	_handler->simulate(simulator);
+}
+
+auto TemplateOutput::compact() const noexcept -> bool
+{
+	return _compact.value_or(_ioComponent.get().compactDataPoints());
+}
+
+auto TemplateOutput::footprint() const noexcept -> MemoryFootprint
+{
+	// The footprint is computed after the configuration was loaded, so the handler should have been created already.
+	if (!_handler) [[unlikely]]
+	{
+		// Don't throw an exception, because this function is noexcept
+		return { ._object = sizeof(*this) };
+	}
+
+	auto footprint = _handler->footprint();
+	footprint._object += sizeof(*this);
+	return footprint;
+}
+
 auto TemplateOutput::invalidateData(std::chrono::system_clock::time_point timeStamp) -> void
 {
 	// tasks must not be executed before the configuration was loaded, so the handler should have been
@@ -195,9 +406,23 @@ auto TemplateOutput::forEachAttribute(const model::ForEachAttributeFunction &fun
 		throw std::logic_error("internal error: xentara::plugins::templateDriver::TemplateOutput::forEachAttribute() called before configuration has been loaded");
 	}
 
+	// Leave out the change time in the compact representation
+	if (compact())
+	{
+		const auto filtered = [&function](const model::Attribute &attribute)
+		{
+			return attribute != model::Attribute::kChangeTime && function(attribute);
+		};
+		return
+			_handler->forEachAttribute(filtered) ||
+			_runtimeCounters.forEachAttribute(function);
+	}
+
 	return
 		// Handle the handler attributes
-		_handler->forEachAttribute(function);
+		_handler->forEachAttribute(function) ||
+		// Handle the runtime counters
+		_runtimeCounters.forEachAttribute(function);
 
 	/// @todo handle any additional attributes this class supports, including attributes inherited from the I/O component
 }
@@ -211,6 +436,12 @@ auto TemplateOutput::forEachEvent(const model::ForEachEventFunction &function) -
 		throw std::logic_error("internal error: xentara::plugins::templateDriver::TemplateOutput::forEachEvent() called before configuration has been loaded");
 	}
 
+	// The compact representation has no events. Not asking the handler means that the events are never created.
+	if (compact())
+	{
+		return false;
+	}
+
 	return
 		// Handle the handler events
 		_handler->forEachEvent(function, sharedFromThis());
@@ -238,11 +469,22 @@ auto TemplateOutput::makeReadHandle(const model::Attribute &attribute) const noe
 		return std::make_error_code(std::errc::invalid_argument);
 	}
 
+	// Leave out the change time in the compact representation
+	if (compact() && &attribute == &model::Attribute::kChangeTime)
+	{
+		return std::nullopt;
+	}
+
 	// Handle the handler attributes
 	if (auto handle = _handler->makeReadHandle(attribute))
 	{
 		return handle;
 	}
+	// Handle the runtime counters
+	if (auto handle = _runtimeCounters.makeReadHandle(attribute))
+	{
+		return handle;
+	}
 
 	/// @todo handle any additional readable attributes this class supports, including attributes inherited from the I/O component
 
@@ -281,6 +523,11 @@ auto TemplateOutput::realize() -> void
 
 	// Realize the handler
 	_handler->realize();
+
+	// Leave the periodic reads and the writes to the I/O component, if its tasks perform them. The configuration of the
+	// I/O component has been loaded by now.
+	_readTask.setDelegated(_ioComponent.get().componentTasks());
+	_writeTask.setDelegated(_ioComponent.get().componentTasks());
 }
 
 } // namespace xentara::plugins::templateDriver
\ No newline at end of file
@@ -4,13 +4,20 @@
 #include "ReadTask.hpp"
 #include "WriteTask.hpp"
 #include "AbstractTemplateOutputHandler.hpp"
+#include "MemoryFootprint.hpp"
+#include "RuntimeCounters.hpp"
+#include "Simulator.hpp"
+#include "WritePriority.hpp"
 
 #include <xentara/process/Task.hpp>
 #include <xentara/skill/DataPoint.hpp>
 #include <xentara/skill/EnableSharedFromThis.hpp>
 #include <xentara/utils/json/decoder/Value.hpp>
 
+#include <cstdint>
 #include <functional>
+#include <optional>
+#include <string>
 #include <string_view>
 
 namespace xentara::plugins::templateDriver
@@ -36,6 +43,7 @@ public:
 	TemplateOutput(std::reference_wrapper<TemplateIoComponent> ioComponent) :
 		_ioComponent(ioComponent)
 	{
+		_readTask.setRuntimeCounters(_runtimeCounters);
 	}
 	
 	/// @name Virtual Overrides for skill::DataPoint
@@ -61,6 +69,12 @@ private:
 	// The tasks need access to out private member functions
 	friend class ReadTask<TemplateOutput>;
 	friend class WriteTask<TemplateOutput>;
+	// The write planner needs access to the address, the write priority and the handler
+	friend class WritePlanner;
+	// The I/O component needs access to out private member functions to read all its outputs at once
+	friend class TemplateIoComponent;
+	// The read handle benchmark sets the handler, which is normally created by load()
+	friend class ReadHandleBenchmark;
 
 	/// @brief Creates an output handler based on a configuration value
 	auto createHandler(utils::json::decoder::Value &value) -> std::unique_ptr<AbstractTemplateOutputHandler>;
@@ -69,14 +83,35 @@ private:
 	///
 	/// This function attempts to read the value if the I/O component is up.
 	auto performReadTask(const process::ExecutionContext &context) -> void;
+	/// @brief This function is called by the "read" task before going operational.
+	///
+	/// This function waits for the initial read of the I/O component, which includes this data point.
+	/// @return process::Task::Status::Ready once the initial read has completed, or process::Task::Status::Pending otherwise
+	auto performInitialRead(const process::ExecutionContext &context) -> process::Task::Status;
 	/// @brief This function is called by the "write" task.
 	///
 	/// This function attempts to write the value if the I/O component is up.
 	auto performWriteTask(const process::ExecutionContext &context) -> void;
 
+	/// @brief Acquires the value from the I/O component without publishing it.
+	///
+	/// This function is called by the I/O component, and may be called from a worker thread.
+	auto acquire() -> void;
+	/// @brief Publishes a value acquired using acquire(), if any
+	auto publish(std::chrono::system_clock::time_point timeStamp) -> void;
+
+	/// @brief Returns whether the compact representation is used
+	auto compact() const noexcept -> bool;
+
+	/// @brief Returns the memory used by the output, including its handler, its data blocks and its events
+	auto footprint() const noexcept -> MemoryFootprint;
+
 	/// @brief Invalidates any read data
 	auto invalidateData(std::chrono::system_clock::time_point timeStamp) -> void;
 
+	/// @brief Writes to a simulation instead of the I/O component
+	auto simulate(Simulator &simulator) -> void;
+
 	/// @name Virtual Overrides for skill::DataPoint
 	/// @{
 
@@ -93,6 +128,23 @@ private:
 	/// @brief The handler for data type specific functionality, or nullptr, if the data type hans not been loaded yet
 	std::unique_ptr<AbstractTemplateOutputHandler> _handler;
 
+	/// @brief The address of the output on the I/O component, or std::nullopt if none was configured
+	std::optional<std::uint64_t> _address;
+	/// @brief The bit of the word at _address the output is mapped to, or std::nullopt if the output occupies the whole address
+	std::optional<unsigned> _bit;
+
+	/// @brief The priority with which the I/O component writes the output
+	WritePriority _writePriority { WritePriority::Normal };
+
+	/// @brief Whether to use the compact representation, or std::nullopt to use the default of the I/O component
+	std::optional<bool> _compact;
+
+	/// @brief The name of the output in trace files, assigned by the I/O component
+	std::string _traceName;
+
+	/// @brief The counters for the reads and writes
+	RuntimeCounters _runtimeCounters;
+
 	/// @brief The "read" task
 	ReadTask<TemplateOutput> _readTask { *this };
 	/// @brief The "write" task
@@ -10,6 +10,9 @@
 #include <xentara/utils/eh/currentErrorCode.hpp>
 #include <xentara/utils/tools/Concepts.hpp>
 
+#include <cstring>
+#include <utility>
+
 namespace xentara::plugins::templateDriver
 {
 	
@@ -19,33 +22,84 @@ template <typename ValueType>
 const model::Attribute TemplateOutputHandler<ValueType>::kValueAttribute { model::Attribute::kValue, model::Attribute::Access::ReadWrite, staticDataType() };
 
 template <typename ValueType>
-auto TemplateOutputHandler<ValueType>::read(std::chrono::system_clock::time_point timeStamp) -> void
+auto TemplateOutputHandler<ValueType>::read(std::chrono::system_clock::time_point timeStamp, const AcquisitionClock &clock) -> void
+{
+	// Read the packed word first if the value is mapped to a bit. Otherwise, the bit would be extracted from the word cached
+	// by the last cycle of the I/O component.
+	if (_packedWord && !_simulator)
+	{
+		_packedWord->refresh();
+	}
+
+	// Acquire the value and publish it right away
+	acquire(clock);
+	publish(timeStamp);
+}
+
+template <typename ValueType>
+auto TemplateOutputHandler<ValueType>::acquire(const AcquisitionClock &clock) -> void
 {
 	try
 	{
-		// Call the other read function, but catch exceptions.
-		doRead(timeStamp);
+		// Call the read function, but catch exceptions.
+		_acquiredValue = doRead();
 	}
 	catch (const std::exception &)
 	{
 		// Get the error from the current exception using this special utility function
-		const auto error = utils::eh::currentErrorCode();
-		// Update the state
-		_readState.update(timeStamp, utils::eh::unexpected(error));
+		_acquiredValue = utils::eh::unexpected(utils::eh::currentErrorCode());
+		count(RuntimeCounters::Counter::ReadErrors);
+	}
+	count(RuntimeCounters::Counter::Reads);
+
+	// Time stamp the value right after reading it
+	_acquisitionTime = clock.stamp();
+}
+
+template <typename ValueType>
+auto TemplateOutputHandler<ValueType>::publish(std::chrono::system_clock::time_point timeStamp) -> void
+{
+	// If nothing was acquired, just bail
+	if (!_acquiredValue)
+	{
+		return;
 	}
+
+	// Update the state, preferring the acquisition time stamp
+	{
+		std::scoped_lock lock { _readStateMutex };
+		_readState.update(_acquisitionTime.value_or(timeStamp), std::move(*_acquiredValue));
+	}
+	_acquiredValue.reset();
 }
 
 template <typename ValueType>
-auto TemplateOutputHandler<ValueType>::doRead(std::chrono::system_clock::time_point timeStamp) -> void
+auto TemplateOutputHandler<ValueType>::doRead() -> ValueType
 {
+	// Echo the last written value if the I/O component is simulated
+	if (_simulator)
+	{
+		_simulator->read();
+		std::scoped_lock lock { _simulatedValueMutex };
+		return _simulatedValue;
+	}
+
+	// Extract the value from the packed word, if it is mapped to a bit
+	if constexpr (std::same_as<ValueType, bool>)
+	{
+		if (_packedWord)
+		{
+			return _packedWord->bit(_bit);
+		}
+	}
+
 	/// @todo read the value
 	ValueType value = {};
 
 	/// @todo if the read function does not throw errors, but uses return types or internal handle state,
-	// throw an std::system_error here on failure, or call _readState.update() directly.
+	// throw an std::system_error here on failure.
 
-	// The read was successful
-	_readState.update(timeStamp, value);
+	return value;
 
 	/// @todo it may be advantageous to split this function up according to value type, either using explicit 
 	/// template specialization, or using if constexpr().
@@ -55,25 +109,41 @@ auto TemplateOutputHandler<ValueType>::doRead(std::chrono::system_clock::time_po
 	//
 	// if constexpr (std::same_as<ValueType, bool>)
 	// {
-	//     doReadBoolean(timeStamp);
+	//     return doReadBoolean();
 	// }
 	// else if constexpr (utils::Tools::Integral<ValueType>)
 	// {
-	//     doReadInteger(timeStamp);
+	//     return doReadInteger();
 	// }
 	// else if constexpr (std::floating_point<ValueType>)
 	// {
-	//     doReadFloatingPoint(timeStamp);
+	//     return doReadFloatingPoint();
 	// }
 	// else if constexpr (utils::tools::StringType<ValueType>)
 	// {
-	//     doReadString(timeStamp);
+	//     return doReadString();
 	// }
 	//
 	// To determine if a type is an integer type, you should use xentara::utils::Tools::Integral instead of std::integral,
 	// because std::integral is true for bool, char, wchar_t, char8_t, char16_t, and char32_t, which is generally not desirable.
 }
 
+template <typename ValueType>
+auto TemplateOutputHandler<ValueType>::mapBit(PackedWord &word, unsigned bit) -> bool
+{
+	// Only boolean values can be mapped to a bit
+	if constexpr (std::same_as<ValueType, bool>)
+	{
+		_packedWord = &word;
+		_bit = bit;
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
 template <typename ValueType>
 constexpr auto TemplateOutputHandler<ValueType>::staticDataType() -> const data::DataType &
 {
@@ -101,38 +171,59 @@ constexpr auto TemplateOutputHandler<ValueType>::staticDataType() -> const data:
 template <typename ValueType>
 auto TemplateOutputHandler<ValueType>::write(std::chrono::system_clock::time_point timeStamp) -> void
 {
-	// Get the value
-	auto pendingValue = _pendingOutputValue.dequeue();
-	// If there was no pending value, just bail
-	if (!pendingValue)
+	// Get the value. If there was no pending value, just bail
+	if (!stagePendingValue())
 	{
 		return;
 	}
 
+	// Write the value and update the state
+	finishStagedWrite(timeStamp, writeStagedValue());
+}
+
+template <typename ValueType>
+auto TemplateOutputHandler<ValueType>::writeStagedValue() -> std::error_code
+{
 	try
 	{
 		// Call the other write function, but catch exceptions.
-		doWrite(*pendingValue, timeStamp);
+		doWrite(*_stagedValue);
 	}
 	catch (const std::exception &)
 	{
 		// Get the error from the current exception using this special utility function
-		const auto error = utils::eh::currentErrorCode();
-		// Update the state
-		_writeState.update(timeStamp, error);
+		return utils::eh::currentErrorCode();
 	}
+
+	// The write was successful
+	return {};
 }
 
 template <typename ValueType>
-auto TemplateOutputHandler<ValueType>::doWrite(ValueType value, std::chrono::system_clock::time_point timeStamp) -> void
+auto TemplateOutputHandler<ValueType>::doWrite(const ValueType &value) -> void
 {
+	// The simulation picks up the value in finishStagedWrite(), so that values written as part of a block are
+	// echoed as well
+	if (_simulator)
+	{
+		_simulator->write();
+		return;
+	}
+
+	// Change only the bit within the packed word, if the value is mapped to a bit
+	if constexpr (std::same_as<ValueType, bool>)
+	{
+		if (_packedWord)
+		{
+			_packedWord->writeBit(_bit, value);
+			return;
+		}
+	}
+
 	/// @todo write the value
 
 	/// @todo if the write function does not throw errors, but uses return types or internal handle state,
-	// throw an std::system_error here on failure, or call _writeState.update() directly.
-
-	// The write was successful
-	_writeState.update(timeStamp, std::error_code());
+	// throw an std::system_error here on failure.
 
 	/// @todo it may be advantageous to split this function up according to value type, either using explicit 
 	/// template specialization, or using if constexpr().
@@ -142,30 +233,176 @@ auto TemplateOutputHandler<ValueType>::doWrite(ValueType value, std::chrono::sys
 	//
 	// if constexpr (std::same_as<ValueType, bool>)
 	// {
-	//     doWriteBoolean(value, timeStamp);
+	//     doWriteBoolean(value);
 	// }
 	// else if constexpr (utils::Tools::Integral<ValueType>)
 	// {
-	//     doWriteInteger(value, timeStamp);
+	//     doWriteInteger(value);
 	// }
 	// else if constexpr (std::floating_point<ValueType>)
 	// {
-	//     doWriteFloatingPoint(value, timeStamp);
+	//     doWriteFloatingPoint(value);
 	// }
 	// else if constexpr (utils::tools::StringType<ValueType>)
 	// {
-	//     doWriteString(value, timeStamp);
+	//     doWriteString(value);
 	// }
 	//
 	// To determine if a type is an integer type, you should use xentara::utils::Tools::Integral instead of std::integral,
 	// because std::integral is true for *bool*, *char*, *wchar_t*, *char8_t*, *char16_t*, and *char32_t*, which is generally not desirable.
 }
 
+template <typename ValueType>
+auto TemplateOutputHandler<ValueType>::valueSize() const noexcept -> std::size_t
+{
+	// Strings do not have a fixed size, so they cannot be written as part of a block
+	if constexpr (utils::tools::StringType<ValueType>)
+	{
+		return 0;
+	}
+	/// @todo return the size of the value as stored by the I/O component
+	else
+	{
+		return sizeof(ValueType);
+	}
+}
+
+template <typename ValueType>
+auto TemplateOutputHandler<ValueType>::stagePendingValue() -> bool
+{
+	// If the rate limit has been reached, leave the value in the queue. Any newer value will replace it, so that
+	// only the latest value is written once a token becomes available.
+	if (_writeRateLimiter && hasPendingValue() && !_writeRateLimiter.tryAcquire())
+	{
+		_writeRateLimiter.countDeferredWrites(1);
+		return false;
+	}
+
+	_stagedValue = _pendingOutputValue.dequeue();
+	if (_stagedValue)
+	{
+		// Take the time the value became pending. A value scheduled after the dequeue may still have relied on that time,
+		// so set the time again if the queue is not empty any more.
+		const auto pendingSince = _pendingSince.exchange(0, std::memory_order_relaxed);
+		if (!_pendingOutputValue.empty())
+		{
+			std::chrono::steady_clock::rep none = 0;
+			_pendingSince.compare_exchange_strong(none, std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+		}
+
+		// A newer value replaces any deferred value, but the latency still counts from when the deferred value was
+		// scheduled. If the time was taken by a value staged a moment earlier, because the producer was in the middle of
+		// scheduling the value, the value has only just been scheduled.
+		if (!_deferredValue)
+		{
+			_stagedSince = toTimePoint(pendingSince).value_or(std::chrono::steady_clock::now());
+		}
+		if (_deferredValue)
+		{
+			count(RuntimeCounters::Counter::OverwrittenValues);
+			_deferredValue.reset();
+		}
+	}
+	// Stage the deferred value again, if there is one. _stagedSince still contains its time.
+	else if (_deferredValue)
+	{
+		_stagedValue = std::exchange(_deferredValue, std::nullopt);
+	}
+
+	return _stagedValue.has_value();
+}
+
+template <typename ValueType>
+auto TemplateOutputHandler<ValueType>::deferStagedValue() -> void
+{
+	_deferredValue = std::exchange(_stagedValue, std::nullopt);
+}
+
+template <typename ValueType>
+auto TemplateOutputHandler<ValueType>::encodeStagedValue(std::span<std::byte> buffer) const -> void
+{
+	encodeValue(*_stagedValue, buffer);
+}
+
+template <typename ValueType>
+auto TemplateOutputHandler<ValueType>::encodeLastWrittenValue(std::span<std::byte> buffer) const -> void
+{
+	encodeValue(*_lastWrittenValue, buffer);
+}
+
+template <typename ValueType>
+auto TemplateOutputHandler<ValueType>::encodeValue(const ValueType &value, std::span<std::byte> buffer) -> void
+{
+	// Strings are never encoded, because valueSize() is 0 for them
+	if constexpr (!utils::tools::StringType<ValueType>)
+	{
+		/// @todo convert the value to the representation used by the I/O component, e.g. using FrameField from FrameCodec.hpp
+		std::memcpy(buffer.data(), &value, sizeof(ValueType));
+	}
+}
+
+template <typename ValueType>
+auto TemplateOutputHandler<ValueType>::setWriteFeedback(bool writeThrough, std::function<void()> requestRead) -> void
+{
+	_writeThrough = writeThrough;
+	_requestRead = std::move(requestRead);
+}
+
+template <typename ValueType>
+auto TemplateOutputHandler<ValueType>::setWriteRateLimit(double rate, double burst) -> void
+{
+	_writeRateLimiter.setRate(rate);
+	_writeRateLimiter.setBurst(burst);
+}
+
+template <typename ValueType>
+auto TemplateOutputHandler<ValueType>::finishStagedWrite(std::chrono::system_clock::time_point timeStamp, std::error_code error) -> void
+{
+	if (!error)
+	{
+		// Show the written value in the read state right away, marked as unconfirmed
+		if (_writeThrough)
+		{
+			std::scoped_lock lock { _readStateMutex };
+			_readState.updateUnconfirmed(timeStamp, *_stagedValue, data::Quality::Acceptable, CustomError::UnconfirmedWrite);
+		}
+
+		// Read the value back to confirm it, if requested
+		if (_requestRead)
+		{
+			_requestRead();
+		}
+
+		// Echo the value back on subsequent reads, if the I/O component is simulated
+		if (_simulator)
+		{
+			std::scoped_lock lock { _simulatedValueMutex };
+			_simulatedValue = *_stagedValue;
+		}
+
+		// Remember the value, so it can be used to fill gaps in block writes
+		_lastWrittenValue = std::move(_stagedValue);
+	}
+	_stagedValue.reset();
+	_stagedSince.reset();
+
+	// Count the write
+	count(RuntimeCounters::Counter::Writes);
+	if (error)
+	{
+		count(RuntimeCounters::Counter::WriteErrors);
+	}
+
+	// Update the state
+	_writeState.update(timeStamp, error);
+}
+
 template <typename ValueType>
 auto TemplateOutputHandler<ValueType>::invalidateData(std::chrono::system_clock::time_point timeStamp) -> void
 {
 	// Set the state to "No Data"
 	// Note: the write state is not invalidated, because the write state simply contains the last write error.
+	std::scoped_lock lock { _readStateMutex };
 	_readState.update(timeStamp, utils::eh::unexpected(CustomError::NoData));
 }
 
@@ -185,7 +422,9 @@ auto TemplateOutputHandler<ValueType>::forEachAttribute(const model::ForEachAttr
 		// Handle the read state attributes
 		_readState.forEachAttribute(function) ||
 		// Handle the write state attributes
-		_writeState.forEachAttribute(function);
+		_writeState.forEachAttribute(function) ||
+		// Handle the rate limiter attributes, if there is a rate limit
+		(_writeRateLimiter && _writeRateLimiter.forEachAttribute(function));
 }
 
 template <typename ValueType>
@@ -201,12 +440,12 @@ auto TemplateOutputHandler<ValueType>::forEachEvent(const model::ForEachEventFun
 template <typename ValueType>
 auto TemplateOutputHandler<ValueType>::makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>
 {
-	// Handle the value attribute separately
-	if (attribute == kValueAttribute)
+	// Handle the value attribute
+	if (&attribute == &kValueAttribute)
 	{
 		return _readState.valueReadHandle();
 	}
-	
+
 	// Handle the read state attributes
 	if (auto handle = _readState.makeReadHandle(attribute))
 	{
@@ -217,6 +456,11 @@ auto TemplateOutputHandler<ValueType>::makeReadHandle(const model::Attribute &at
 	{
 		return handle;
 	}
+	// Handle the rate limiter attributes, if there is a rate limit
+	if (_writeRateLimiter)
+	{
+		return _writeRateLimiter.makeReadHandle(attribute);
+	}
 
 	return std::nullopt;
 }
@@ -244,6 +488,26 @@ auto TemplateOutputHandler<ValueType>::realize() -> void
 	// Realize the state objects
 	_readState.realize();
 	_writeState.realize();
+	if (_writeRateLimiter)
+	{
+		_writeRateLimiter.realize();
+	}
+}
+
+template <typename ValueType>
+auto TemplateOutputHandler<ValueType>::footprint() const noexcept -> MemoryFootprint
+{
+	MemoryFootprint footprint { ._handler = sizeof(*this) };
+
+	// Add the state objects
+	_readState.addFootprint(footprint);
+	_writeState.addFootprint(footprint);
+	if (_writeRateLimiter)
+	{
+		footprint._dataBlock += WriteRateLimiter::dataBlockSize();
+	}
+
+	return footprint;
 }
 
 /// @class xentara::plugins::templateDriver::TemplateOutputHandler
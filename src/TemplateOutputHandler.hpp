@@ -5,10 +5,19 @@
 #include "ReadState.hpp"
 #include "WriteState.hpp"
 #include "SingleValueQueue.hpp"
+#include "WriteRateLimiter.hpp"
 
 #include <xentara/model/Attribute.hpp>
+#include <xentara/utils/eh/expected.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <functional>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <system_error>
 
 namespace xentara::plugins::templateDriver
 {
@@ -39,12 +48,90 @@ public:
 
 	auto makeWriteHandle(const model::Attribute &attribute, std::shared_ptr<void> parent) noexcept -> std::optional<data::WriteHandle> final;
 
+	auto setRuntimeCounters(RuntimeCounters &counters) -> void final
+	{
+		_counters = &counters;
+	}
+
+	auto mapBit(PackedWord &word, unsigned bit) -> bool final;
+
+	auto simulate(Simulator &simulator) -> void final
+	{
+		_simulator = &simulator;
+	}
+
 	auto realize() -> void final;
+
+	auto footprint() const noexcept -> MemoryFootprint final;
 		
-	auto read(std::chrono::system_clock::time_point timeStamp) -> void final;
+	auto read(std::chrono::system_clock::time_point timeStamp, const AcquisitionClock &clock) -> void final;
+
+	auto acquire(const AcquisitionClock &clock) -> void final;
+
+	auto publish(std::chrono::system_clock::time_point timeStamp) -> void final;
 	
 	auto write(std::chrono::system_clock::time_point timeStamp) -> void final;	
 
+	auto valueSize() const noexcept -> std::size_t final;
+
+	auto hasPendingValue() const noexcept -> bool final
+	{
+		return _deferredValue.has_value() || !_pendingOutputValue.empty();
+	}
+
+	auto pendingSince() const noexcept -> std::optional<std::chrono::steady_clock::time_point> final
+	{
+		return toTimePoint(_pendingSince.load(std::memory_order_relaxed));
+	}
+
+	auto setScheduledFlag(std::atomic<bool> *flag) noexcept -> void final
+	{
+		_scheduledFlag = flag;
+	}
+
+	auto hasStagedValue() const noexcept -> bool final
+	{
+		return _stagedValue.has_value();
+	}
+
+	auto stagePendingValue() -> bool final;
+
+	auto writeStagedValue() -> std::error_code final;
+
+	auto stagedSince() const noexcept -> std::optional<std::chrono::steady_clock::time_point> final
+	{
+		return _stagedSince;
+	}
+
+	auto deferStagedValue() -> void final;
+
+	auto encodeStagedValue(std::span<std::byte> buffer) const -> void final;
+
+	auto stagedBit() const noexcept -> bool final
+	{
+		if constexpr (std::same_as<ValueType, bool>)
+		{
+			return *_stagedValue;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	auto hasLastWrittenValue() const noexcept -> bool final
+	{
+		return _lastWrittenValue.has_value();
+	}
+
+	auto encodeLastWrittenValue(std::span<std::byte> buffer) const -> void final;
+
+	auto setWriteFeedback(bool writeThrough, std::function<void()> requestRead) -> void final;
+
+	auto setWriteRateLimit(double rate, double burst) -> void final;
+
+	auto finishStagedWrite(std::chrono::system_clock::time_point timeStamp, std::error_code error) -> void final;
+
 	auto invalidateData(std::chrono::system_clock::time_point timeStamp) -> void final;
 
 	///@}
@@ -55,31 +142,129 @@ public:
 	static const model::Attribute kValueAttribute;
 
 private:
-	/// @brief The actual implementation of read(), which may throw exceptions on error.
-	auto doRead(std::chrono::system_clock::time_point timeStamp) -> void;
-	/// @brief The actual implementation of write(), which may throw exceptions on error.
-	auto doWrite(ValueType value, std::chrono::system_clock::time_point timeStamp) -> void;	
+	/// @brief Increments a runtime counter, if counters were set
+	auto count(RuntimeCounters::Counter counter) noexcept -> void
+	{
+		if (_counters)
+		{
+			_counters->increment(counter);
+		}
+	}
+
+	/// @brief Reads the value from the I/O component, throwing an exception on error.
+	auto doRead() -> ValueType;
+	/// @brief Writes a value to the I/O component, throwing an exception on error.
+	auto doWrite(const ValueType &value) -> void;
+
+	/// @brief Encodes a value into the representation used by the I/O component
+	/// @param value The value
+	/// @param buffer The buffer. The size of the buffer must be valueSize().
+	static auto encodeValue(const ValueType &value, std::span<std::byte> buffer) -> void;
 
 	/// @brief Determines the correct data type based on the *ValueType* template parameter
 	///
 	/// This function returns the same value as dataType(), but is static and constexpr.
 	static constexpr auto staticDataType() -> const data::DataType &;
 
+	/// @brief Converts a tick count of the steady clock to a time point
+	/// @param ticks The tick count, or 0 for none
+	/// @return The time point, or std::nullopt if the tick count is 0
+	static auto toTimePoint(std::chrono::steady_clock::rep ticks) noexcept -> std::optional<std::chrono::steady_clock::time_point>
+	{
+		if (ticks == 0)
+		{
+			return std::nullopt;
+		}
+		return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(ticks));
+	}
+
 	/// @brief Schedules a value to be written.
 	///
 	/// This function is called by the value write handle.
 	auto scheduleOutputValue(ValueType value) noexcept
 	{
-		_pendingOutputValue.enqueue(value);
+		// Remember when the output became pending, unless an older value is still waiting
+		const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+		std::chrono::steady_clock::rep none = 0;
+		_pendingSince.compare_exchange_strong(none, now, std::memory_order_relaxed);
+
+		if (_pendingOutputValue.enqueue(value))
+		{
+			count(RuntimeCounters::Counter::OverwrittenValues);
+		}
+
+		// If the older value was staged between setting the time and enqueuing our value, stagePendingValue() has taken
+		// the time with it. Set the time again, but take it back if our value has already been staged as well.
+		none = 0;
+		if (_pendingSince.compare_exchange_strong(none, now, std::memory_order_relaxed) && _pendingOutputValue.empty())
+		{
+			auto ours = now;
+			_pendingSince.compare_exchange_strong(ours, 0, std::memory_order_relaxed);
+		}
+
+		// Tell the write planner about the value. This is done after enqueuing the value, so that the planner finds it.
+		if (_scheduledFlag)
+		{
+			_scheduledFlag->store(true, std::memory_order_release);
+		}
 	}
 
+	/// @brief The counters for the reads and writes, or nullptr if none were set
+	RuntimeCounters *_counters { nullptr };
+
 	/// @brief The read state
 	ReadState<ValueType> _readState;
+	/// @brief A mutex that serializes updates of the read state.
+	///
+	/// This is needed because with write-through, the read state is updated by the write path as well as the read path,
+	/// which may run on different threads.
+	std::mutex _readStateMutex;
+	/// @brief The value or error acquired using acquire() that has not been published yet, or std::nullopt if there is none
+	std::optional<utils::eh::expected<ValueType, std::error_code>> _acquiredValue;
+	/// @brief The acquisition time stamp of _acquiredValue, or std::nullopt if acquisition time stamps are disabled
+	std::optional<std::chrono::system_clock::time_point> _acquisitionTime;
 	/// @brief The write state
 	WriteState _writeState;
 
 	/// @brief The queue for the pending output value
 	SingleValueQueue<ValueType> _pendingOutputValue;
+
+	/// @brief The time the oldest value in the queue was scheduled, as a steady clock tick count, or 0 if the queue is empty.
+	///
+	/// The time and the value are separate atomics, so scheduleOutputValue() and stagePendingValue() each repair the time
+	/// after touching the queue. The time can briefly be 0 while a value is waiting, or vice versa.
+	std::atomic<std::chrono::steady_clock::rep> _pendingSince { 0 };
+	/// @brief The flag to raise when a value is scheduled, or nullptr for none
+	std::atomic<bool> *_scheduledFlag { nullptr };
+
+	/// @brief The rate limiter for writes
+	WriteRateLimiter _writeRateLimiter;
+
+	/// @brief The value that was taken from the queue and is currently being written
+	std::optional<ValueType> _stagedValue;
+	/// @brief The time the staged value was first scheduled, or std::nullopt if it is not known
+	std::optional<std::chrono::steady_clock::time_point> _stagedSince;
+	/// @brief A value that was staged but deferred using deferStagedValue(), or std::nullopt if there is none
+	std::optional<ValueType> _deferredValue;
+	/// @brief The value that was last written successfully, or std::nullopt if none is known
+	std::optional<ValueType> _lastWrittenValue;
+
+	/// @brief Whether to update the read state with written values right away
+	bool _writeThrough { false };
+	/// @brief A function that requests a read of the output after a successful write, or an empty function for none
+	std::function<void()> _requestRead;
+
+	/// @brief The simulator, or nullptr if the value is written to the I/O component
+	Simulator *_simulator { nullptr };
+	/// @brief The value last written to the simulator, which is echoed back on read
+	ValueType _simulatedValue {};
+	/// @brief A mutex protecting _simulatedValue, which is written by the write path and read by the read path
+	std::mutex _simulatedValueMutex;
+
+	/// @brief The word the value is mapped to a bit of, or nullptr if the value is read and written by itself
+	PackedWord *_packedWord { nullptr };
+	/// @brief The index of the bit within _packedWord
+	unsigned _bit { 0 };
 };
 
 /// @class xentara::plugins::templateDriver::TemplateOutputHandler
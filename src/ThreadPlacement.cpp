@@ -0,0 +1,198 @@
+// Copyright (c) embedded ocean GmbH
+#include "ThreadPlacement.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if defined(_WIN32)
+#	include <Windows.h>
+#elif defined(__linux__)
+#	include <pthread.h>
+#	include <sched.h>
+#endif
+
+namespace xentara::plugins::templateDriver
+{
+
+using namespace std::literals;
+
+namespace
+{
+
+	/// @brief Parses a CPU number
+	auto parseCpu(std::string_view text) -> std::size_t
+	{
+		std::size_t cpu = 0;
+		const auto end = text.data() + text.size();
+		const auto [pointer, error] = std::from_chars(text.data(), end, cpu);
+		if (text.empty() || error != std::errc() || pointer != end)
+		{
+			throw std::runtime_error("invalid CPU number \""s + std::string(text) + "\"");
+		}
+		return cpu;
+	}
+
+} // namespace
+
+auto ThreadPlacement::setCpus(std::string_view cpuList) -> void
+{
+	_cpus.clear();
+
+	const auto cpuCount = std::thread::hardware_concurrency();
+
+	// Go through the comma separated list
+	while (!cpuList.empty())
+	{
+		const auto comma = cpuList.find(',');
+		const auto item = cpuList.substr(0, comma);
+		cpuList = comma == std::string_view::npos ? std::string_view() : cpuList.substr(comma + 1);
+
+		// Each item is either a single CPU, or a range of CPUs
+		const auto dash = item.find('-');
+		const auto first = parseCpu(item.substr(0, dash));
+		const auto last = dash == std::string_view::npos ? first : parseCpu(item.substr(dash + 1));
+		if (last < first)
+		{
+			throw std::runtime_error("invalid CPU range \""s + std::string(item) + "\"");
+		}
+		// Only check the CPU count if it is known
+		if (cpuCount != 0 && last >= cpuCount)
+		{
+			throw std::runtime_error("CPU "s + std::to_string(last) + " does not exist");
+		}
+
+		for (auto cpu = first; cpu <= last; ++cpu)
+		{
+			_cpus.push_back(cpu);
+		}
+	}
+
+	if (_cpus.empty())
+	{
+		throw std::runtime_error("empty CPU list");
+	}
+
+	// Remove duplicates
+	std::ranges::sort(_cpus);
+	const auto duplicates = std::ranges::unique(_cpus);
+	_cpus.erase(duplicates.begin(), duplicates.end());
+}
+
+auto ThreadPlacement::setPolicy(std::string_view keyword) -> void
+{
+	if (keyword == "normal"sv)
+	{
+		_policy = Policy::Normal;
+	}
+	else if (keyword == "fifo"sv)
+	{
+		_policy = Policy::Fifo;
+	}
+	else if (keyword == "rr"sv)
+	{
+		_policy = Policy::RoundRobin;
+	}
+	else
+	{
+		throw std::runtime_error("unknown scheduling policy \""s + std::string(keyword) + "\"");
+	}
+}
+
+auto ThreadPlacement::validate() const -> void
+{
+	// No need to check anything if there is no priority
+	if (!_priority)
+	{
+		return;
+	}
+
+	if (_policy == Policy::Normal)
+	{
+		throw std::runtime_error("a scheduling priority requires a real-time scheduling policy");
+	}
+
+#if defined(__linux__)
+	const auto nativePolicy = _policy == Policy::Fifo ? SCHED_FIFO : SCHED_RR;
+	const auto minPriority = sched_get_priority_min(nativePolicy);
+	const auto maxPriority = sched_get_priority_max(nativePolicy);
+#else
+	// Use the Linux range on other platforms, so that configurations are portable
+	constexpr auto minPriority = 1;
+	constexpr auto maxPriority = 99;
+#endif
+	if (*_priority < minPriority || *_priority > maxPriority)
+	{
+		throw std::runtime_error("scheduling priority must be between "s + std::to_string(minPriority) + " and " +
+			std::to_string(maxPriority));
+	}
+}
+
+auto ThreadPlacement::apply() const noexcept -> bool
+{
+	// Apply both parts, even if the first one fails
+	const auto cpusApplied = applyCpus();
+	const auto policyApplied = applyPolicy();
+	return cpusApplied && policyApplied;
+}
+
+auto ThreadPlacement::applyCpus() const noexcept -> bool
+{
+	if (_cpus.empty())
+	{
+		return true;
+	}
+
+#if defined(_WIN32)
+	DWORD_PTR mask = 0;
+	for (auto cpu : _cpus)
+	{
+		// Thread affinity masks only support the first processor group
+		if (cpu < sizeof(DWORD_PTR) * 8)
+		{
+			mask |= DWORD_PTR(1) << cpu;
+		}
+	}
+	return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	for (auto cpu : _cpus)
+	{
+		if (cpu < CPU_SETSIZE)
+		{
+			CPU_SET(cpu, &cpuSet);
+		}
+	}
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+	/// @todo support CPU affinity on other platforms
+	return false;
+#endif
+}
+
+auto ThreadPlacement::applyPolicy() const noexcept -> bool
+{
+	if (_policy == Policy::Normal)
+	{
+		return true;
+	}
+
+#if defined(_WIN32)
+	// Windows has no real-time policies for individual threads, so just use the highest priority
+	return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#elif defined(__linux__)
+	const auto nativePolicy = _policy == Policy::Fifo ? SCHED_FIFO : SCHED_RR;
+	sched_param parameters {};
+	parameters.sched_priority = _priority.value_or(sched_get_priority_min(nativePolicy));
+	// If this fails, e.g. because the process lacks CAP_SYS_NICE, the thread simply keeps its normal scheduling
+	return pthread_setschedparam(pthread_self(), nativePolicy, &parameters) == 0;
+#else
+	/// @todo support real-time scheduling on other platforms
+	return false;
+#endif
+}
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,73 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief Describes the CPUs and the scheduling policy a thread should run with
+class ThreadPlacement final
+{
+public:
+	/// @brief The scheduling policy
+	enum class Policy
+	{
+		/// @brief The normal, time-shared scheduling policy of the operating system
+		Normal,
+		/// @brief Real-time first-in, first-out scheduling (SCHED_FIFO)
+		Fifo,
+		/// @brief Real-time round robin scheduling (SCHED_RR)
+		RoundRobin
+	};
+
+	/// @brief Sets the CPUs the thread may run on from a list like "2,3,8-11"
+	/// @param cpuList The list of CPUs
+	/// @throw std::runtime_error The list is malformed, or contains CPUs that do not exist
+	auto setCpus(std::string_view cpuList) -> void;
+
+	/// @brief Sets the scheduling policy from a keyword ("normal", "fifo" or "rr")
+	/// @param keyword The keyword
+	/// @throw std::runtime_error The keyword is not known
+	auto setPolicy(std::string_view keyword) -> void;
+
+	/// @brief Sets the real-time scheduling priority
+	auto setPriority(int priority) noexcept -> void
+	{
+		_priority = priority;
+	}
+
+	/// @brief Checks the priority against the policy
+	/// @throw std::runtime_error The priority is out of range, or was set for a policy that does not support it
+	auto validate() const -> void;
+
+	/// @brief Checks whether any placement was configured
+	explicit operator bool() const noexcept
+	{
+		return !_cpus.empty() || _policy != Policy::Normal;
+	}
+
+	/// @brief Applies the placement to the calling thread.
+	/// 
+	/// If the process lacks the privileges for the requested placement, the thread keeps running with normal scheduling.
+	/// @return Whether the placement was applied completely
+	auto apply() const noexcept -> bool;
+
+private:
+	/// @brief Applies the CPU set to the calling thread
+	auto applyCpus() const noexcept -> bool;
+	/// @brief Applies the policy and priority to the calling thread
+	auto applyPolicy() const noexcept -> bool;
+
+	/// @brief The CPUs the thread may run on, or an empty list to allow all CPUs
+	std::vector<std::size_t> _cpus;
+	/// @brief The scheduling policy
+	Policy _policy { Policy::Normal };
+	/// @brief The real-time priority, or std::nullopt to use the lowest real-time priority
+	std::optional<int> _priority;
+};
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,308 @@
+// Copyright (c) embedded ocean GmbH
+#include "Tracer.hpp"
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <new>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace xentara::plugins::templateDriver
+{
+
+using namespace std::literals;
+
+class Tracer::ThreadBuffers final
+{
+public:
+	/// @brief Hands the buffers back when the thread exits
+	~ThreadBuffers()
+	{
+		for (auto &&[tracerId, buffer] : _buffers)
+		{
+			buffer->release();
+		}
+	}
+
+	/// @brief Finds the buffer used with a tracer
+	/// @return The buffer, or nullptr if the thread has no buffer for the tracer yet
+	auto find(std::uint64_t tracerId) const noexcept -> Buffer *
+	{
+		for (auto &&[id, buffer] : _buffers)
+		{
+			if (id == tracerId)
+			{
+				return buffer.get();
+			}
+		}
+		return nullptr;
+	}
+
+	/// @brief Adds the buffer used with a tracer
+	auto add(std::uint64_t tracerId, std::shared_ptr<Buffer> buffer) -> void
+	{
+		// Forget the buffers of tracers that no longer exist, which we can tell because we are the only owner left
+		std::erase_if(_buffers, [](const auto &entry) { return entry.second.use_count() == 1; });
+
+		_buffers.emplace_back(tracerId, std::move(buffer));
+	}
+
+private:
+	/// @brief The buffers, together with the IDs of their tracers
+	std::vector<std::pair<std::uint64_t, std::shared_ptr<Buffer>>> _buffers;
+};
+
+Tracer::Tracer() :
+	_id([]
+	{
+		static std::atomic<std::uint64_t> nextId { 0 };
+		return nextId.fetch_add(1, std::memory_order_relaxed);
+	}())
+{
+}
+
+Tracer::~Tracer()
+{
+	close();
+}
+
+auto Tracer::open(const std::filesystem::path &path, std::chrono::milliseconds flushInterval) -> void
+{
+	close();
+
+	_file.open(path, std::ios::out | std::ios::trunc);
+	if (!_file)
+	{
+		throw std::system_error(errno, std::generic_category(), "could not create trace file");
+	}
+
+	// Use the JSON array format, which allows us to append events as we go
+	_file << "[\n";
+	_firstEvent = true;
+	_flushInterval = flushInterval;
+
+	_flusherThread = std::jthread([this](std::stop_token stopToken) { flusherMain(stopToken); });
+}
+
+auto Tracer::close() -> void
+{
+	if (!_file.is_open())
+	{
+		return;
+	}
+
+	// Stop the background thread, and write the remaining events ourselves
+	if (_flusherThread.joinable())
+	{
+		_flusherThread.request_stop();
+		_flusherThread.join();
+	}
+	flush();
+
+	_file << "\n]\n";
+	_file.close();
+}
+
+auto Tracer::record(const Event &event) noexcept -> void
+{
+	// Drop the event if there are too many threads
+	const auto buffer = threadBuffer();
+	if (!buffer) [[unlikely]]
+	{
+		return;
+	}
+
+	// Drop the event if the buffer is full
+	buffer->push(event);
+}
+
+auto Tracer::threadBuffer() noexcept -> Buffer *
+{
+	thread_local ThreadBuffers threadBuffers;
+
+	// Use the buffer the thread claimed before, if any
+	if (const auto buffer = threadBuffers.find(_id)) [[likely]]
+	{
+		return buffer;
+	}
+
+	// Claim a buffer the first time the thread records an event
+	auto buffer = claimBuffer();
+	if (!buffer)
+	{
+		return nullptr;
+	}
+	try
+	{
+		threadBuffers.add(_id, buffer);
+	}
+	catch (const std::bad_alloc &)
+	{
+		buffer->release();
+		return nullptr;
+	}
+	return buffer.get();
+}
+
+auto Tracer::claimBuffer() noexcept -> std::shared_ptr<Buffer>
+{
+	std::scoped_lock lock { _buffersMutex };
+
+	// Prefer a buffer that was handed back by a thread that exited
+	for (auto &&buffer : _ownedBuffers)
+	{
+		if (buffer && buffer->claim())
+		{
+			return buffer;
+		}
+	}
+
+	// Create a new buffer in the first unused slot
+	for (std::size_t slot = 0; slot < kMaxThreads; ++slot)
+	{
+		if (_ownedBuffers[slot])
+		{
+			continue;
+		}
+
+		try
+		{
+			auto buffer = std::make_shared<Buffer>();
+			buffer->claim();
+			_ownedBuffers[slot] = buffer;
+			_buffers[slot].store(buffer.get(), std::memory_order_release);
+			return buffer;
+		}
+		catch (const std::bad_alloc &)
+		{
+			return nullptr;
+		}
+	}
+
+	return nullptr;
+}
+
+auto Tracer::Buffer::push(const Event &event) noexcept -> bool
+{
+	const auto head = _head.load(std::memory_order_relaxed);
+	if (head - _tail.load(std::memory_order_acquire) >= kBufferCapacity)
+	{
+		return false;
+	}
+
+	_events[head % kBufferCapacity] = event;
+	_head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename Function>
+auto Tracer::Buffer::drain(Function &&function) -> void
+{
+	auto tail = _tail.load(std::memory_order_relaxed);
+	const auto head = _head.load(std::memory_order_acquire);
+	for (; tail != head; ++tail)
+	{
+		function(_events[tail % kBufferCapacity]);
+	}
+	_tail.store(tail, std::memory_order_release);
+}
+
+auto Tracer::flush() -> void
+{
+	std::scoped_lock lock { _fileMutex };
+
+	for (std::size_t slot = 0; slot < kMaxThreads; ++slot)
+	{
+		const auto buffer = _buffers[slot].load(std::memory_order_acquire);
+		if (!buffer)
+		{
+			continue;
+		}
+
+		buffer->drain([&](const Event &event) { write(event, slot); });
+	}
+
+	_file.flush();
+}
+
+auto Tracer::write(const Event &event, std::size_t thread) -> void
+{
+	using Microseconds = std::chrono::duration<double, std::micro>;
+	const auto begin = Microseconds(event._begin.time_since_epoch()).count();
+	const auto duration = Microseconds(event._end - event._begin).count();
+
+	if (!_firstEvent)
+	{
+		_file << ",\n";
+	}
+	_firstEvent = false;
+
+	// Write a "complete" event, which contains both the start and the duration
+	_file << R"({"name":)";
+	writeString(event._name);
+	_file << R"(,"cat":)";
+	writeString(event._category);
+	_file << R"(,"ph":"X","pid":1,"tid":)" << thread
+		<< R"(,"ts":)" << std::fixed << begin << R"(,"dur":)" << duration << R"(,"args":{)";
+	if (!event._target.empty())
+	{
+		_file << R"("target":)";
+		writeString(event._target);
+	}
+	if (event._address)
+	{
+		_file << (event._target.empty() ? "" : ",") << R"("address":)" << *event._address << R"(,"size":)" << event._size;
+	}
+	_file << "}}";
+}
+
+auto Tracer::writeString(std::string_view string) -> void
+{
+	_file << '"';
+	for (const auto character : string)
+	{
+		switch (character)
+		{
+		case '"':
+			_file << R"(\")";
+			break;
+		case '\\':
+			_file << R"(\\)";
+			break;
+		default:
+			// Control characters must be written as Unicode escape sequences
+			if (static_cast<unsigned char>(character) < 0x20)
+			{
+				char escape[7];
+				std::snprintf(escape, sizeof(escape), "\\u%04x", unsigned(character));
+				_file << escape;
+			}
+			else
+			{
+				_file << character;
+			}
+			break;
+		}
+	}
+	_file << '"';
+}
+
+auto Tracer::flusherMain(std::stop_token stopToken) -> void
+{
+	std::mutex mutex;
+	std::condition_variable_any wakeUp;
+	while (!stopToken.stop_requested())
+	{
+		// Wait for the next flush, waking up early if we are stopped
+		{
+			std::unique_lock lock { mutex };
+			wakeUp.wait_for(lock, stopToken, _flushInterval, [] { return false; });
+		}
+
+		flush();
+	}
+}
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,220 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include "CacheLine.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string_view>
+#include <thread>
+
+namespace xentara::plugins::templateDriver
+{
+
+using namespace std::literals;
+
+/// @brief Records the executions of tasks and the transactions with the I/O component into a trace file.
+///
+/// The trace file uses the JSON trace event format, and can be viewed using chrome://tracing or Perfetto.
+///
+/// Each thread records its events into its own lock-free buffer. A background thread periodically moves the events
+/// from the buffers into the file. If a buffer is full, because events are recorded faster than they are written,
+/// further events of that thread are dropped until the background thread has caught up.
+///
+/// The buffers belong to the tracer, and are handed back when their thread exits, so that threads started later can
+/// reuse them. The buffer index is used as thread ID in the trace file, so threads that never ran at the same time
+/// may share an ID.
+class Tracer final
+{
+public:
+	/// @brief A single recorded span
+	struct Event final
+	{
+		/// @brief The category, e.g. "task" or "device". Must be a string literal.
+		std::string_view _category;
+		/// @brief The name, e.g. "read" or "write". Must be a string literal.
+		std::string_view _name;
+		/// @brief The name of the object the span refers to. The string must outlive the tracer.
+		std::string_view _target;
+		/// @brief The start of the span
+		std::chrono::steady_clock::time_point _begin {};
+		/// @brief The end of the span
+		std::chrono::steady_clock::time_point _end {};
+		/// @brief The address of a block transaction, or std::nullopt if the span is not a block transaction
+		std::optional<std::uint64_t> _address {};
+		/// @brief The number of bytes of a block transaction
+		std::size_t _size { 0 };
+	};
+
+	/// @brief Default constructor
+	Tracer();
+	/// @brief Destructor. Closes the file.
+	~Tracer();
+
+	/// @brief Tracers cannot be copied
+	Tracer(const Tracer &) = delete;
+	/// @brief Tracers cannot be copied
+	auto operator=(const Tracer &) -> Tracer & = delete;
+
+	/// @brief Creates the trace file and starts the background thread
+	/// @param path The path of the file. An existing file is overwritten.
+	/// @param flushInterval The interval at which the recorded events are written to the file
+	/// @throw std::system_error The file could not be created
+	auto open(const std::filesystem::path &path, std::chrono::milliseconds flushInterval) -> void;
+
+	/// @brief Writes all remaining events, stops the background thread and closes the file
+	auto close() -> void;
+
+	/// @brief Records an event
+	/// @note This function may be called from any thread.
+	auto record(const Event &event) noexcept -> void;
+
+private:
+	/// @brief The number of events each buffer can hold
+	static constexpr std::size_t kBufferCapacity = 4096;
+	/// @brief The maximum number of threads that can record events at the same time. Events from additional threads are dropped.
+	static constexpr std::size_t kMaxThreads = 64;
+
+	/// @brief A single-producer, single-consumer ring buffer for the events of one thread
+	class Buffer final
+	{
+	public:
+		/// @brief Adds an event. This is called only by the thread the buffer belongs to.
+		/// @return Whether there was room for the event
+		auto push(const Event &event) noexcept -> bool;
+
+		/// @brief Removes all the events. This is called only by the background thread.
+		template <typename Function>
+		auto drain(Function &&function) -> void;
+
+		/// @brief Claims the buffer for the calling thread
+		/// @return Whether the buffer was free
+		auto claim() noexcept -> bool
+		{
+			return !_claimed.exchange(true, std::memory_order_acquire);
+		}
+
+		/// @brief Hands the buffer back when its thread exits. Any remaining events are still written.
+		auto release() noexcept -> void
+		{
+			_claimed.store(false, std::memory_order_release);
+		}
+
+	private:
+		/// @brief The events
+		std::array<Event, kBufferCapacity> _events;
+		/// @brief The number of events ever added. This is written by the recording thread.
+		alignas(kCacheLineSize) std::atomic<std::size_t> _head { 0 };
+		/// @brief The number of events ever removed. This is written by the background thread.
+		alignas(kCacheLineSize) std::atomic<std::size_t> _tail { 0 };
+		/// @brief Whether a thread is using the buffer. This hands the buffer, and with it _head, from one thread to the next.
+		std::atomic<bool> _claimed { false };
+	};
+
+	/// @brief The buffers the calling thread uses with the different tracers, which are handed back when the thread exits.
+	class ThreadBuffers;
+
+	/// @brief Returns the buffer of the calling thread, claiming one first if necessary
+	/// @return The buffer, or nullptr if all the buffers are in use
+	auto threadBuffer() noexcept -> Buffer *;
+
+	/// @brief Claims a free buffer for the calling thread, creating it if necessary
+	/// @return The buffer, or nullptr if all the buffers are in use
+	auto claimBuffer() noexcept -> std::shared_ptr<Buffer>;
+
+	/// @brief Writes all the events recorded so far to the file
+	auto flush() -> void;
+
+	/// @brief Writes a single event to the file
+	auto write(const Event &event, std::size_t thread) -> void;
+
+	/// @brief Writes a string to the file as a quoted JSON string
+	auto writeString(std::string_view string) -> void;
+
+	/// @brief The main function of the background thread
+	auto flusherMain(std::stop_token stopToken) -> void;
+
+	/// @brief A number that identifies the tracer. Unlike its address, this is never reused by another tracer.
+	const std::uint64_t _id;
+
+	/// @brief The buffers, as seen by the background thread. The buffers are created when a thread first records an
+	/// event and no released buffer is available.
+	std::array<std::atomic<Buffer *>, kMaxThreads> _buffers {};
+	/// @brief The buffers that were created. The threads using a buffer also share ownership of it, so the buffer
+	/// stays valid for a thread that outlives the tracer.
+	std::array<std::shared_ptr<Buffer>, kMaxThreads> _ownedBuffers;
+	/// @brief A mutex that serializes claiming buffers
+	std::mutex _buffersMutex;
+
+	/// @brief The file
+	std::ofstream _file;
+	/// @brief Whether no event was written to the file yet
+	bool _firstEvent { true };
+	/// @brief A mutex that serializes writing to the file
+	std::mutex _fileMutex;
+	/// @brief The interval at which the events are written to the file
+	std::chrono::milliseconds _flushInterval { 1s };
+	/// @brief The background thread
+	std::jthread _flusherThread;
+};
+
+/// @brief Records the time between its construction and destruction as a trace event.
+///
+/// If no tracer is given, the span does nothing but check the tracer pointer, so that tracing costs a single predictable
+/// branch when disabled.
+class TraceSpan final
+{
+public:
+	/// @brief Starts the span
+	/// @param tracer The tracer, or nullptr if tracing is disabled
+	/// @param category The category. Must be a string literal.
+	/// @param name The name. Must be a string literal.
+	/// @param target The name of the object the span refers to. The string must outlive the tracer.
+	TraceSpan(Tracer *tracer, std::string_view category, std::string_view name, std::string_view target = {}) noexcept :
+		_tracer(tracer)
+	{
+		if (_tracer) [[unlikely]]
+		{
+			_event = { ._category = category, ._name = name, ._target = target, ._begin = std::chrono::steady_clock::now() };
+		}
+	}
+
+	/// @brief Marks the span as a block transaction
+	auto setBlock(std::uint64_t address, std::size_t size) noexcept -> void
+	{
+		_event._address = address;
+		_event._size = size;
+	}
+
+	/// @brief Ends the span and records it
+	~TraceSpan()
+	{
+		if (_tracer) [[unlikely]]
+		{
+			_event._end = std::chrono::steady_clock::now();
+			_tracer->record(_event);
+		}
+	}
+
+	/// @brief Spans cannot be copied
+	TraceSpan(const TraceSpan &) = delete;
+	/// @brief Spans cannot be copied
+	auto operator=(const TraceSpan &) -> TraceSpan & = delete;
+
+private:
+	/// @brief The tracer, or nullptr if tracing is disabled
+	Tracer *_tracer;
+	/// @brief The event being recorded
+	Tracer::Event _event;
+};
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,155 @@
+// Copyright (c) embedded ocean GmbH
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace xentara::plugins::templateDriver
+{
+
+WorkerPool::~WorkerPool()
+{
+	stop();
+}
+
+auto WorkerPool::addUser() -> void
+{
+	std::scoped_lock lock { _usersMutex };
+
+	// Start the threads for the first user
+	if (_userCount++ == 0)
+	{
+		start();
+	}
+}
+
+auto WorkerPool::removeUser() -> void
+{
+	std::scoped_lock lock { _usersMutex };
+
+	// Stop the threads when the last user goes away
+	if (--_userCount == 0)
+	{
+		stop();
+	}
+}
+
+auto WorkerPool::submit(Job &job) -> void
+{
+	job._done.store(false, std::memory_order_relaxed);
+
+	// Count the job before queueing it. A worker may take the job as soon as it is in a queue, and must never decrement
+	// the counter below zero. A worker that sees the count before the job is queued just looks through the queues again.
+	_queuedJobs.fetch_add(1, std::memory_order_release);
+
+	// Distribute the jobs round robin across the queues
+	const auto index = _nextQueue.fetch_add(1, std::memory_order_relaxed) % _workers.size();
+	auto &worker = *_workers[index];
+	{
+		std::scoped_lock lock { worker._mutex };
+		worker._jobs.push_back(&job);
+	}
+
+	// Wake up a worker
+	_queuedJobs.notify_one();
+}
+
+auto WorkerPool::start() -> void
+{
+	// Use one worker per hardware thread, unless configured otherwise
+	const std::size_t threadCount = _threadCount != 0 ? _threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+
+	_stopping.store(false, std::memory_order_relaxed);
+	_workers.clear();
+	_workers.reserve(threadCount);
+	for (std::size_t index = 0; index < threadCount; ++index)
+	{
+		_workers.push_back(std::make_unique<Worker>());
+	}
+
+	// Only start the threads once all the workers exist, because the threads access all the queues
+	for (std::size_t index = 0; index < threadCount; ++index)
+	{
+		_workers[index]->_thread = std::thread(&WorkerPool::workerMain, this, index);
+	}
+}
+
+auto WorkerPool::stop() -> void
+{
+	// Tell the workers to stop, and wake them all up
+	_stopping.store(true, std::memory_order_release);
+	_queuedJobs.fetch_add(1, std::memory_order_release);
+	_queuedJobs.notify_all();
+
+	// Wait for the threads to finish
+	for (auto &&worker : _workers)
+	{
+		if (worker->_thread.joinable())
+		{
+			worker->_thread.join();
+		}
+	}
+
+	_workers.clear();
+	_queuedJobs.store(0, std::memory_order_relaxed);
+}
+
+auto WorkerPool::workerMain(std::size_t index) -> void
+{
+	// Move the thread to the right CPUs and set the scheduling policy. If this fails, we just carry on with
+	// normal scheduling, but we let the user know, because the timing will not be what they configured.
+	if (!_placement.apply() && !_placementWarned.exchange(true, std::memory_order_relaxed))
+	{
+		/// @todo replace "template driver" with a more descriptive name
+		std::cerr << "warning: could not apply the configured CPUs or scheduling policy to the worker threads of the "
+			"template driver; the threads use normal scheduling. Real-time policies usually require CAP_SYS_NICE.\n";
+	}
+
+	while (!_stopping.load(std::memory_order_acquire))
+	{
+		// Execute the next job, if there is one
+		if (auto job = takeJob(index))
+		{
+			_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+			job->execute();
+			job->finish();
+			continue;
+		}
+
+		// Wait until new jobs are submitted
+		_queuedJobs.wait(0, std::memory_order_acquire);
+	}
+}
+
+auto WorkerPool::takeJob(std::size_t index) -> Job *
+{
+	// Try our own queue first, taking the most recently submitted job
+	{
+		auto &worker = *_workers[index];
+		std::scoped_lock lock { worker._mutex };
+		if (!worker._jobs.empty())
+		{
+			auto job = worker._jobs.back();
+			worker._jobs.pop_back();
+			return job;
+		}
+	}
+
+	// Steal the oldest job from one of the other queues
+	const auto workerCount = _workers.size();
+	for (std::size_t offset = 1; offset < workerCount; ++offset)
+	{
+		auto &victim = *_workers[(index + offset) % workerCount];
+		std::scoped_lock lock { victim._mutex };
+		if (!victim._jobs.empty())
+		{
+			auto job = victim._jobs.front();
+			victim._jobs.pop_front();
+			return job;
+		}
+	}
+
+	return nullptr;
+}
+
+} // namespace xentara::plugins::templateDriver
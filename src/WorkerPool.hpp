@@ -0,0 +1,163 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include "CacheLine.hpp"
+#include "ThreadPlacement.hpp"
+
+#include <xentara/utils/tools/Unique.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief A pool of worker threads shared by all I/O components of the driver.
+///
+/// Each worker has its own job queue. Jobs submitted to the pool are distributed round robin across the queues.
+/// Workers take jobs from the back of their own queue, and steal jobs from the front of the other queues if their
+/// own queue is empty. This keeps all workers busy even if the jobs take very different amounts of time.
+///
+/// The worker threads are only started once the first user registers with the pool, and are stopped again once
+/// the last user unregisters.
+class WorkerPool final : private utils::tools::Unique
+{
+public:
+	/// @brief A job that can be executed by the pool
+	class Job
+	{
+	public:
+		/// @brief Virtual destructor
+		virtual ~Job() = default;
+
+		/// @brief Waits until the job has finished executing.
+		/// 
+		/// Returns immediately if the job was never submitted.
+		auto wait() const noexcept -> void
+		{
+			_done.wait(false, std::memory_order_acquire);
+		}
+
+		/// @brief Checks whether the job has finished executing, without waiting
+		/// 
+		/// Returns true if the job was never submitted.
+		auto done() const noexcept -> bool
+		{
+			return _done.load(std::memory_order_acquire);
+		}
+
+		/// @brief Runs the job on the calling thread
+		auto run() noexcept -> void
+		{
+			_done.store(false, std::memory_order_relaxed);
+			execute();
+			finish();
+		}
+
+	protected:
+		/// @brief Executes the job
+		virtual auto execute() noexcept -> void = 0;
+
+	private:
+		/// @brief The pool needs access to our private member functions
+		friend class WorkerPool;
+
+		/// @brief Marks the job as finished and wakes up any waiting threads
+		auto finish() noexcept -> void
+		{
+			_done.store(true, std::memory_order_release);
+			_done.notify_all();
+		}
+
+		/// @brief Whether the job has finished executing.
+		std::atomic<bool> _done { true };
+	};
+
+	/// @brief The default constructor creates a pool with one worker per hardware thread
+	WorkerPool() = default;
+
+	/// @brief Constructor for a pool with a specific number of placed worker threads
+	/// @param threadCount The number of worker threads
+	/// @param placement The CPUs and scheduling policy for the worker threads
+	WorkerPool(std::size_t threadCount, ThreadPlacement placement) :
+		_threadCount(threadCount), _placement(std::move(placement))
+	{
+	}
+
+	/// @brief The destructor stops all the workers
+	~WorkerPool();
+
+	/// @brief Registers a user with the pool, starting the worker threads if necessary
+	auto addUser() -> void;
+
+	/// @brief Unregisters a user from the pool, stopping the worker threads if this was the last user
+	auto removeUser() -> void;
+
+	/// @brief Submits a job to the pool
+	/// @param job The job. The job must remain valid until it has finished executing. The job must not be submitted
+	/// again until it has finished executing.
+	/// @pre At least one user must be registered.
+	auto submit(Job &job) -> void;
+
+private:
+	/// @brief A worker thread with its own queue
+	/// @note The worker is aligned to a cache line to prevent false sharing between the queues
+	struct alignas(kCacheLineSize) Worker final
+	{
+		/// @brief The mutex protecting the queue
+		std::mutex _mutex;
+		/// @brief The jobs queued for this worker
+		std::deque<Job *> _jobs;
+		/// @brief The thread
+		std::thread _thread;
+	};
+
+	/// @brief Starts the worker threads
+	auto start() -> void;
+	/// @brief Stops the worker threads
+	auto stop() -> void;
+
+	/// @brief The main function of the worker threads
+	/// @param index The index of the worker
+	auto workerMain(std::size_t index) -> void;
+
+	/// @brief Takes the next job for a worker, stealing from the other workers if necessary
+	/// @param index The index of the worker
+	/// @return The job, or nullptr if there are no jobs queued anywhere
+	auto takeJob(std::size_t index) -> Job *;
+
+	/// @brief The number of worker threads, or 0 for one per hardware thread
+	std::size_t _threadCount { 0 };
+	/// @brief The CPUs and scheduling policy for the worker threads
+	ThreadPlacement _placement;
+	/// @brief Whether a warning was already logged because the placement could not be applied to a worker thread.
+	///
+	/// The warning is only logged once, because the reason is usually the same for all the threads.
+	std::atomic<bool> _placementWarned { false };
+
+	/// @brief The mutex protecting the user count
+	std::mutex _usersMutex;
+	/// @brief The number of registered users
+	std::size_t _userCount { 0 };
+
+	/// @brief The workers
+	std::vector<std::unique_ptr<Worker>> _workers;
+
+	/// @brief The number of jobs that are queued but have not been taken by a worker yet.
+	/// 
+	/// The idle workers wait on this counter to become non-zero.
+	alignas(kCacheLineSize) std::atomic<std::size_t> _queuedJobs { 0 };
+	/// @brief Whether the workers should stop
+	std::atomic<bool> _stopping { false };
+	/// @brief The index of the queue the next job will be submitted to
+	std::atomic<std::size_t> _nextQueue { 0 };
+};
+
+} // namespace xentara::plugins::templateDriver
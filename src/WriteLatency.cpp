@@ -0,0 +1,55 @@
+// Copyright (c) embedded ocean GmbH
+#include "WriteLatency.hpp"
+
+#include <xentara/memory/memoryResources.hpp>
+#include <xentara/memory/WriteSentinel.hpp>
+
+#include <algorithm>
+
+namespace xentara::plugins::templateDriver
+{
+
+auto WriteLatency::publish() -> void
+{
+	// If nothing was written, just bail
+	if (!_cycleLatency)
+	{
+		return;
+	}
+
+	_peakLatency = std::max(_peakLatency, *_cycleLatency);
+
+	// Make a write sentinel and commit the latencies
+	memory::WriteSentinel sentinel { _dataBlock };
+	sentinel->_latency = std::chrono::duration<double>(*_cycleLatency).count();
+	sentinel->_peakLatency = std::chrono::duration<double>(_peakLatency).count();
+	sentinel.commit();
+
+	_cycleLatency.reset();
+}
+
+auto WriteLatency::forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool
+{
+	// Handle all the attributes we support
+	return
+		function(_latencyAttribute) ||
+		function(_peakLatencyAttribute);
+}
+
+auto WriteLatency::latencyReadHandle() const noexcept -> data::ReadHandle
+{
+	return _dataBlock.member(&State::_latency);
+}
+
+auto WriteLatency::peakLatencyReadHandle() const noexcept -> data::ReadHandle
+{
+	return _dataBlock.member(&State::_peakLatency);
+}
+
+auto WriteLatency::realize() -> void
+{
+	// Create the data block
+	_dataBlock.create(memory::memoryResources::data());
+}
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,79 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <xentara/data/ReadHandle.hpp>
+#include <xentara/memory/ObjectBlock.hpp>
+#include <xentara/model/Attribute.hpp>
+#include <xentara/model/ForEachAttributeFunction.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <optional>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief Latency statistics for the writes of a write priority.
+///
+/// The latency of a write is the time from when a value was first scheduled to when it was written to the I/O component.
+/// The statistics contain the largest latency of the last cycle that wrote any values, and the largest latency ever.
+class WriteLatency final
+{
+public:
+	/// @brief Constructor
+	/// @param latencyAttribute The attribute containing the largest latency of the last cycle
+	/// @param peakLatencyAttribute The attribute containing the largest latency ever
+	WriteLatency(const model::Attribute &latencyAttribute, const model::Attribute &peakLatencyAttribute) :
+		_latencyAttribute(latencyAttribute), _peakLatencyAttribute(peakLatencyAttribute)
+	{
+	}
+
+	/// @brief Records the latency of a write
+	auto record(std::chrono::steady_clock::duration latency) noexcept -> void
+	{
+		_cycleLatency = std::max(_cycleLatency.value_or(latency), latency);
+	}
+
+	/// @brief Publishes the latencies recorded since the last call, if any
+	auto publish() -> void;
+
+	/// @brief Iterates over all the attributes that belong to the statistics.
+	/// @param function The function that should be called for each attribute
+	/// @return The return value of the last function call
+	auto forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool;
+
+	/// @brief Creates a read-handle for the largest latency of the last cycle
+	auto latencyReadHandle() const noexcept -> data::ReadHandle;
+
+	/// @brief Creates a read-handle for the largest latency ever
+	auto peakLatencyReadHandle() const noexcept -> data::ReadHandle;
+
+	/// @brief Realizes the statistics
+	auto realize() -> void;
+
+private:
+	/// @brief This structure is used to represent the state inside the memory block
+	struct State final
+	{
+		/// @brief The largest latency of the last cycle, in seconds
+		double _latency { 0 };
+		/// @brief The largest latency ever, in seconds
+		double _peakLatency { 0 };
+	};
+
+	/// @brief The attribute containing the largest latency of the last cycle
+	std::reference_wrapper<const model::Attribute> _latencyAttribute;
+	/// @brief The attribute containing the largest latency ever
+	std::reference_wrapper<const model::Attribute> _peakLatencyAttribute;
+
+	/// @brief The largest latency recorded since the last call to publish(), or std::nullopt if none were recorded
+	std::optional<std::chrono::steady_clock::duration> _cycleLatency;
+	/// @brief The largest latency ever
+	std::chrono::steady_clock::duration _peakLatency { 0 };
+
+	/// @brief The data block that contains the state
+	memory::ObjectBlock<State> _dataBlock;
+};
+
+} // namespace xentara::plugins::templateDriver
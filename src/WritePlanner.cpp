@@ -0,0 +1,629 @@
+// Copyright (c) embedded ocean GmbH
+#include "WritePlanner.hpp"
+
+#include "AbstractTemplateOutputHandler.hpp"
+#include "PackedWord.hpp"
+#include "ReadHandleTable.hpp"
+#include "TemplateIoComponent.hpp"
+#include "TemplateOutput.hpp"
+#include "Tracer.hpp"
+#include "WriteRateLimiter.hpp"
+
+#include <xentara/memory/memoryResources.hpp>
+#include <xentara/memory/WriteSentinel.hpp>
+#include <xentara/utils/eh/currentErrorCode.hpp>
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+namespace xentara::plugins::templateDriver
+{
+
+using namespace std::literals;
+
+auto WritePlanner::addOutput(std::reference_wrapper<TemplateOutput> output) -> void
+{
+	_outputs.push_back(output);
+}
+
+auto WritePlanner::prepare(std::size_t maxBlockSize, WriteRateLimiter *rateLimiter) -> void
+{
+	_maxBlockSize = maxBlockSize;
+	_rateLimiter = rateLimiter;
+
+	for (auto &&lane : _lanes)
+	{
+		lane._entries.clear();
+		lane._individualOutputs.clear();
+		lane._bitEntries.clear();
+	}
+
+	// Sort the outputs into lanes, and into those that can be written in blocks, and those that must be written individually
+	std::array<std::size_t, kWritePriorityCount> laneSizes {};
+	for (auto &&output : _outputs)
+	{
+		// prepare() must not be called before the configuration was loaded, so the handler should have been
+		// created already.
+		if (!output.get()._handler) [[unlikely]]
+		{
+			throw std::logic_error("internal error: xentara::plugins::templateDriver::WritePlanner::prepare() called before configuration has been loaded");
+		}
+		auto &handler = *output.get()._handler;
+		auto &lane = _lanes[std::size_t(output.get()._writePriority)];
+		handler.setScheduledFlag(&lane._scheduled);
+
+		// Outputs mapped to a bit are written together with the other bits of the same word. The output has checked that
+		// it has an address.
+		if (output.get()._bit)
+		{
+			const auto address = output.get()._address.value_or(0);
+			lane._bitEntries.push_back(
+				{ address, std::uint64_t(1) << *output.get()._bit, handler, _ioComponent.get().packedWord(address) });
+			continue;
+		}
+
+		// Only outputs with an address and a fixed size can be part of a block
+		const auto size = handler.valueSize();
+		if (output.get()._address && size > 0)
+		{
+			lane._entries.push_back({ *output.get()._address, size, handler });
+			laneSizes[std::size_t(output.get()._writePriority)] += size;
+		}
+		else
+		{
+			lane._individualOutputs.push_back({ handler, output.get()._traceName });
+		}
+	}
+
+	// Sort the entries by address once, so we don't have to sort them each cycle, and reserve enough space for the worst
+	// case, so that planning never needs to allocate memory. Each batch only ever holds the values of its own lane, so
+	// its buffer never needs more than the size of the lane's entries.
+	for (std::size_t laneIndex = 0; laneIndex < _lanes.size(); ++laneIndex)
+	{
+		auto &lane = _lanes[laneIndex];
+		std::ranges::stable_sort(lane._entries, {}, &Entry::_address);
+		std::ranges::stable_sort(lane._bitEntries, {}, &BitEntry::_address);
+
+		lane._batch._blocks.reserve(lane._entries.size());
+		lane._batch._individualWrites.reserve(lane._individualOutputs.size());
+		lane._batch._blockMembers.reserve(lane._entries.size());
+		lane._batch._fillers.reserve(lane._entries.size());
+		lane._batch._buffer.reserve(laneSizes[laneIndex]);
+		lane._batch._wordWrites.reserve(lane._bitEntries.size());
+		lane._batch._wordMembers.reserve(lane._bitEntries.size());
+	}
+
+	// The preempting batch holds the values of all the lanes that have a higher priority than the preempted lane. Since
+	// the lowest priority lane can never preempt another one, it only needs room for the other lanes.
+	std::size_t preemptingEntries = 0;
+	std::size_t preemptingIndividualOutputs = 0;
+	std::size_t preemptingBitEntries = 0;
+	std::size_t preemptingSize = 0;
+	for (std::size_t laneIndex = 0; laneIndex + 1 < _lanes.size(); ++laneIndex)
+	{
+		const auto &lane = _lanes[laneIndex];
+		preemptingEntries += lane._entries.size();
+		preemptingIndividualOutputs += lane._individualOutputs.size();
+		preemptingBitEntries += lane._bitEntries.size();
+		preemptingSize += laneSizes[laneIndex];
+	}
+	_preemptingBatch._blocks.reserve(preemptingEntries);
+	_preemptingBatch._individualWrites.reserve(preemptingIndividualOutputs);
+	_preemptingBatch._blockMembers.reserve(preemptingEntries);
+	_preemptingBatch._fillers.reserve(preemptingEntries);
+	_preemptingBatch._buffer.reserve(preemptingSize);
+	_preemptingBatch._wordWrites.reserve(preemptingBitEntries);
+	_preemptingBatch._wordMembers.reserve(preemptingBitEntries);
+}
+
+auto WritePlanner::write(std::chrono::system_clock::time_point timeStamp) -> void
+{
+	plan();
+	execute();
+	commit(timeStamp);
+}
+
+auto WritePlanner::plan() -> void
+{
+	_planTime = std::chrono::steady_clock::now();
+	for (auto &&lane : _lanes)
+	{
+		lane._batch.clear();
+		// Values scheduled before now are planned below, or held back by the rate limit, so they must not preempt anything
+		lane._scheduled.store(false, std::memory_order_relaxed);
+	}
+	_preemptingBatch.clear();
+
+	// If the rate limit has been reached, leave all the values in their queues. Newer values will replace them, so
+	// that only the latest values are written once tokens become available.
+	if (_rateLimiter && !_rateLimiter->available())
+	{
+		const auto isPending = [](const AbstractTemplateOutputHandler &handler) { return handler.hasPendingValue(); };
+		std::uint64_t deferred = 0;
+		for (auto &&lane : _lanes)
+		{
+			deferred += std::uint64_t(
+				std::ranges::count_if(lane._individualOutputs, isPending, &IndividualOutput::_handler) +
+				std::ranges::count_if(lane._entries, isPending, &Entry::_handler) +
+				std::ranges::count_if(lane._bitEntries, isPending, &BitEntry::_handler));
+		}
+		if (deferred > 0)
+		{
+			_rateLimiter->countDeferredWrites(deferred);
+		}
+		return;
+	}
+
+	// Plan each lane separately
+	for (std::size_t laneIndex = 0; laneIndex < _lanes.size(); ++laneIndex)
+	{
+		planLane(_lanes[laneIndex]._batch, laneIndex, false);
+	}
+}
+
+auto WritePlanner::planLane(Batch &batch, std::size_t laneIndex, bool skipStaged) -> void
+{
+	const auto &lane = _lanes[laneIndex];
+
+	// Collect the pending values of the outputs that must be written individually
+	for (auto &&[handler, traceName] : lane._individualOutputs)
+	{
+		if (skipStaged && handler.get().hasStagedValue())
+		{
+			continue;
+		}
+
+		if (handler.get().stagePendingValue())
+		{
+			batch._individualWrites.push_back({ handler, traceName, laneIndex });
+		}
+	}
+
+	// Collect the pending values of the other outputs into blocks. We never extend blocks of other lanes.
+	bool blockOpen = false;
+	batch._fillers.clear();
+	for (std::size_t index = 0; index < lane._entries.size(); ++index)
+	{
+		const auto &entry = lane._entries[index];
+
+		// An output that was already written in this cycle can neither be written again, nor used to fill a gap,
+		// because its last written value is not up to date yet.
+		if (skipStaged && entry._handler.get().hasStagedValue())
+		{
+			blockOpen = false;
+			batch._fillers.clear();
+			continue;
+		}
+
+		// Entries without a pending value can only be used to fill gaps
+		if (!entry._handler.get().stagePendingValue())
+		{
+			if (blockOpen)
+			{
+				batch._fillers.push_back(index);
+			}
+			continue;
+		}
+
+		// Try to append the entry to the current block
+		if (blockOpen)
+		{
+			const auto &block = batch._blocks.back();
+			const auto blockEnd = block._address + block._size;
+			if (entry._address >= blockEnd &&
+				entry._address + entry._size - block._address <= _maxBlockSize &&
+				canFillGap(batch, lane._entries, blockEnd, entry._address))
+			{
+				// Fill the gap using the last written values
+				for (auto filler : batch._fillers)
+				{
+					appendData(batch, lane._entries[filler], false);
+				}
+				appendData(batch, entry, true);
+
+				batch._fillers.clear();
+				continue;
+			}
+		}
+
+		// Start a new block
+		batch._blocks.push_back({ entry._address, batch._buffer.size(), 0, batch._blockMembers.size(), 0, laneIndex });
+		appendData(batch, entry, true);
+		batch._fillers.clear();
+		blockOpen = true;
+	}
+
+	// Merge the pending values of the outputs mapped to the same word. The entries are sorted by address, so all the
+	// outputs of a word are adjacent. We never merge into words of other lanes.
+	const auto firstWordWrite = batch._wordWrites.size();
+	for (auto &&entry : lane._bitEntries)
+	{
+		if (skipStaged && entry._handler.get().hasStagedValue())
+		{
+			continue;
+		}
+
+		if (!entry._handler.get().stagePendingValue())
+		{
+			continue;
+		}
+
+		// Start a new word write, unless the last one is for the same word
+		if (batch._wordWrites.size() == firstWordWrite || batch._wordWrites.back()._address != entry._address)
+		{
+			batch._wordWrites.push_back({ entry._address, &entry._word.get(), 0, 0, batch._wordMembers.size(), 0, laneIndex });
+		}
+		auto &write = batch._wordWrites.back();
+
+		// Set or clear the bit without branching. If two outputs are mapped to the same bit, the last one wins.
+		const auto bits = std::uint64_t(0) - std::uint64_t(entry._handler.get().stagedBit());
+		write._mask |= entry._mask;
+		write._bits = (write._bits & ~entry._mask) | (bits & entry._mask);
+
+		batch._wordMembers.push_back(entry._handler);
+		++write._memberCount;
+	}
+}
+
+auto WritePlanner::execute() -> void
+{
+	_writeCount = 0;
+
+	// Write the lanes in order of priority. The highest priority lane cannot be preempted.
+	for (std::size_t laneIndex = 0; laneIndex < _lanes.size(); ++laneIndex)
+	{
+		if (!executeBatch(_lanes[laneIndex]._batch, laneIndex > 0))
+		{
+			continue;
+		}
+
+		// Defer the remaining writes of this lane and all lower priority lanes
+		for (auto &&lane : std::span(_lanes).subspan(laneIndex))
+		{
+			preemptBatch(lane._batch);
+		}
+
+		// Write the new higher priority values right away
+		for (std::size_t higherLane = 0; higherLane < laneIndex; ++higherLane)
+		{
+			planLane(_preemptingBatch, higherLane, true);
+		}
+		executeBatch(_preemptingBatch, false);
+		break;
+	}
+
+	// Pay for the writes. This may put the rate limiter into debt, which is paid off by deferring later writes.
+	if (_rateLimiter)
+	{
+		_rateLimiter->consume(double(_writeCount));
+	}
+}
+
+auto WritePlanner::executeBatch(Batch &batch, bool preemptible) -> bool
+{
+	// Write the outputs that are not part of a block individually
+	for (auto &&write : batch._individualWrites)
+	{
+		if (preemptible && higherPriorityPending(write._lane))
+		{
+			return true;
+		}
+
+		{
+			TraceSpan span(_ioComponent.get().tracer(), "device"sv, "write"sv, write._traceName);
+			write._error = write._handler.get().writeStagedValue();
+		}
+		write._writeTime = std::chrono::steady_clock::now();
+		write._outcome = Outcome::Written;
+		++_writeCount;
+	}
+
+	// Write the blocks
+	for (auto &&block : batch._blocks)
+	{
+		if (preemptible && higherPriorityPending(block._lane))
+		{
+			return true;
+		}
+
+		writeBlock(batch, block);
+	}
+
+	// Write the words
+	for (auto &&write : batch._wordWrites)
+	{
+		if (preemptible && higherPriorityPending(write._lane))
+		{
+			return true;
+		}
+
+		writeWord(write);
+	}
+
+	return false;
+}
+
+auto WritePlanner::writeBlock(Batch &batch, Block &block) -> void
+{
+	TraceSpan span(_ioComponent.get().tracer(), "device"sv, "write block"sv);
+	span.setBlock(block._address, block._size);
+
+	try
+	{
+		_ioComponent.get().writeBlock(block._address, std::span(batch._buffer).subspan(block._offset, block._size));
+		block._error.clear();
+	}
+	catch (const std::exception &)
+	{
+		// Get the error from the current exception using this special utility function
+		block._error = utils::eh::currentErrorCode();
+	}
+
+	block._writeTime = std::chrono::steady_clock::now();
+	block._outcome = Outcome::Written;
+	++_writeCount;
+}
+
+auto WritePlanner::writeWord(WordWrite &write) -> void
+{
+	TraceSpan span(_ioComponent.get().tracer(), "device"sv, "write word"sv);
+	span.setBlock(write._address, sizeof(std::uint64_t));
+
+	try
+	{
+		// Go through the word, so that the read-modify-write is not interleaved with that of a worker writing another bit
+		write._word->modify(write._mask, write._bits);
+		write._error.clear();
+	}
+	catch (const std::exception &)
+	{
+		// Get the error from the current exception using this special utility function
+		write._error = utils::eh::currentErrorCode();
+	}
+
+	write._writeTime = std::chrono::steady_clock::now();
+	write._outcome = Outcome::Written;
+	++_writeCount;
+}
+
+auto WritePlanner::preemptBatch(Batch &batch) -> void
+{
+	// Put back the values of the outputs that have not been written yet
+	for (auto &&write : batch._individualWrites)
+	{
+		if (write._outcome == Outcome::Planned)
+		{
+			write._handler.get().deferStagedValue();
+			write._outcome = Outcome::Preempted;
+		}
+	}
+	for (auto &&block : batch._blocks)
+	{
+		if (block._outcome == Outcome::Planned)
+		{
+			for (auto &&member : std::span(batch._blockMembers).subspan(block._firstMember, block._memberCount))
+			{
+				member.get().deferStagedValue();
+			}
+			block._outcome = Outcome::Preempted;
+		}
+	}
+	for (auto &&write : batch._wordWrites)
+	{
+		if (write._outcome == Outcome::Planned)
+		{
+			for (auto &&member : std::span(batch._wordMembers).subspan(write._firstMember, write._memberCount))
+			{
+				member.get().deferStagedValue();
+			}
+			write._outcome = Outcome::Preempted;
+		}
+	}
+}
+
+auto WritePlanner::higherPriorityPending(std::size_t laneIndex) noexcept -> bool
+{
+	// Values that were already pending when the writes were planned, but were not staged, are being held back by a
+	// rate limit, and must not preempt anything.
+	const auto isNewlyPending = [&](const AbstractTemplateOutputHandler &handler)
+	{
+		const auto pendingSince = handler.pendingSince();
+		return pendingSince && *pendingSince >= _planTime && !handler.hasStagedValue();
+	};
+
+	for (auto &&lane : std::span(_lanes).first(laneIndex))
+	{
+		// Only look at the outputs if a value was scheduled since the last check, which is rare. The flag is reset
+		// before looking, so that values scheduled while we look raise it again.
+		if (!lane._scheduled.exchange(false, std::memory_order_acquire))
+		{
+			continue;
+		}
+
+		if (std::ranges::any_of(lane._individualOutputs, isNewlyPending, &IndividualOutput::_handler) ||
+			std::ranges::any_of(lane._entries, isNewlyPending, &Entry::_handler) ||
+			std::ranges::any_of(lane._bitEntries, isNewlyPending, &BitEntry::_handler))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+auto WritePlanner::commit(std::chrono::system_clock::time_point timeStamp) -> void
+{
+	const auto preemptedWrites = _preemptedWrites;
+
+	// Update the states of the outputs
+	for (auto &&lane : _lanes)
+	{
+		commitBatch(lane._batch, timeStamp);
+	}
+	commitBatch(_preemptingBatch, timeStamp);
+
+	// Publish the statistics
+	for (auto &&lane : _lanes)
+	{
+		lane._latency.publish();
+	}
+	if (_preemptedWrites != preemptedWrites)
+	{
+		memory::WriteSentinel sentinel { _dataBlock };
+		sentinel->_preemptedWrites = _preemptedWrites;
+		sentinel.commit();
+	}
+}
+
+auto WritePlanner::commitBatch(Batch &batch, std::chrono::system_clock::time_point timeStamp) -> void
+{
+	// Update the states of the outputs written individually
+	for (auto &&write : batch._individualWrites)
+	{
+		if (write._outcome == Outcome::Preempted)
+		{
+			++_preemptedWrites;
+			continue;
+		}
+
+		if (!write._error)
+		{
+			recordLatency(write._lane, write._handler, write._writeTime);
+		}
+		write._handler.get().finishStagedWrite(timeStamp, write._error);
+	}
+
+	// Update the states of all the outputs whose pending values were part of a block
+	for (auto &&block : batch._blocks)
+	{
+		const auto members = std::span(batch._blockMembers).subspan(block._firstMember, block._memberCount);
+		if (block._outcome == Outcome::Preempted)
+		{
+			_preemptedWrites += members.size();
+			continue;
+		}
+
+		for (auto &&member : members)
+		{
+			if (!block._error)
+			{
+				recordLatency(block._lane, member, block._writeTime);
+			}
+			member.get().finishStagedWrite(timeStamp, block._error);
+		}
+	}
+
+	// Update the states of all the outputs whose pending values were merged into a word
+	for (auto &&write : batch._wordWrites)
+	{
+		const auto members = std::span(batch._wordMembers).subspan(write._firstMember, write._memberCount);
+		if (write._outcome == Outcome::Preempted)
+		{
+			_preemptedWrites += members.size();
+			continue;
+		}
+
+		for (auto &&member : members)
+		{
+			if (!write._error)
+			{
+				recordLatency(write._lane, member, write._writeTime);
+			}
+			member.get().finishStagedWrite(timeStamp, write._error);
+		}
+	}
+
+	batch.clear();
+}
+
+auto WritePlanner::recordLatency(std::size_t laneIndex, const AbstractTemplateOutputHandler &handler, std::chrono::steady_clock::time_point writeTime) -> void
+{
+	if (const auto stagedSince = handler.stagedSince())
+	{
+		_lanes[laneIndex]._latency.record(writeTime - *stagedSince);
+	}
+}
+
+auto WritePlanner::canFillGap(const Batch &batch, const std::vector<Entry> &entries, std::uint64_t gapStart, std::uint64_t gapEnd) const -> bool
+{
+	// The fillers must cover the gap without holes, and must all have a known value
+	auto cursor = gapStart;
+	for (auto filler : batch._fillers)
+	{
+		const auto &entry = entries[filler];
+		if (entry._address != cursor || !entry._handler.get().hasLastWrittenValue())
+		{
+			return false;
+		}
+		cursor += entry._size;
+	}
+
+	return cursor == gapEnd;
+}
+
+auto WritePlanner::appendData(Batch &batch, const Entry &entry, bool pending) -> void
+{
+	auto &block = batch._blocks.back();
+
+	// Make room for the data
+	const auto offset = batch._buffer.size();
+	batch._buffer.resize(offset + entry._size);
+	const auto data = std::span(batch._buffer).subspan(offset, entry._size);
+
+	// Encode either the pending value, or the last written value
+	if (pending)
+	{
+		entry._handler.get().encodeStagedValue(data);
+		batch._blockMembers.push_back(entry._handler);
+		++block._memberCount;
+	}
+	else
+	{
+		entry._handler.get().encodeLastWrittenValue(data);
+	}
+
+	block._size += entry._size;
+}
+
+auto WritePlanner::forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool
+{
+	// Handle the preemption counter
+	if (function(attributes::kPreemptedWrites))
+	{
+		return true;
+	}
+
+	// Handle the latency statistics of the lanes
+	return std::ranges::any_of(_lanes, [&](const Lane &lane) { return lane._latency.forEachAttribute(function); });
+}
+
+auto WritePlanner::makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>
+{
+	// All the attributes we support, including the latency statistics of the lanes
+	static constexpr std::array<ReadHandleEntry<WritePlanner>, 7> kReadHandles { {
+		{ &attributes::kPreemptedWrites, [](const WritePlanner &self) { return data::ReadHandle(self._dataBlock.member(&State::_preemptedWrites)); } },
+		{ &attributes::kCriticalWriteLatency, [](const WritePlanner &self) { return self._lanes[std::size_t(WritePriority::Critical)]._latency.latencyReadHandle(); } },
+		{ &attributes::kCriticalPeakWriteLatency, [](const WritePlanner &self) { return self._lanes[std::size_t(WritePriority::Critical)]._latency.peakLatencyReadHandle(); } },
+		{ &attributes::kNormalWriteLatency, [](const WritePlanner &self) { return self._lanes[std::size_t(WritePriority::Normal)]._latency.latencyReadHandle(); } },
+		{ &attributes::kNormalPeakWriteLatency, [](const WritePlanner &self) { return self._lanes[std::size_t(WritePriority::Normal)]._latency.peakLatencyReadHandle(); } },
+		{ &attributes::kBulkWriteLatency, [](const WritePlanner &self) { return self._lanes[std::size_t(WritePriority::Bulk)]._latency.latencyReadHandle(); } },
+		{ &attributes::kBulkPeakWriteLatency, [](const WritePlanner &self) { return self._lanes[std::size_t(WritePriority::Bulk)]._latency.peakLatencyReadHandle(); } }
+	} };
+
+	return lookUpReadHandle<kReadHandles>(*this, attribute);
+}
+
+auto WritePlanner::realize() -> void
+{
+	// Create the data blocks
+	_dataBlock.create(memory::memoryResources::data());
+	for (auto &&lane : _lanes)
+	{
+		lane._latency.realize();
+	}
+}
+
+} // namespace xentara::plugins::templateDriver
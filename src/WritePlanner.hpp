@@ -0,0 +1,348 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include "Attributes.hpp"
+#include "CacheLine.hpp"
+#include "WriteLatency.hpp"
+#include "WritePriority.hpp"
+
+#include <xentara/data/ReadHandle.hpp>
+#include <xentara/memory/ObjectBlock.hpp>
+#include <xentara/model/Attribute.hpp>
+#include <xentara/model/ForEachAttributeFunction.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace xentara::plugins::templateDriver
+{
+
+class PackedWord;
+class TemplateIoComponent;
+class TemplateOutput;
+class AbstractTemplateOutputHandler;
+class WriteRateLimiter;
+
+/// @brief Plans and performs the writes for all the outputs of an I/O component.
+///
+/// The planner collects all outputs that have a pending value, and merges outputs with adjacent addresses into
+/// block writes. Gaps between two pending outputs are filled using the last value written to the outputs in between,
+/// if such values are known. Outputs that have no address, or whose values do not have a fixed size, are written individually.
+///
+/// Boolean outputs that are mapped to a bit of a word are not written by themselves. Instead, the pending values of all
+/// the outputs mapped to the same word are merged into a single read-modify-write of the word.
+///
+/// The outputs are divided into lanes according to their write priority, and the lanes are written in order of priority.
+/// Blocks never span several lanes. Before each write of a lower priority lane, the planner checks whether a higher
+/// priority output has become pending. If so, the remaining lower priority writes are deferred to the next cycle, and the
+/// higher priority values are written right away. The outputs of each lane raise a shared flag whenever a value is scheduled,
+/// so that the check only needs to look at the outputs of a lane if the flag of the lane was raised.
+///
+/// If the I/O component has a write rate limit, each block write and each individual write takes one token. If no
+/// tokens are available, all pending values are left in their queues until the next cycle.
+class WritePlanner final
+{
+public:
+	/// @brief This constuctor attaches the planner to its I/O component
+	WritePlanner(std::reference_wrapper<TemplateIoComponent> ioComponent) : _ioComponent(ioComponent)
+	{
+	}
+
+	/// @brief Adds an output to the planner
+	/// @note The configuration of the output need not be loaded yet when this function is called.
+	auto addOutput(std::reference_wrapper<TemplateOutput> output) -> void;
+
+	/// @brief Prepares the planner for use
+	///
+	/// This function sorts the outputs by address. It must be called after the configuration of all the outputs
+	/// was loaded.
+	/// @param maxBlockSize The maximum number of bytes that can be written using a single block write
+	/// @param rateLimiter The rate limiter of the I/O component, or nullptr if the write rate is not limited
+	auto prepare(std::size_t maxBlockSize, WriteRateLimiter *rateLimiter) -> void;
+
+	/// @brief Writes all pending values
+	///
+	/// This is the same as calling plan(), execute() and commit() in sequence.
+	/// @param timeStamp The time stamp to use for the write states of the outputs
+	auto write(std::chrono::system_clock::time_point timeStamp) -> void;
+
+	/// @brief Collects the pending values and builds the blocks
+	auto plan() -> void;
+
+	/// @brief Writes the values collected by plan() to the I/O component.
+	///
+	/// This function does not update the states of the outputs, and can therefore be called from a worker thread.
+	auto execute() -> void;
+
+	/// @brief Updates the states of the outputs written by execute()
+	/// @param timeStamp The time stamp to use for the write states of the outputs
+	auto commit(std::chrono::system_clock::time_point timeStamp) -> void;
+
+	/// @brief Iterates over all the attributes that belong to the planner.
+	/// @param function The function that should be called for each attribute
+	/// @return The return value of the last function call
+	auto forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool;
+
+	/// @brief Creates a read-handle for an attribute that belongs to the planner.
+	/// @param attribute The attribute to create the handle for
+	/// @return A read handle for the attribute, or std::nullopt if the attribute is unknown
+	auto makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>;
+
+	/// @brief Realizes the planner
+	auto realize() -> void;
+
+private:
+	/// @brief An output that has an address
+	struct Entry final
+	{
+		/// @brief The first address of the output
+		std::uint64_t _address {};
+		/// @brief The number of bytes occupied by the output
+		std::size_t _size {};
+		/// @brief The handler of the output
+		std::reference_wrapper<AbstractTemplateOutputHandler> _handler;
+	};
+
+	/// @brief An output that is mapped to a bit of a word
+	struct BitEntry final
+	{
+		/// @brief The address of the word
+		std::uint64_t _address {};
+		/// @brief The mask of the bit within the word
+		std::uint64_t _mask {};
+		/// @brief The handler of the output
+		std::reference_wrapper<AbstractTemplateOutputHandler> _handler;
+		/// @brief The word, which serializes the read-modify-write operations on it
+		std::reference_wrapper<PackedWord> _word;
+	};
+
+	/// @brief What happened to a planned write
+	enum class Outcome
+	{
+		/// @brief The write has not been performed yet
+		Planned,
+		/// @brief The write was performed
+		Written,
+		/// @brief The write was deferred because higher priority values became pending
+		Preempted
+	};
+
+	/// @brief A block of consecutive bytes that are written using a single write command
+	struct Block final
+	{
+		/// @brief The first address of the block
+		std::uint64_t _address {};
+		/// @brief The offset of the data within the buffer of the batch
+		std::size_t _offset {};
+		/// @brief The number of bytes in the block
+		std::size_t _size {};
+		/// @brief The index of the first pending output within the block members of the batch
+		std::size_t _firstMember {};
+		/// @brief The number of pending outputs contained in the block
+		std::size_t _memberCount {};
+		/// @brief The lane the block belongs to
+		std::size_t _lane {};
+		/// @brief What happened to the block
+		Outcome _outcome { Outcome::Planned };
+		/// @brief The time the block was written
+		std::chrono::steady_clock::time_point _writeTime;
+		/// @brief The error that occurred writing the block, or a default constructed std::error_code object for none.
+		std::error_code _error;
+	};
+
+	/// @brief The bits of a word that are changed using a single read-modify-write operation
+	struct WordWrite final
+	{
+		/// @brief The address of the word
+		std::uint64_t _address {};
+		/// @brief The word
+		PackedWord *_word { nullptr };
+		/// @brief The bits to change
+		std::uint64_t _mask {};
+		/// @brief The new values of the bits in _mask
+		std::uint64_t _bits {};
+		/// @brief The index of the first pending output within the word members of the batch
+		std::size_t _firstMember {};
+		/// @brief The number of pending outputs mapped to the word
+		std::size_t _memberCount {};
+		/// @brief The lane the write belongs to
+		std::size_t _lane {};
+		/// @brief What happened to the write
+		Outcome _outcome { Outcome::Planned };
+		/// @brief The time the word was written
+		std::chrono::steady_clock::time_point _writeTime;
+		/// @brief The error that occurred writing the word, or a default constructed std::error_code object for none.
+		std::error_code _error;
+	};
+
+	/// @brief An output that must be written individually
+	struct IndividualOutput final
+	{
+		/// @brief The handler of the output
+		std::reference_wrapper<AbstractTemplateOutputHandler> _handler;
+		/// @brief The name of the output in trace files
+		std::string_view _traceName;
+	};
+
+	/// @brief An output that is written individually
+	struct IndividualWrite final
+	{
+		/// @brief The handler of the output
+		std::reference_wrapper<AbstractTemplateOutputHandler> _handler;
+		/// @brief The name of the output in trace files
+		std::string_view _traceName;
+		/// @brief The lane the output belongs to
+		std::size_t _lane {};
+		/// @brief What happened to the write
+		Outcome _outcome { Outcome::Planned };
+		/// @brief The time the value was written
+		std::chrono::steady_clock::time_point _writeTime;
+		/// @brief The error that occurred writing the value, or a default constructed std::error_code object for none.
+		std::error_code _error;
+	};
+
+	/// @brief The writes planned for a cycle
+	struct Batch final
+	{
+		/// @brief Removes all planned writes
+		auto clear() noexcept -> void
+		{
+			_individualWrites.clear();
+			_blocks.clear();
+			_blockMembers.clear();
+			_buffer.clear();
+			_fillers.clear();
+			_wordWrites.clear();
+			_wordMembers.clear();
+		}
+
+		/// @brief The outputs planned to be written individually
+		std::vector<IndividualWrite> _individualWrites;
+		/// @brief The planned blocks
+		std::vector<Block> _blocks;
+		/// @brief The handlers of the pending outputs contained in the blocks, in block order
+		std::vector<std::reference_wrapper<AbstractTemplateOutputHandler>> _blockMembers;
+		/// @brief The data for all the blocks
+		std::vector<std::byte> _buffer;
+		/// @brief The indices of the entries without pending values that follow the last pending entry of the current block
+		std::vector<std::size_t> _fillers;
+		/// @brief The planned read-modify-writes of words
+		std::vector<WordWrite> _wordWrites;
+		/// @brief The handlers of the pending outputs mapped to the words, in word order
+		std::vector<std::reference_wrapper<AbstractTemplateOutputHandler>> _wordMembers;
+	};
+
+	/// @brief The outputs of a single write priority
+	struct Lane final
+	{
+		/// @brief The latency statistics of the lane
+		WriteLatency _latency;
+		/// @brief The outputs that have an address and a fixed size, sorted by address
+		std::vector<Entry> _entries {};
+		/// @brief The outputs that must be written individually
+		std::vector<IndividualOutput> _individualOutputs {};
+		/// @brief The outputs that are mapped to a bit of a word, sorted by address
+		std::vector<BitEntry> _bitEntries {};
+		/// @brief The writes planned for the current cycle
+		Batch _batch {};
+		/// @brief A flag that the outputs raise when a value is scheduled, and that is reset by the planner.
+		///
+		/// The flag is written by the application threads, so it gets its own cache line.
+		alignas(kCacheLineSize) std::atomic<bool> _scheduled { false };
+	};
+
+	/// @brief This structure is used to represent the state inside the memory block
+	struct State final
+	{
+		/// @brief The total number of writes that were deferred because higher priority values became pending
+		std::uint64_t _preemptedWrites { 0 };
+	};
+
+	/// @brief Adds the pending values of a lane to a batch
+	/// @param batch The batch
+	/// @param laneIndex The index of the lane
+	/// @param skipStaged Whether to skip outputs that already have a staged value. This is used when planning writes
+	/// that preempt lower priority writes, because these outputs were already written in the current cycle.
+	auto planLane(Batch &batch, std::size_t laneIndex, bool skipStaged) -> void;
+
+	/// @brief Performs the planned writes of a batch
+	/// @param batch The batch
+	/// @param preemptible Whether to check for higher priority values before each write
+	/// @return Whether the remaining writes were preempted by a higher priority value
+	auto executeBatch(Batch &batch, bool preemptible) -> bool;
+
+	/// @brief Defers all writes of a batch that have not been performed yet
+	auto preemptBatch(Batch &batch) -> void;
+
+	/// @brief Checks whether any output with a higher priority than a lane has a value that became pending after
+	/// the writes were planned, and that can still be written in this cycle
+	///
+	/// Only the outputs of lanes whose _scheduled flag was raised since the last check are looked at.
+	auto higherPriorityPending(std::size_t laneIndex) noexcept -> bool;
+
+	/// @brief Updates the states of the outputs written by a batch
+	auto commitBatch(Batch &batch, std::chrono::system_clock::time_point timeStamp) -> void;
+
+	/// @brief Records the latency of a written value
+	auto recordLatency(std::size_t laneIndex, const AbstractTemplateOutputHandler &handler, std::chrono::steady_clock::time_point writeTime) -> void;
+
+	/// @brief Writes a single block
+	auto writeBlock(Batch &batch, Block &block) -> void;
+
+	/// @brief Changes the bits of a single word
+	auto writeWord(WordWrite &write) -> void;
+
+	/// @brief Checks whether a gap can be filled using the last written values of the fillers of a batch
+	/// @param batch The batch
+	/// @param entries The entries of the lane
+	/// @param gapStart The end address of the current block
+	/// @param gapEnd The address of the next pending entry
+	auto canFillGap(const Batch &batch, const std::vector<Entry> &entries, std::uint64_t gapStart, std::uint64_t gapEnd) const -> bool;
+
+	/// @brief Appends the data of an entry to the current block of a batch
+	/// @param batch The batch
+	/// @param entry The entry
+	/// @param pending Whether to append the pending value of the entry, rather than the last written value
+	auto appendData(Batch &batch, const Entry &entry, bool pending) -> void;
+
+	/// @brief The I/O component the planner belongs to
+	std::reference_wrapper<TemplateIoComponent> _ioComponent;
+
+	/// @brief All the outputs of the I/O component, in the order they were added
+	std::vector<std::reference_wrapper<TemplateOutput>> _outputs;
+
+	/// @brief The lanes, in order of priority
+	std::array<Lane, kWritePriorityCount> _lanes {
+		Lane { ._latency { attributes::kCriticalWriteLatency, attributes::kCriticalPeakWriteLatency } },
+		Lane { ._latency { attributes::kNormalWriteLatency, attributes::kNormalPeakWriteLatency } },
+		Lane { ._latency { attributes::kBulkWriteLatency, attributes::kBulkPeakWriteLatency } }
+	};
+
+	/// @brief The writes performed ahead of preempted lower priority writes in the current cycle
+	Batch _preemptingBatch;
+
+	/// @brief The maximum number of bytes in a block
+	std::size_t _maxBlockSize { std::numeric_limits<std::size_t>::max() };
+	/// @brief The rate limiter of the I/O component, or nullptr if the write rate is not limited
+	WriteRateLimiter *_rateLimiter { nullptr };
+	/// @brief The time the writes of the current cycle were planned
+	std::chrono::steady_clock::time_point _planTime;
+	/// @brief The number of writes performed by the last call to execute()
+	std::size_t _writeCount { 0 };
+
+	/// @brief The total number of preempted writes, as published in the data block
+	std::uint64_t _preemptedWrites { 0 };
+	/// @brief The data block that contains the state
+	memory::ObjectBlock<State> _dataBlock;
+};
+
+} // namespace xentara::plugins::templateDriver
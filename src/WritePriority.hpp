@@ -0,0 +1,26 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <cstddef>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief The priority class of an output.
+///
+/// The I/O component writes the pending values of higher priority outputs before those of lower priority outputs,
+/// and defers writes of lower priority values if higher priority values become pending in the meantime.
+enum class WritePriority : std::size_t
+{
+	/// @brief For emergency and interlock outputs that must never wait for other writes
+	Critical,
+	/// @brief For regular outputs. This is the default.
+	Normal,
+	/// @brief For bulk transfers like recipe or setpoint downloads that may be delayed
+	Bulk
+};
+
+/// @brief The number of write priorities
+inline constexpr std::size_t kWritePriorityCount = 3;
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,68 @@
+// Copyright (c) embedded ocean GmbH
+#include "WriteRateLimiter.hpp"
+
+#include "Attributes.hpp"
+#include "ReadHandleTable.hpp"
+
+#include <xentara/memory/memoryResources.hpp>
+#include <xentara/memory/WriteSentinel.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace xentara::plugins::templateDriver
+{
+
+auto WriteRateLimiter::available() noexcept -> bool
+{
+	const auto now = std::chrono::steady_clock::now();
+
+	// The bucket starts out full
+	if (!_lastRefill)
+	{
+		_tokens = _burst;
+	}
+	// Add the tokens accumulated since the last refill, up to the capacity of the bucket
+	else
+	{
+		const std::chrono::duration<double> elapsed = now - *_lastRefill;
+		_tokens = std::min(_tokens + elapsed.count() * _rate, _burst);
+	}
+	_lastRefill = now;
+
+	return _tokens >= 1;
+}
+
+auto WriteRateLimiter::countDeferredWrites(std::uint64_t count) -> void
+{
+	_deferredWrites += count;
+
+	// Make a write sentinel and commit the new count
+	memory::WriteSentinel sentinel { _dataBlock };
+	sentinel->_deferredWrites = _deferredWrites;
+	sentinel.commit();
+}
+
+auto WriteRateLimiter::forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool
+{
+	// Handle all the attributes we support
+	return function(attributes::kDeferredWrites);
+}
+
+auto WriteRateLimiter::makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>
+{
+	// All the attributes we support
+	static constexpr std::array<ReadHandleEntry<WriteRateLimiter>, 1> kReadHandles { {
+		{ &attributes::kDeferredWrites, [](const WriteRateLimiter &self) { return data::ReadHandle(self._dataBlock.member(&State::_deferredWrites)); } }
+	} };
+
+	return lookUpReadHandle<kReadHandles>(*this, attribute);
+}
+
+auto WriteRateLimiter::realize() -> void
+{
+	// Create the data block
+	_dataBlock.create(memory::memoryResources::data());
+}
+
+} // namespace xentara::plugins::templateDriver
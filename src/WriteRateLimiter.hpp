@@ -0,0 +1,121 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <xentara/data/ReadHandle.hpp>
+#include <xentara/memory/ObjectBlock.hpp>
+#include <xentara/model/Attribute.hpp>
+#include <xentara/model/ForEachAttributeFunction.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief A token bucket that limits the rate at which values are written to the I/O component.
+///
+/// The bucket is refilled at a fixed rate, up to the configured burst size. Each write takes one token. Writes for
+/// which no token is available are deferred, and counted in the "deferredWrites" attribute.
+///
+/// The limiter is not thread safe. It must only be used by whichever thread performs the writes.
+class WriteRateLimiter final
+{
+public:
+	/// @brief Sets the rate at which the bucket is refilled
+	/// @param rate The maximum sustained number of writes per second, or 0 to disable rate limiting
+	auto setRate(double rate) noexcept -> void
+	{
+		_rate = rate;
+	}
+
+	/// @brief Sets the capacity of the bucket
+	/// @param burst The maximum number of writes that can be performed in quick succession. Must be at least 1.
+	auto setBurst(double burst) noexcept -> void
+	{
+		_burst = burst;
+	}
+
+	/// @brief Checks whether rate limiting is enabled
+	explicit operator bool() const noexcept
+	{
+		return _rate > 0;
+	}
+
+	/// @brief Refills the bucket, and checks whether there are any tokens left
+	///
+	/// This function does not take a token. Use it together with consume() if the number of writes is only known
+	/// after the writes were performed.
+	auto available() noexcept -> bool;
+
+	/// @brief Takes tokens from the bucket.
+	///
+	/// The bucket may go into debt, so that writes that took more tokens than available are paid for by deferring
+	/// subsequent writes.
+	/// @param count The number of tokens to take
+	auto consume(double count) noexcept -> void
+	{
+		_tokens -= count;
+	}
+
+	/// @brief Takes a single token from the bucket, if one is available
+	/// @return Whether a token was taken
+	auto tryAcquire() noexcept -> bool
+	{
+		if (!available())
+		{
+			return false;
+		}
+		consume(1);
+		return true;
+	}
+
+	/// @brief Adds writes that were deferred to the "deferredWrites" attribute
+	/// @param count The number of writes that were deferred
+	auto countDeferredWrites(std::uint64_t count) -> void;
+
+	/// @brief Iterates over all the attributes that belong to the limiter.
+	/// @param function The function that should be called for each attribute
+	/// @return The return value of the last function call
+	auto forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool;
+
+	/// @brief Creates a read-handle for an attribute that belongs to the limiter.
+	/// @param attribute The attribute to create the handle for
+	/// @return A read handle for the attribute, or std::nullopt if the attribute is unknown
+	auto makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>;
+
+	/// @brief Realizes the limiter
+	auto realize() -> void;
+
+	/// @brief Returns the size of the data block created by realize()
+	static constexpr auto dataBlockSize() noexcept -> std::size_t
+	{
+		return sizeof(State);
+	}
+
+private:
+	/// @brief This structure is used to represent the state inside the memory block
+	struct State final
+	{
+		/// @brief The total number of writes that were deferred because of the rate limit
+		std::uint64_t _deferredWrites { 0 };
+	};
+
+	/// @brief The number of tokens added per second, or 0 if rate limiting is disabled
+	double _rate { 0 };
+	/// @brief The maximum number of tokens in the bucket
+	double _burst { 1 };
+	/// @brief The number of tokens in the bucket. This may be negative if the bucket is in debt.
+	double _tokens { 0 };
+	/// @brief The time the bucket was last refilled, or std::nullopt if it was never refilled
+	std::optional<std::chrono::steady_clock::time_point> _lastRefill;
+
+	/// @brief The total number of deferred writes, as published in the data block
+	std::uint64_t _deferredWrites { 0 };
+
+	/// @brief The data block that contains the state
+	memory::ObjectBlock<State> _dataBlock;
+};
+
+} // namespace xentara::plugins::templateDriver
@@ -3,10 +3,13 @@
 
 #include "Attributes.hpp"
 #include "Events.hpp"
+#include "ReadHandleTable.hpp"
 
 #include <xentara/memory/memoryResources.hpp>
 #include <xentara/memory/WriteSentinel.hpp>
+#include <xentara/process/EventList.hpp>
 
+#include <array>
 #include <string_view>
 
 namespace xentara::plugins::templateDriver
@@ -24,35 +27,74 @@ auto WriteState::forEachAttribute(const model::ForEachAttributeFunction &functio
 
 auto WriteState::forEachEvent(const model::ForEachEventFunction &function, std::shared_ptr<void> parent) -> bool
 {
+	// Create the events the first time they are needed
+	if (!_writtenEvent)
+	{
+		_writtenEvent = std::make_unique<process::Event>(io::Direction::Output);
+		_writeErrorEvent = std::make_unique<process::Event>(io::Direction::Output);
+	}
+
 	// Handle all the events we support
 	return
-		function(events::kWritten, std::shared_ptr<process::Event>(parent, &_writtenEvent)) ||
-		function(attributes::kWriteError, std::shared_ptr<process::Event>(parent, &_writeErrorEvent));
+		function(events::kWritten, std::shared_ptr<process::Event>(parent, _writtenEvent.get())) ||
+		function(attributes::kWriteError, std::shared_ptr<process::Event>(parent, _writeErrorEvent.get()));
 }
 
 auto WriteState::makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>
 {
-	// Try each readable attribute
-	if (attribute == model::Attribute::kWriteTime)
-	{
-		return _dataBlock.member(&State::_writeTime);
-	}
-	else if (attribute == attributes::kWriteError)
+	// All the attributes we support
+	static constexpr std::array<ReadHandleEntry<WriteState>, 2> kReadHandles { {
+		{ &model::Attribute::kWriteTime, [](const WriteState &self) { return self.memberReadHandle(&State::_writeTime); } },
+		{ &attributes::kWriteError, [](const WriteState &self) { return self.memberReadHandle(&State::_writeError); } }
+	} };
+
+	return lookUpReadHandle<kReadHandles>(*this, attribute);
+}
+
+template <typename Member>
+auto WriteState::memberReadHandle(Member State::*member) const noexcept -> data::ReadHandle
+{
+	// If the state has already been realized without the data block, there is no storage to read from
+	if (_realized && !_created) [[unlikely]]
 	{
-		return _dataBlock.member(&State::_writeError);
+		return std::make_error_code(std::errc::operation_not_supported);
 	}
 
-	return std::nullopt;
+	_attributesUsed = true;
+	return _dataBlock.member(member);
 }
 
 auto WriteState::realize() -> void
 {
-	// Create the data block
-	_dataBlock.create(memory::memoryResources::data());
+	// Create the data block, if anyone needs it
+	if (used())
+	{
+		_dataBlock.create(memory::memoryResources::data());
+		_created = true;
+	}
+	_realized = true;
+}
+
+auto WriteState::addFootprint(MemoryFootprint &footprint) const noexcept -> void
+{
+	if (_created)
+	{
+		footprint._dataBlock += sizeof(State);
+	}
+	if (_writtenEvent)
+	{
+		footprint._events += 2 * sizeof(process::Event);
+	}
 }
 
 auto WriteState::update(std::chrono::system_clock::time_point timeStamp, std::error_code error) -> void
 {
+	// Nothing to do if nobody uses the state
+	if (!_created)
+	{
+		return;
+	}
+
 	// Make a write sentinel
 	memory::WriteSentinel sentinel { _dataBlock };
 	auto &state = *sentinel;
@@ -61,10 +103,14 @@ auto WriteState::update(std::chrono::system_clock::time_point timeStamp, std::er
 	state._writeTime = timeStamp;
 	state._writeError = error;
 
-	// Determine the correct event
-	const auto &event = error ? _writeErrorEvent : _writtenEvent;
+	// Determine the correct event, if the events were created
+	process::StaticEventList<1> events;
+	if (const auto &event = error ? _writeErrorEvent : _writtenEvent)
+	{
+		events.push_back(*event);
+	}
 	// Commit the data and raise the event
-	sentinel.commit(timeStamp, event);
+	sentinel.commit(timeStamp, events);
 }
 
 } // namespace xentara::plugins::templateDriver
\ No newline at end of file
@@ -2,9 +2,11 @@
 #pragma once
 
 #include "Attributes.hpp"
+#include "MemoryFootprint.hpp"
 
 #include <xentara/data/ReadHandle.hpp>
 #include <xentara/memory/ObjectBlock.hpp>
+#include <xentara/model/Attribute.hpp>
 #include <xentara/model/ForEachAttributeFunction.hpp>
 #include <xentara/model/ForEachEventFunction.hpp>
 #include <xentara/process/Event.hpp>
@@ -39,6 +41,9 @@ public:
 	auto forEachEvent(const model::ForEachEventFunction &function, std::shared_ptr<void> parent) -> bool;
 
 	/// @brief Creates a read-handle for an attribute that belong to this state.
+	///
+	/// The data block is only allocated if a handle was created or the events were requested before the state was
+	/// realized. Handles that are created later read as errors.
 	/// @param attribute The attribute to create the handle for
 	/// @return A read handle for the attribute, or std::nullopt if the attribute is unknown
 	auto makeReadHandle(const model::Attribute &attribute) const noexcept -> std::optional<data::ReadHandle>;
@@ -46,6 +51,10 @@ public:
 	/// @brief Realizes the state
 	auto realize() -> void;
 
+	/// @brief Adds the memory used by the data block and the events to a footprint
+	/// @note The memory used by the state object itself is part of the object containing it.
+	auto addFootprint(MemoryFootprint &footprint) const noexcept -> void;
+
 	/// @brief Updates the data and sends events
 	/// @param timeStamp The update time stamp
 	/// @param error The error code, or a default constructed std::error_code object if no error occurred
@@ -62,13 +71,36 @@ private:
 		std::error_code _writeError;
 	};
 
-	/// @brief A Xentara event that is raised when the value was successfully written
-	process::Event _writtenEvent { io::Direction::Output };
-	/// @brief A Xentara event that is raised when a write error occurred
-	process::Event _writeErrorEvent { io::Direction::Output };
+	/// @brief A Xentara event that is raised when the value was successfully written, or nullptr if nobody has asked for
+	/// the events.
+	///
+	/// The events are created the first time forEachEvent() is called, so that data points whose events are never used
+	/// don't pay for them.
+	std::unique_ptr<process::Event> _writtenEvent;
+	/// @brief A Xentara event that is raised when a write error occurred, or nullptr if nobody has asked for the events
+	std::unique_ptr<process::Event> _writeErrorEvent;
+
+	/// @brief Creates a read handle for a member of the state, and marks the data block as used
+	template <typename Member>
+	auto memberReadHandle(Member State::*member) const noexcept -> data::ReadHandle;
 
-	/// @brief The data block that contains the state
+	/// @brief Checks whether the data block is needed, either for the attributes or to raise the events
+	auto used() const noexcept -> bool
+	{
+		return _attributesUsed || _writtenEvent;
+	}
+
+	/// @brief The data block that contains the state. This is only created if used() returns true.
 	memory::ObjectBlock<State> _dataBlock;
+
+	/// @brief Whether a read handle was created for any of the attributes
+	///
+	/// This is mutable, because it is set by makeReadHandle(), which is const.
+	mutable bool _attributesUsed { false };
+	/// @brief Whether the state has been realized
+	bool _realized { false };
+	/// @brief Whether the data block was created when the state was realized
+	bool _created { false };
 };
 
 } // namespace xentara::plugins::templateDriver
\ No newline at end of file
@@ -20,6 +20,14 @@ public:
 	{
 	}
 
+	/// @brief Hands the writes of the target to another task.
+	///
+	/// If the writes are delegated, this task does nothing at all.
+	auto setDelegated(bool delegated) noexcept -> void
+	{
+		_delegated = delegated;
+	}
+
 	/// @name Virtual Overrides for process::Task
 	/// @{
 
@@ -43,6 +51,8 @@ public:
 private:
 	/// @brief A reference to the target element
 	std::reference_wrapper<Target> _target;
+	/// @brief Whether the writes of the target are performed by another task
+	bool _delegated { false };
 };
 
 template <typename Target>
@@ -65,6 +75,12 @@ auto WriteTask<Target>::preOperational(const process::ExecutionContext &context)
 template <typename Target>
 auto WriteTask<Target>::operational(const process::ExecutionContext &context) -> void
 {
+	// Leave the target alone if another task writes it
+	if (_delegated)
+	{
+		return;
+	}
+
 	_target.get().performWriteTask(context);
 }
 
@@ -0,0 +1,85 @@
+// Copyright (c) embedded ocean GmbH
+#include "WriteLoadGenerator.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace xentara::plugins::templateDriver
+{
+
+namespace
+{
+
+	/// @brief The number of values a thread schedules before adding them to the total
+	constexpr std::uint64_t kCountBatchSize = 1024;
+
+} // namespace
+
+auto WriteLoadGenerator::start(std::vector<data::WriteHandle> handles) -> void
+{
+	stop();
+
+	_handles = std::move(handles);
+	if (_handles.empty())
+	{
+		return;
+	}
+
+	for (std::size_t thread = 0; thread < _threadCount; ++thread)
+	{
+		_threads.emplace_back([this, thread](std::stop_token stopToken) { producerMain(stopToken, thread); });
+	}
+}
+
+auto WriteLoadGenerator::stop() -> void
+{
+	// Destroying the threads requests them to stop and joins them
+	_threads.clear();
+}
+
+auto WriteLoadGenerator::producerMain(std::stop_token stopToken, std::size_t thread) -> void
+{
+	// If there are fewer outputs than threads, several threads write to the same output, which is the worst case for
+	// the output queues
+	const auto slots = std::max(_handles.size(), _threadCount);
+	const auto interval = _rate > 0 ?
+		std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / _rate)) :
+		std::chrono::steady_clock::duration::zero();
+	const auto limited = interval > std::chrono::steady_clock::duration::zero();
+
+	auto nextWrite = std::chrono::steady_clock::now();
+	std::uint64_t sequence = 0;
+	std::uint64_t uncounted = 0;
+	while (!stopToken.stop_requested())
+	{
+		for (auto slot = thread; slot < slots && !stopToken.stop_requested(); slot += _threadCount)
+		{
+			// Make the values unique across all the threads, so that lost updates can be told apart
+			const std::uint64_t value = sequence * _threadCount + thread;
+			++sequence;
+			if (_handles[slot % _handles.size()].write(value))
+			{
+				_failedWrites.fetch_add(1, std::memory_order_relaxed);
+			}
+			// Add to the total in batches, so that the threads don't contend on the counter. If the rate is limited,
+			// contention is not an issue, so we add each value right away.
+			else if (++uncounted == kCountBatchSize || limited)
+			{
+				_generatedWrites.fetch_add(uncounted, std::memory_order_relaxed);
+				uncounted = 0;
+			}
+
+			// Wait for the next value, if the rate is limited. If we have fallen behind, we skip the missed values instead
+			// of trying to catch up.
+			if (limited)
+			{
+				nextWrite = std::max(nextWrite + interval, std::chrono::steady_clock::now());
+				std::this_thread::sleep_until(nextWrite);
+			}
+		}
+	}
+
+	_generatedWrites.fetch_add(uncounted, std::memory_order_relaxed);
+}
+
+} // namespace xentara::plugins::templateDriver
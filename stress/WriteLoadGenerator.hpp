@@ -0,0 +1,87 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include "CacheLine.hpp"
+
+#include <xentara/data/WriteHandle.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace xentara::plugins::templateDriver
+{
+
+/// @brief Generates a synthetic write load on outputs.
+///
+/// The generator starts a number of producer threads, which write values to the outputs using the write handles of
+/// their value attributes, just like Xentara does. The stress test drains the queues at the same time, the way the
+/// "write" tasks do.
+///
+/// The outputs are split evenly between the threads, and each thread schedules a value on each of its outputs in turn.
+class WriteLoadGenerator final
+{
+public:
+	/// @brief Sets the number of producer threads
+	/// @param threadCount The number of threads, or 0 to disable the generator
+	auto setThreadCount(std::size_t threadCount) noexcept -> void
+	{
+		_threadCount = threadCount;
+	}
+
+	/// @brief Sets the rate at which each thread schedules values
+	/// @param rate The number of values per second and thread, or 0 to schedule values as fast as possible
+	auto setRate(double rate) noexcept -> void
+	{
+		_rate = rate;
+	}
+
+	/// @brief Starts the producer threads
+	/// @param handles The write handles of the outputs to write to. The handles must accept std::uint64_t values.
+	auto start(std::vector<data::WriteHandle> handles) -> void;
+
+	/// @brief Stops the producer threads
+	auto stop() -> void;
+
+	/// @brief Returns the total number of values scheduled so far.
+	///
+	/// The threads add their values to the total in batches, so the total is only exact once stop() has been called.
+	auto generatedWrites() const noexcept -> std::uint64_t
+	{
+		return _generatedWrites.load(std::memory_order_relaxed);
+	}
+
+	/// @brief Returns the number of values the write handles rejected.
+	///
+	/// Rejected values are not included in generatedWrites().
+	auto failedWrites() const noexcept -> std::uint64_t
+	{
+		return _failedWrites.load(std::memory_order_relaxed);
+	}
+
+private:
+	/// @brief The main function of a producer thread
+	/// @param stopToken The stop token of the thread
+	/// @param thread The index of the thread
+	auto producerMain(std::stop_token stopToken, std::size_t thread) -> void;
+
+	/// @brief The number of producer threads
+	std::size_t _threadCount { 0 };
+	/// @brief The number of values per second and thread, or 0 for no limit
+	double _rate { 0 };
+
+	/// @brief The write handles of the outputs
+	std::vector<data::WriteHandle> _handles;
+	/// @brief The producer threads
+	std::vector<std::jthread> _threads;
+
+	/// @brief The total number of values scheduled. This is on its own cache line, because all the producer threads update it.
+	alignas(kCacheLineSize) std::atomic<std::uint64_t> _generatedWrites { 0 };
+	/// @brief The number of values the write handles rejected. This is rarely updated, so it can share the cache line.
+	std::atomic<std::uint64_t> _failedWrites { 0 };
+};
+
+} // namespace xentara::plugins::templateDriver
@@ -0,0 +1,350 @@
+// Copyright (c) embedded ocean GmbH
+#include "WriteLoadGenerator.hpp"
+
+#include "TemplateOutputHandler.hpp"
+
+#include <xentara/data/WriteHandle.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace xentara::plugins::templateDriver
+{
+
+using namespace std::literals;
+
+namespace
+{
+
+	/// @brief The parameters of the stress test
+	struct Parameters final
+	{
+		/// @brief The number of outputs
+		std::size_t _outputs { 16 };
+		/// @brief The number of producer threads
+		std::size_t _threads { 4 };
+		/// @brief The number of values per second and thread, or 0 for no limit
+		double _rate { 0 };
+		/// @brief How long to generate the load for
+		std::chrono::milliseconds _duration { 5s };
+	};
+
+	/// @brief A histogram of latencies, from which percentiles can be estimated.
+	///
+	/// Each power of two of nanoseconds is split into kSubBuckets buckets of equal width, so the percentiles are accurate
+	/// to within 1/kSubBuckets of their value, without having to keep every latency.
+	class LatencyHistogram final
+	{
+	public:
+		/// @brief Records a latency
+		auto record(std::chrono::steady_clock::duration latency) noexcept -> void
+		{
+			const auto nanoseconds = std::uint64_t(std::max(std::chrono::nanoseconds(latency).count(), std::int64_t(0)));
+			++_buckets[bucketIndex(nanoseconds)];
+			++_count;
+		}
+
+		/// @brief Returns the number of latencies recorded
+		auto count() const noexcept -> std::uint64_t
+		{
+			return _count;
+		}
+
+		/// @brief Estimates a percentile
+		/// @param percentile The percentile, from 0 to 100
+		/// @return The upper bound of the bucket that contains the percentile
+		auto percentile(double percentile) const noexcept -> std::chrono::nanoseconds
+		{
+			// The rank of the latency, counting from 0. The 100th percentile is the largest latency.
+			const auto rank = std::min(std::uint64_t(double(_count) * percentile / 100.0), _count - 1);
+			std::uint64_t seen = 0;
+			for (std::size_t index = 0; index < _buckets.size(); ++index)
+			{
+				seen += _buckets[index];
+				if (seen > rank)
+				{
+					return std::chrono::nanoseconds(upperBound(index));
+				}
+			}
+			return std::chrono::nanoseconds(upperBound(_buckets.size() - 1));
+		}
+
+	private:
+		/// @brief The number of buckets each power of two is split into
+		static constexpr std::size_t kSubBuckets = 8;
+		/// @brief The number of bits needed to index the sub-buckets
+		static constexpr int kSubBucketBits = std::countr_zero(kSubBuckets);
+
+		/// @brief Determines the bucket of a latency in nanoseconds
+		static auto bucketIndex(std::uint64_t nanoseconds) noexcept -> std::size_t
+		{
+			// Small values get a bucket of their own
+			if (nanoseconds < kSubBuckets)
+			{
+				return std::size_t(nanoseconds);
+			}
+
+			// Take the highest bits below the leading one as the sub-bucket
+			const auto shift = std::bit_width(nanoseconds) - 1 - kSubBucketBits;
+			const auto subBucket = (nanoseconds >> shift) & (kSubBuckets - 1);
+			return std::size_t(shift + 1) * kSubBuckets + std::size_t(subBucket);
+		}
+
+		/// @brief Determines the largest latency in nanoseconds that falls into a bucket
+		static auto upperBound(std::size_t index) noexcept -> std::uint64_t
+		{
+			if (index < kSubBuckets)
+			{
+				return index;
+			}
+
+			const auto shift = index / kSubBuckets - 1;
+			const auto subBucket = index % kSubBuckets;
+			return ((kSubBuckets + subBucket + 1) << shift) - 1;
+		}
+
+		/// @brief The number of latencies in each bucket
+		std::array<std::uint64_t, (64 - kSubBucketBits + 1) * kSubBuckets> _buckets {};
+		/// @brief The total number of latencies
+		std::uint64_t _count { 0 };
+	};
+
+	/// @brief The results of the stress test
+	struct Results final
+	{
+		/// @brief The number of values taken from the queues
+		std::uint64_t _stagedValues { 0 };
+		/// @brief The number of values that were taken from a queue before an older value of the same producer
+		std::uint64_t _reorderedValues { 0 };
+		/// @brief The number of values that were taken from a queue without the time they were scheduled
+		std::uint64_t _untimedValues { 0 };
+		/// @brief The number of times the scheduled flag was found raised
+		std::uint64_t _raisedFlags { 0 };
+		/// @brief The time from when the values were scheduled to when they were taken from the queues
+		LatencyHistogram _stageLatency;
+	};
+
+	/// @brief Parses a single number from the command line
+	template <typename Number>
+	auto parseNumber(std::string_view text, Number &number) -> bool
+	{
+		const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), number);
+		return error == std::errc() && end == text.data() + text.size();
+	}
+
+	/// @brief Parses the command line
+	/// @return The parameters, or std::nullopt if the command line is invalid
+	auto parseArguments(std::span<char *> arguments) -> std::optional<Parameters>
+	{
+		Parameters parameters;
+		for (std::size_t index = 1; index + 1 < arguments.size(); index += 2)
+		{
+			const std::string_view name = arguments[index];
+			const std::string_view value = arguments[index + 1];
+
+			if (name == "--outputs"sv)
+			{
+				if (!parseNumber(value, parameters._outputs) || parameters._outputs == 0)
+				{
+					return std::nullopt;
+				}
+			}
+			else if (name == "--threads"sv)
+			{
+				if (!parseNumber(value, parameters._threads) || parameters._threads == 0)
+				{
+					return std::nullopt;
+				}
+			}
+			else if (name == "--rate"sv)
+			{
+				if (!parseNumber(value, parameters._rate) || !(parameters._rate >= 0))
+				{
+					return std::nullopt;
+				}
+			}
+			else if (name == "--duration"sv)
+			{
+				std::chrono::milliseconds::rep milliseconds = 0;
+				if (!parseNumber(value, milliseconds) || milliseconds <= 0)
+				{
+					return std::nullopt;
+				}
+				parameters._duration = std::chrono::milliseconds(milliseconds);
+			}
+			else
+			{
+				return std::nullopt;
+			}
+		}
+
+		// Every option needs a value
+		if (arguments.size() % 2 == 0)
+		{
+			return std::nullopt;
+		}
+
+		return parameters;
+	}
+
+	/// @brief Drains the queues of the outputs the way the "write" tasks do, and checks the values
+	/// @param outputs The outputs
+	/// @param scheduledFlag The flag the outputs raise when a value is scheduled
+	/// @param threadCount The number of producer threads
+	/// @param lastSequences The last sequence number seen for each output and producer thread
+	/// @param results The results to update
+	auto drain(std::span<const std::shared_ptr<TemplateOutputHandler<std::uint64_t>>> outputs,
+		std::atomic<bool> &scheduledFlag,
+		std::size_t threadCount,
+		std::span<std::optional<std::uint64_t>> lastSequences,
+		Results &results) -> void
+	{
+		if (scheduledFlag.exchange(false, std::memory_order_acquire))
+		{
+			++results._raisedFlags;
+		}
+
+		for (std::size_t index = 0; index < outputs.size(); ++index)
+		{
+			auto &output = *outputs[index];
+			if (!output.stagePendingValue())
+			{
+				continue;
+			}
+			++results._stagedValues;
+
+			// Every value that is taken from the queue must know when it was scheduled
+			if (const auto stagedSince = output.stagedSince())
+			{
+				results._stageLatency.record(std::chrono::steady_clock::now() - *stagedSince);
+			}
+			else
+			{
+				++results._untimedValues;
+			}
+
+			// Decode the value, which the generator derived from the sequence number and the thread
+			std::array<std::byte, sizeof(std::uint64_t)> buffer;
+			output.encodeStagedValue(buffer);
+			std::uint64_t value = 0;
+			std::memcpy(&value, buffer.data(), sizeof(value));
+			const auto thread = value % threadCount;
+			const auto sequence = value / threadCount;
+
+			// Values from the same thread must never go backwards, even if some of them were overwritten
+			auto &lastSequence = lastSequences[index * threadCount + thread];
+			if (lastSequence && sequence <= *lastSequence)
+			{
+				++results._reorderedValues;
+			}
+			lastSequence = sequence;
+		}
+	}
+
+	/// @brief Runs the stress test
+	/// @return Whether the test passed
+	auto run(const Parameters &parameters) -> bool
+	{
+		// Create the outputs. They all share a single scheduled flag, like the outputs of a single priority.
+		std::atomic<bool> scheduledFlag { false };
+		std::vector<std::shared_ptr<TemplateOutputHandler<std::uint64_t>>> outputs;
+		std::vector<data::WriteHandle> handles;
+		for (std::size_t index = 0; index < parameters._outputs; ++index)
+		{
+			const auto &output = outputs.emplace_back(std::make_shared<TemplateOutputHandler<std::uint64_t>>());
+			output->setScheduledFlag(&scheduledFlag);
+
+			// Write to the output using the same handle Xentara uses
+			auto handle = output->makeWriteHandle(TemplateOutputHandler<std::uint64_t>::kValueAttribute, output);
+			if (!handle)
+			{
+				std::fprintf(stderr, "the output has no write handle for its value\n");
+				return false;
+			}
+			handles.push_back(std::move(*handle));
+		}
+
+		// Generate the load, and drain the queues on this thread in the meantime
+		Results results;
+		std::vector<std::optional<std::uint64_t>> lastSequences(parameters._outputs * parameters._threads);
+		WriteLoadGenerator generator;
+		generator.setThreadCount(parameters._threads);
+		generator.setRate(parameters._rate);
+		const auto startTime = std::chrono::steady_clock::now();
+		generator.start(std::move(handles));
+		while (std::chrono::steady_clock::now() - startTime < parameters._duration)
+		{
+			drain(outputs, scheduledFlag, parameters._threads, lastSequences, results);
+		}
+		generator.stop();
+		const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime);
+
+		// Take the values that are still queued
+		drain(outputs, scheduledFlag, parameters._threads, lastSequences, results);
+
+		const auto generatedWrites = generator.generatedWrites();
+		const auto failedWrites = generator.failedWrites();
+		std::printf("generated values:   %llu (%.0f per second)\n",
+			static_cast<unsigned long long>(generatedWrites), double(generatedWrites) / elapsed.count());
+		std::printf("staged values:      %llu\n", static_cast<unsigned long long>(results._stagedValues));
+		std::printf("overwritten values: %llu\n", static_cast<unsigned long long>(generatedWrites - results._stagedValues));
+		std::printf("raised flags:       %llu\n", static_cast<unsigned long long>(results._raisedFlags));
+		std::printf("reordered values:   %llu\n", static_cast<unsigned long long>(results._reorderedValues));
+		std::printf("untimed values:     %llu\n", static_cast<unsigned long long>(results._untimedValues));
+		std::printf("failed writes:      %llu\n", static_cast<unsigned long long>(failedWrites));
+
+		// Print the time from scheduling to staging
+		if (results._stageLatency.count() > 0)
+		{
+			std::printf("stage latency:     ");
+			for (const auto percentile : { 50.0, 90.0, 99.0, 99.9, 100.0 })
+			{
+				std::printf(" p%g %.1f us", percentile,
+					std::chrono::duration<double, std::micro>(results._stageLatency.percentile(percentile)).count());
+			}
+			std::printf("\n");
+		}
+
+		// Every value is either staged or overwritten, so no more values can be staged than were generated
+		return results._reorderedValues == 0 && results._untimedValues == 0 && failedWrites == 0 &&
+			results._stagedValues <= generatedWrites;
+	}
+
+} // namespace
+
+} // namespace xentara::plugins::templateDriver
+
+/// @brief Generates a write load on a number of outputs from several threads, while draining the output queues.
+///
+/// The test checks that values are never reordered or lost without being counted, and that every value taken from a
+/// queue knows when it was scheduled. Building the test with ThreadSanitizer additionally finds data races on the
+/// scheduling path.
+auto main(int argc, char *argv[]) -> int
+{
+	using namespace xentara::plugins::templateDriver;
+
+	const auto parameters = parseArguments(std::span(argv, std::size_t(argc)));
+	if (!parameters)
+	{
+		std::fprintf(stderr, "usage: %s [--outputs N] [--threads N] [--rate VALUES_PER_SECOND] [--duration MILLISECONDS]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	return run(*parameters) ? EXIT_SUCCESS : EXIT_FAILURE;
+}